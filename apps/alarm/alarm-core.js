@@ -30,7 +30,6 @@ function AlarmCore (activity) {
   this.jobQueue = []
   this.reminderTTS = []
   this.taskTimeout = null
-  this.volumeInterval = null
   this.stopTimeout = null
   this.activeOption = null
   this.ttsClient = new TtsEventHandle(activity.tts)
@@ -112,18 +111,11 @@ AlarmCore.prototype._controlVolume = function (minVolume, tick, duration) {
     AudioManager.setMute(false)
     AudioManager.setVolume(minVolume)
   } else {
-    var range = Math.ceil((defaultAudio - minVolume) / duration)
+    // fade in natively instead of stepping the volume on every tick
     AudioManager.setVolume(AudioManager.STREAM_ALARM, minVolume)
-    var count = 0
-    this.volumeInterval = setInterval(function () {
-      if (minVolume + (count + 1) * range >= defaultAudio) {
-        AudioManager.setVolume(AudioManager.STREAM_ALARM, defaultAudio) // todo: change player volume
-        clearInterval(this.volumeInterval)
-      } else {
-        AudioManager.setVolume(AudioManager.STREAM_ALARM, minVolume + (count + 1) * range)
-      }
-      count++
-    }, tick)
+    AudioManager.rampVolume(AudioManager.STREAM_ALARM, defaultAudio, tick * duration, {
+      curve: AudioManager.FADE_EASE_IN
+    })
   }
 }
 
@@ -459,7 +451,7 @@ AlarmCore.prototype.clearAll = function () {
   this.activity.media.stop()
   this.activity.tts.stop()
   this.taskTimeout && clearTimeout(this.taskTimeout)
-  this.volumeInterval && clearInterval(this.volumeInterval)
+  AudioManager.cancelRamp(AudioManager.STREAM_ALARM)
   this.stopTimeout && clearTimeout(this.stopTimeout)
   this.restoreEventsDefaults()
   this.activity.setBackground()
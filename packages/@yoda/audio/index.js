@@ -135,6 +135,34 @@ AudioManager.LINEAR_RAMP = function (len) {
   return shape
 }
 
+/**
+ * The linear fade for `rampVolume`.
+ * @memberof module:@yoda/audio~AudioManager
+ * @member {Number} FADE_LINEAR
+ */
+AudioManager.FADE_LINEAR = native.VOLUME_FADE_LINEAR
+
+/**
+ * The fade for `rampVolume` which starts slowly.
+ * @memberof module:@yoda/audio~AudioManager
+ * @member {Number} FADE_EASE_IN
+ */
+AudioManager.FADE_EASE_IN = native.VOLUME_FADE_EASE_IN
+
+/**
+ * The fade for `rampVolume` which ends slowly.
+ * @memberof module:@yoda/audio~AudioManager
+ * @member {Number} FADE_EASE_OUT
+ */
+AudioManager.FADE_EASE_OUT = native.VOLUME_FADE_EASE_OUT
+
+/**
+ * The fade for `rampVolume` which starts and ends slowly.
+ * @memberof module:@yoda/audio~AudioManager
+ * @member {Number} FADE_EASE_IN_OUT
+ */
+AudioManager.FADE_EASE_IN_OUT = native.VOLUME_FADE_EASE_IN_OUT
+
 /**
  * Set the volume of the given stream.
  * @memberof module:@yoda/audio~AudioManager
@@ -179,9 +207,100 @@ AudioManager.setVolume = function (type, vol) {
   process.nextTick(() => {
     floraDisposable.post(`yodart.audio.on-volume-change`, [ stream.name, vol ])
   })
+  // a direct set wins over the running ramp
+  native.cancelStreamRamp(stream.id)
   return _storeVolume(stream, vol)
 }
 
+/**
+ * Apply the stored volume of the stream again, e.g. on the connection of a
+ * new player. It's left to the running ramp of the stream if there is one.
+ * @private
+ * @memberof module:@yoda/audio~AudioManager
+ * @method refreshVolume
+ * @param {Number} stream - The stream type.
+ * @throws {TypeError} invalid stream type
+ */
+AudioManager.refreshVolume = function refreshVolume (type) {
+  if (!AudioBase[type]) {
+    throw new TypeError('invalid stream type')
+  }
+  var stream = AudioBase[type]
+  var vol = _getVolume(stream)
+  if (vol === false || native.isStreamRamping(stream.id)) {
+    return
+  }
+  native.setStreamVolume(stream.id, vol)
+}
+
+/**
+ * Fade the volume of the given stream to `vol` on the native ramp thread,
+ * the running ramp of the stream is cancelled and the new one starts from
+ * where it stopped. The target volume is stored once the ramp finishes.
+ *
+ * @memberof module:@yoda/audio~AudioManager
+ * @method rampVolume
+ * @param {Number} stream - The stream type.
+ * @param {Number} vol - The target volume.
+ * @param {Number} duration - The duration in ms.
+ * @param {Object} [options]
+ * @param {Number} [options.curve=AudioManager.FADE_LINEAR] - The fade curve.
+ * @param {Boolean} [options.persist=true] - Store the target volume, false to
+ *        fade temporarily like ducking.
+ * @param {Function} [callback] - called with `(cancelled, volume)`.
+ * @throws {TypeError} invalid stream type
+ * @throws {TypeError} vol must be a number
+ * @example
+ * AudioManager.rampVolume(AudioManager.STREAM_ALARM, 60, 7000, {
+ *   curve: AudioManager.FADE_EASE_IN
+ * })
+ */
+AudioManager.rampVolume = function rampVolume (type, vol, duration, options, callback) {
+  if (typeof options === 'function') {
+    callback = options
+    options = null
+  }
+  options = options || {}
+  if (!AudioBase[type]) {
+    throw new TypeError('invalid stream type')
+  }
+  if (typeof vol !== 'number') {
+    throw new TypeError('vol must be a number')
+  }
+  vol = Math.floor(Math.min(Math.max(vol, 0), 100))
+
+  var stream = AudioBase[type]
+  var curve = options.curve || AudioManager.FADE_LINEAR
+  var started = native.rampStreamVolume(stream.id, vol, duration || 0, curve,
+    (cancelled, volume) => {
+      if (!cancelled && options.persist !== false) {
+        property.set(stream.key, volume, 'persist')
+        floraDisposable.post(`yodart.audio.on-volume-change`, [ stream.name, volume ])
+      }
+      if (typeof callback === 'function') {
+        callback(cancelled, volume)
+      }
+    })
+  if (!started) {
+    throw new Error(`failed to ramp the volume of ${stream.name}`)
+  }
+}
+
+/**
+ * Stop the running ramp of the given stream at its current volume.
+ * @memberof module:@yoda/audio~AudioManager
+ * @method cancelRamp
+ * @param {Number} stream - The stream type.
+ * @throws {TypeError} invalid stream type
+ * @returns {Boolean} if there was a running ramp.
+ */
+AudioManager.cancelRamp = function cancelRamp (type) {
+  if (!AudioBase[type]) {
+    throw new TypeError('invalid stream type')
+  }
+  return native.cancelStreamRamp(AudioBase[type].id)
+}
+
 /**
  * Set the volume to user land streams.
  *
@@ -256,16 +375,103 @@ AudioManager.setMute = function (val) {
 AudioManager.setVolumeShaper = function setVolumeShaper (shaper) {
   var max = 100
   var shape = shaper(max)
-  if (!Array.isArray(shape)) { throw new Error('shaper function should return an array with 100 elements.') }
+  if (!Array.isArray(shape) || shape.length <= max) { throw new Error('shaper function should return an array with 100 elements.') }
 
-  for (var i = 0; i <= max; i++) {
-    if (!native.setCurveForVolume(i, shape[i])) {
-      throw new RangeError('out of range when set volume shape.')
-    }
-  }
+  AudioManager.defineVolumeCurve('shaper', shape.slice(0, max + 1))
+  AudioManager.useVolumeCurve('shaper')
   return true
 }
 
+/**
+ * The curve values are interpolated linearly.
+ * @memberof module:@yoda/audio~AudioManager
+ * @member {Number} INTERPOLATION_LINEAR
+ */
+AudioManager.INTERPOLATION_LINEAR = native.VOLUME_INTERPOLATION_LINEAR
+
+/**
+ * The curve values are interpolated geometrically, so the steps are even in dB.
+ * @memberof module:@yoda/audio~AudioManager
+ * @member {Number} INTERPOLATION_DB
+ */
+AudioManager.INTERPOLATION_DB = native.VOLUME_INTERPOLATION_DB
+
+/**
+ * The curve values follow a logarithmic taper between the control points.
+ * @memberof module:@yoda/audio~AudioManager
+ * @member {Number} INTERPOLATION_LOG
+ */
+AudioManager.INTERPOLATION_LOG = native.VOLUME_INTERPOLATION_LOG
+
+/**
+ * Define a named volume curve, the full table of the levels 0..100 is
+ * interpolated natively. The curve is either the values spread evenly over
+ * the levels, where 101 values are taken as they are, or the control points
+ * of `[level, value]` which must start at 0 and end at 100.
+ *
+ * @memberof module:@yoda/audio~AudioManager
+ * @method defineVolumeCurve
+ * @param {String} name - The curve name.
+ * @param {Array|TypedArray} curve - The values or the control points.
+ * @param {Object} [options]
+ * @param {Number} [options.interpolation=AudioManager.INTERPOLATION_LINEAR]
+ * @throws {RangeError} invalid volume curve.
+ * @example
+ * AudioManager.defineVolumeCurve('night', [ [0, 0], [50, 20], [100, 60] ], {
+ *   interpolation: AudioManager.INTERPOLATION_DB
+ * })
+ * AudioManager.useVolumeCurve('night')
+ */
+AudioManager.defineVolumeCurve = function defineVolumeCurve (name, curve, options) {
+  options = options || {}
+  var values = Array.prototype.slice.call(curve || [])
+  var levels = null
+  if (Array.isArray(values[0])) {
+    levels = values.map((it) => it[0])
+    values = values.map((it) => it[1])
+  }
+  var interpolation = options.interpolation || AudioManager.INTERPOLATION_LINEAR
+  if (!native.defineVolumeCurve(String(name), levels, values, interpolation)) {
+    throw new RangeError(`invalid volume curve ${name}.`)
+  }
+}
+
+/**
+ * Apply the named curve to the driver in one call. The driver has one curve
+ * for all streams, so switching the curve affects all of them.
+ * @memberof module:@yoda/audio~AudioManager
+ * @method useVolumeCurve
+ * @param {String} name - The curve name.
+ * @throws {Error} unknown volume curve.
+ */
+AudioManager.useVolumeCurve = function useVolumeCurve (name) {
+  if (!native.useVolumeCurve(String(name))) {
+    throw new Error(`unknown volume curve ${name}.`)
+  }
+}
+
+/**
+ * Get the full table of the named curve.
+ * @memberof module:@yoda/audio~AudioManager
+ * @method getVolumeCurve
+ * @param {String} name - The curve name.
+ * @returns {Number[]|undefined} the values of the levels 0..100.
+ */
+AudioManager.getVolumeCurve = function getVolumeCurve (name) {
+  return native.getVolumeCurve(String(name))
+}
+
+/**
+ * Remove the named curve, the applied table is kept by the driver.
+ * @memberof module:@yoda/audio~AudioManager
+ * @method removeVolumeCurve
+ * @param {String} name - The curve name.
+ * @returns {Boolean} if the curve existed.
+ */
+AudioManager.removeVolumeCurve = function removeVolumeCurve (name) {
+  return native.removeVolumeCurve(String(name))
+}
+
 /**
  * Modules that will record playing state
  */
@@ -327,6 +533,93 @@ AudioManager.getPlayingStatus = function (stream) {
   }
 }
 
+/**
+ * @typedef AudioState
+ * @property {Boolean} muted - if muted.
+ * @property {Number} volume - the media volume.
+ * @property {Object} streams - the `{ volume, playing }` of every stream
+ *           keyed by its name.
+ */
+
+/**
+ * Get the mute, the volumes and the playing status of all streams in one
+ * call, they are read from the native cache which is kept up to date by the
+ * setters and read again from the driver once it's older than 50ms.
+ * @memberof module:@yoda/audio~AudioManager
+ * @method getState
+ * @param {Boolean} [refresh=false] - read the driver instead of the cache.
+ * @returns {module:@yoda/audio~AudioState}
+ */
+AudioManager.getState = function getState (refresh) {
+  var state = native.getState(!!refresh)
+  var streams = {}
+  state.streams.forEach((it) => {
+    var name = AudioManager.getStreamName(it.stream)
+    if (name) {
+      streams[name] = { volume: it.volume, playing: it.playing }
+    }
+  })
+  return { muted: state.muted, volume: state.volume, streams: streams }
+}
+
+var stateChangeTypes = []
+stateChangeTypes[native.AUDIO_STATE_MUTE] = 'mute'
+stateChangeTypes[native.AUDIO_STATE_VOLUME] = 'volume'
+stateChangeTypes[native.AUDIO_STATE_STREAM_VOLUME] = 'stream-volume'
+stateChangeTypes[native.AUDIO_STATE_PLAYING] = 'playing'
+var stateListeners = []
+
+function onStateChange (events) {
+  events.forEach((it) => {
+    var change = {
+      type: stateChangeTypes[it.type],
+      stream: it.stream >= 0 ? AudioManager.getStreamName(it.stream) : undefined,
+      value: it.type === native.AUDIO_STATE_MUTE || it.type === native.AUDIO_STATE_PLAYING
+        ? !!it.value : it.value
+    }
+    stateListeners.slice().forEach((listener) => listener(change))
+  })
+}
+
+/**
+ * @typedef AudioStateChange
+ * @property {String} type - "mute", "volume", "stream-volume" or "playing".
+ * @property {String} [stream] - the stream name of "stream-volume" and "playing".
+ * @property {Number|Boolean} value - the new value.
+ */
+
+/**
+ * Listen to the changes of the audio state, including the ones made by the
+ * other processes, which are detected by the watcher within 200ms. The
+ * watcher only runs while there are listeners.
+ * @memberof module:@yoda/audio~AudioManager
+ * @method subscribe
+ * @param {Function} listener - called with a {@link module:@yoda/audio~AudioStateChange}.
+ */
+AudioManager.subscribe = function subscribe (listener) {
+  if (stateListeners.length === 0) {
+    native.setStateListener(onStateChange)
+  }
+  stateListeners.push(listener)
+}
+
+/**
+ * Remove the listener added by `subscribe`.
+ * @memberof module:@yoda/audio~AudioManager
+ * @method unsubscribe
+ * @param {Function} listener
+ */
+AudioManager.unsubscribe = function unsubscribe (listener) {
+  var idx = stateListeners.indexOf(listener)
+  if (idx === -1) {
+    return
+  }
+  stateListeners.splice(idx, 1)
+  if (stateListeners.length === 0) {
+    native.setStateListener(null)
+  }
+}
+
 /**
  * Get the human readable string for the stream type
  * @method getStreamName
@@ -3,6 +3,22 @@
 #include <stdio.h>
 #include <common.h>
 #include <string.h>
+#include <uv.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include "AudioState.h"
+#include "VolumeCurve.h"
+#include "VolumeRamp.h"
+
+typedef struct {
+  napi_env _env;
+  napi_ref _callback;
+  uv_async_t _async;
+  bool _cancelled;
+  int _volume;
+} ramp_carrier;
+
 static inline rk_stream_type_t get_stream_type(int stream) {
   if (stream == STREAM_TTS) {
     return STREAM_TTS;
@@ -21,9 +37,37 @@ static inline rk_stream_type_t get_stream_type(int stream) {
   }
 }
 
+static AudioStateCache cache;
+static napi_env stateEnv = nullptr;
+static napi_ref stateListener = nullptr;
+static uv_async_t stateAsync;
+static bool stateAsyncInited = false;
+
+// the named full curves, only one of them is applied to the driver
+static map<string, vector<int> > volumeCurves;
+
+static int SetDriverVolume(int stream, int vol) {
+  rk_stream_type_t type = get_stream_type(stream);
+  int r = rk_set_stream_volume(type, vol);
+  cache.setStreamVolume(type, vol);
+  return r;
+}
+
+static int FindStream(const AudioStateSnapshot& state, rk_stream_type_t type) {
+  for (int i = 0; i < AUDIO_STATE_STREAMS; i++) {
+    if (state.streams[i] == type)
+      return i;
+  }
+  return 0;
+}
+
+static VolumeRamper ramper(SetDriverVolume);
+
 static napi_value IsMuted(napi_env env, napi_callback_info info) {
   napi_value index;
-  if (rk_is_mute()) {
+  AudioStateSnapshot state;
+  cache.snapshot(state);
+  if (state.muted) {
     napi_get_boolean(env, true, &index);
   } else {
     napi_get_boolean(env, false, &index);
@@ -41,6 +85,7 @@ static napi_value SetMute(napi_env env, napi_callback_info info) {
   napi_get_cb_info(env, info, &argc, argv, 0, 0);
   napi_get_value_bool(env, argv[0], &index);
   rkSetValue = rk_set_mute(index);
+  cache.setMuted(index);
   napi_create_int32(env, rkSetValue, &returnVal);
   return returnVal;
 }
@@ -68,14 +113,124 @@ static napi_value SetCurveForVolume(napi_env env, napi_callback_info info) {
   return returnVal;
 }
 
+static bool GetNumbers(napi_env env, napi_value value, vector<double>& out) {
+  bool isArray = false;
+  uint32_t len = 0;
+  if (napi_is_array(env, value, &isArray) != napi_ok || !isArray)
+    return false;
+  napi_get_array_length(env, value, &len);
+  out.resize(len);
+  for (uint32_t i = 0; i < len; i++) {
+    napi_value item;
+    napi_get_element(env, value, i, &item);
+    if (napi_get_value_double(env, item, &out[i]) != napi_ok)
+      return false;
+  }
+  return true;
+}
+
+/**
+ * defineVolumeCurve(name, levels, values, interpolation)
+ * builds the full curve from the control points, `levels` could be null to
+ * spread the values evenly.
+ */
+static napi_value DefineVolumeCurve(napi_env env, napi_callback_info info) {
+  size_t argc = 4;
+  napi_value argv[4];
+  string name;
+  vector<double> levels;
+  vector<double> values;
+  napi_valuetype type;
+  int interpolation;
+  napi_value returnVal;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, 0, 0));
+  NAPI_ASSIGN_STD_STRING(env, name, argv[0]);
+  NAPI_CALL(env, napi_get_value_int32(env, argv[3], &interpolation));
+  NAPI_CALL(env, napi_typeof(env, argv[1], &type));
+
+  bool valid = GetNumbers(env, argv[2], values);
+  if (valid && type != napi_null && type != napi_undefined) {
+    valid = GetNumbers(env, argv[1], levels) &&
+            levels.size() == values.size();
+  }
+  vector<int> curve(VOLUME_CURVE_LEVELS);
+  if (valid) {
+    valid = volume_curve_build(levels.empty() ? NULL : levels.data(),
+                               values.data(), values.size(), interpolation,
+                               curve.data()) == 0;
+  }
+  if (valid) {
+    volumeCurves[name] = curve;
+  }
+  napi_get_boolean(env, valid, &returnVal);
+  return returnVal;
+}
+
+/**
+ * useVolumeCurve(name)
+ * applies the whole curve to the driver in a single call.
+ */
+static napi_value UseVolumeCurve(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value argv[1];
+  string name;
+  napi_value returnVal;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, 0, 0));
+  NAPI_ASSIGN_STD_STRING(env, name, argv[0]);
+  auto it = volumeCurves.find(name);
+  if (it == volumeCurves.end()) {
+    napi_get_boolean(env, false, &returnVal);
+    return returnVal;
+  }
+  // the driver takes a mutable table, so the stored one is copied
+  int curve[VOLUME_CURVE_LEVELS];
+  std::copy(it->second.begin(), it->second.end(), curve);
+  rk_setCustomVolumeCurve(sizeof(curve), curve);
+  napi_get_boolean(env, true, &returnVal);
+  return returnVal;
+}
+
+static napi_value GetVolumeCurve(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value argv[1];
+  string name;
+  napi_value returnVal;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, 0, 0));
+  NAPI_ASSIGN_STD_STRING(env, name, argv[0]);
+  auto it = volumeCurves.find(name);
+  if (it == volumeCurves.end()) {
+    napi_get_undefined(env, &returnVal);
+    return returnVal;
+  }
+  napi_create_array_with_length(env, it->second.size(), &returnVal);
+  for (size_t i = 0; i < it->second.size(); i++) {
+    napi_value val;
+    napi_create_int32(env, it->second[i], &val);
+    napi_set_element(env, returnVal, i, val);
+  }
+  return returnVal;
+}
+
+static napi_value RemoveVolumeCurve(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value argv[1];
+  string name;
+  napi_value returnVal;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, 0, 0));
+  NAPI_ASSIGN_STD_STRING(env, name, argv[0]);
+  napi_get_boolean(env, volumeCurves.erase(name) > 0, &returnVal);
+  return returnVal;
+}
+
 static napi_value SetMediaVolume(napi_env env, napi_callback_info info) {
   size_t argc = 1;
   napi_value argv[1];
   int vol;
   napi_value returnVal;
   napi_get_cb_info(env, info, &argc, argv, 0, 0);
-  napi_get_value_int32(env, 0, &vol);
+  napi_get_value_int32(env, argv[0], &vol);
   rk_set_volume(vol);
+  cache.setVolume(vol);
   napi_get_boolean(env, true, &returnVal);
   return returnVal;
 }
@@ -83,7 +238,9 @@ static napi_value SetMediaVolume(napi_env env, napi_callback_info info) {
 
 static napi_value GetMediaVolume(napi_env env, napi_callback_info info) {
   napi_value returnVal;
-  int vol = rk_get_volume();
+  AudioStateSnapshot state;
+  cache.snapshot(state);
+  int vol = state.volume;
   napi_create_int32(env, vol, &returnVal);
   return returnVal;
 }
@@ -100,6 +257,7 @@ static napi_value SetStreamVolume(napi_env env, napi_callback_info info) {
   napi_get_value_int32(env, argv[1], &vol);
   rk_stream_type_t type = get_stream_type(stream);
   rk_set_stream_volume(type, vol);
+  cache.setStreamVolume(type, vol);
   napi_get_boolean(env, true, &returnVal);
   return returnVal;
 }
@@ -113,7 +271,9 @@ static napi_value GetStreamVolume(napi_env env, napi_callback_info info) {
   napi_get_cb_info(env, info, &argc, argv, 0, 0);
   napi_get_value_int32(env, argv[0], &stream);
   rk_stream_type_t type = get_stream_type(stream);
-  int vol = rk_get_stream_volume(type);
+  AudioStateSnapshot state;
+  cache.snapshot(state);
+  int vol = state.volumes[FindStream(state, type)];
   napi_create_int32(env, vol, &returnVal);
   return returnVal;
 }
@@ -128,7 +288,9 @@ static napi_value GetStreamPlayingStatus(napi_env env,
   napi_get_cb_info(env, info, &argc, argv, 0, 0);
   napi_get_value_int32(env, argv[0], &stream);
   rk_stream_type_t type = get_stream_type(stream);
-  if (rk_get_stream_playing_status(type)) {
+  AudioStateSnapshot state;
+  cache.snapshot(state);
+  if (state.playing[FindStream(state, type)]) {
     napi_get_boolean(env, true, &returnVal);
   } else {
     napi_get_boolean(env, false, &returnVal);
@@ -136,16 +298,217 @@ static napi_value GetStreamPlayingStatus(napi_env env,
   return returnVal;
 }
 
+static napi_value GetState(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value argv[1];
+  bool refresh = false;
+  napi_value returnVal;
+  napi_value streams;
+  napi_value val;
+  AudioStateSnapshot state;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, 0, 0));
+  if (argc > 0) {
+    napi_get_value_bool(env, argv[0], &refresh);
+  }
+  if (refresh) {
+    cache.refresh();
+  }
+  cache.snapshot(state);
+
+  NAPI_CALL(env, napi_create_object(env, &returnVal));
+  napi_get_boolean(env, state.muted, &val);
+  napi_set_named_property(env, returnVal, "muted", val);
+  napi_create_int32(env, state.volume, &val);
+  napi_set_named_property(env, returnVal, "volume", val);
+  NAPI_CALL(env, napi_create_array_with_length(env, AUDIO_STATE_STREAMS,
+                                               &streams));
+  for (int i = 0; i < AUDIO_STATE_STREAMS; i++) {
+    napi_value item;
+    napi_create_object(env, &item);
+    napi_create_int32(env, state.streams[i], &val);
+    napi_set_named_property(env, item, "stream", val);
+    napi_create_int32(env, state.volumes[i], &val);
+    napi_set_named_property(env, item, "volume", val);
+    napi_get_boolean(env, state.playing[i], &val);
+    napi_set_named_property(env, item, "playing", val);
+    napi_set_element(env, streams, i, item);
+  }
+  napi_set_named_property(env, returnVal, "streams", streams);
+  return returnVal;
+}
+
+static void OnStateAsync(uv_async_t* handle) {
+  vector<AudioStateEvent> events;
+  cache.takeEvents(events);
+  if (stateListener == nullptr || events.empty()) {
+    return;
+  }
+  napi_env env = stateEnv;
+  napi_handle_scope scope;
+  napi_value global;
+  napi_value callback;
+  napi_value argv[1];
+
+  napi_open_handle_scope(env, &scope);
+  napi_get_global(env, &global);
+  napi_get_reference_value(env, stateListener, &callback);
+  napi_create_array_with_length(env, events.size(), &argv[0]);
+  for (size_t i = 0; i < events.size(); i++) {
+    napi_value item;
+    napi_value val;
+    napi_create_object(env, &item);
+    napi_create_int32(env, events[i].type, &val);
+    napi_set_named_property(env, item, "type", val);
+    napi_create_int32(env, events[i].stream, &val);
+    napi_set_named_property(env, item, "stream", val);
+    napi_create_int32(env, events[i].value, &val);
+    napi_set_named_property(env, item, "value", val);
+    napi_set_element(env, argv[0], i, item);
+  }
+  napi_make_callback(env, nullptr, global, callback, 1, argv, nullptr);
+  napi_close_handle_scope(env, scope);
+}
+
+static void OnStateChanged(void* data) {
+  uv_async_send(&stateAsync);
+}
+
+static napi_value SetStateListener(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value argv[1];
+  napi_valuetype type = napi_undefined;
+  uv_loop_t* loop;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, 0, 0));
+  if (argc > 0) {
+    napi_typeof(env, argv[0], &type);
+  }
+  if (stateListener != nullptr) {
+    napi_delete_reference(env, stateListener);
+    stateListener = nullptr;
+  }
+  if (type != napi_function) {
+    cache.setListener(NULL, NULL);
+    return nullptr;
+  }
+  if (!stateAsyncInited) {
+    NAPI_CALL(env, napi_get_uv_event_loop(env, &loop));
+    uv_async_init(loop, &stateAsync, OnStateAsync);
+    // the listener alone doesn't keep the process alive
+    uv_unref((uv_handle_t*)&stateAsync);
+    stateAsyncInited = true;
+  }
+  stateEnv = env;
+  NAPI_CALL(env, napi_create_reference(env, argv[0], 1, &stateListener));
+  cache.setListener(OnStateChanged, NULL);
+  return nullptr;
+}
+
+static void OnRampClosed(uv_handle_t* handle) {
+  ramp_carrier* c = static_cast<ramp_carrier*>(handle->data);
+  napi_delete_reference(c->_env, c->_callback);
+  delete c;
+}
+
+static void OnRampAsync(uv_async_t* handle) {
+  ramp_carrier* c = static_cast<ramp_carrier*>(handle->data);
+  napi_env env = c->_env;
+  napi_handle_scope scope;
+  napi_value global;
+  napi_value callback;
+  napi_value argv[2];
+
+  napi_open_handle_scope(env, &scope);
+  napi_get_global(env, &global);
+  napi_get_reference_value(env, c->_callback, &callback);
+  napi_get_boolean(env, c->_cancelled, &argv[0]);
+  napi_create_int32(env, c->_volume, &argv[1]);
+  napi_make_callback(env, nullptr, global, callback, 2, argv, nullptr);
+  napi_close_handle_scope(env, scope);
+  uv_close((uv_handle_t*)handle, OnRampClosed);
+}
+
+static void OnRampDone(void* data, bool cancelled, int volume) {
+  ramp_carrier* c = static_cast<ramp_carrier*>(data);
+  c->_cancelled = cancelled;
+  c->_volume = volume;
+  uv_async_send(&c->_async);
+}
+
+static napi_value RampStreamVolume(napi_env env, napi_callback_info info) {
+  size_t argc = 5;
+  napi_value argv[5];
+  int stream;
+  int target;
+  int duration;
+  int fade;
+  uv_loop_t* loop;
+  napi_value returnVal;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, 0, 0));
+  NAPI_CALL(env, napi_get_value_int32(env, argv[0], &stream));
+  NAPI_CALL(env, napi_get_value_int32(env, argv[1], &target));
+  NAPI_CALL(env, napi_get_value_int32(env, argv[2], &duration));
+  NAPI_CALL(env, napi_get_value_int32(env, argv[3], &fade));
+  target = target < 0 ? 0 : (target > 100 ? 100 : target);
+  duration = duration < 0 ? 0 : duration;
+
+  ramp_carrier* c = new ramp_carrier();
+  c->_env = env;
+  NAPI_CALL(env, napi_create_reference(env, argv[4], 1, &c->_callback));
+  NAPI_CALL(env, napi_get_uv_event_loop(env, &loop));
+  uv_async_init(loop, &c->_async, OnRampAsync);
+  c->_async.data = c;
+
+  int from = rk_get_stream_volume(get_stream_type(stream));
+  bool started = ramper.start(stream, from, target, (uint32_t)duration, fade,
+                              OnRampDone, c);
+  if (!started) {
+    uv_close((uv_handle_t*)&c->_async, OnRampClosed);
+  }
+  napi_get_boolean(env, started, &returnVal);
+  return returnVal;
+}
+
+static napi_value CancelStreamRamp(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value argv[1];
+  int stream;
+  napi_value returnVal;
+  napi_get_cb_info(env, info, &argc, argv, 0, 0);
+  napi_get_value_int32(env, argv[0], &stream);
+  napi_get_boolean(env, ramper.cancel(stream), &returnVal);
+  return returnVal;
+}
+
+static napi_value IsStreamRamping(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value argv[1];
+  int stream;
+  napi_value returnVal;
+  napi_get_cb_info(env, info, &argc, argv, 0, 0);
+  napi_get_value_int32(env, argv[0], &stream);
+  napi_get_boolean(env, ramper.running(stream), &returnVal);
+  return returnVal;
+}
+
 static napi_value Init(napi_env env, napi_value exports) {
   napi_property_descriptor desc[] = {
     DECLARE_NAPI_PROPERTY("isMuted", IsMuted),
     DECLARE_NAPI_PROPERTY("setMute", SetMute),
     DECLARE_NAPI_PROPERTY("setCurveForVolume", SetCurveForVolume),
+    DECLARE_NAPI_PROPERTY("defineVolumeCurve", DefineVolumeCurve),
+    DECLARE_NAPI_PROPERTY("useVolumeCurve", UseVolumeCurve),
+    DECLARE_NAPI_PROPERTY("getVolumeCurve", GetVolumeCurve),
+    DECLARE_NAPI_PROPERTY("removeVolumeCurve", RemoveVolumeCurve),
     DECLARE_NAPI_PROPERTY("setMediaVolume", SetMediaVolume),
     DECLARE_NAPI_PROPERTY("getMediaVolume", GetMediaVolume),
     DECLARE_NAPI_PROPERTY("setStreamVolume", SetStreamVolume),
     DECLARE_NAPI_PROPERTY("getStreamVolume", GetStreamVolume),
-    DECLARE_NAPI_PROPERTY("getStreamPlayingStatus", GetStreamPlayingStatus)
+    DECLARE_NAPI_PROPERTY("getStreamPlayingStatus", GetStreamPlayingStatus),
+    DECLARE_NAPI_PROPERTY("rampStreamVolume", RampStreamVolume),
+    DECLARE_NAPI_PROPERTY("cancelStreamRamp", CancelStreamRamp),
+    DECLARE_NAPI_PROPERTY("isStreamRamping", IsStreamRamping),
+    DECLARE_NAPI_PROPERTY("getState", GetState),
+    DECLARE_NAPI_PROPERTY("setStateListener", SetStateListener)
   };
   napi_define_properties(env, exports, sizeof(desc) / sizeof(*desc), desc);
   NAPI_SET_CONSTANT(exports, STREAM_AUDIO);
@@ -155,6 +518,17 @@ static napi_value Init(napi_env env, napi_value exports) {
   NAPI_SET_CONSTANT(exports, STREAM_ALARM);
   NAPI_SET_CONSTANT(exports, STREAM_PLAYBACK);
   NAPI_SET_CONSTANT(exports, STREAM_SYSTEM);
+  NAPI_SET_CONSTANT(exports, VOLUME_FADE_LINEAR);
+  NAPI_SET_CONSTANT(exports, VOLUME_FADE_EASE_IN);
+  NAPI_SET_CONSTANT(exports, VOLUME_FADE_EASE_OUT);
+  NAPI_SET_CONSTANT(exports, VOLUME_FADE_EASE_IN_OUT);
+  NAPI_SET_CONSTANT(exports, VOLUME_INTERPOLATION_LINEAR);
+  NAPI_SET_CONSTANT(exports, VOLUME_INTERPOLATION_DB);
+  NAPI_SET_CONSTANT(exports, VOLUME_INTERPOLATION_LOG);
+  NAPI_SET_CONSTANT(exports, AUDIO_STATE_MUTE);
+  NAPI_SET_CONSTANT(exports, AUDIO_STATE_VOLUME);
+  NAPI_SET_CONSTANT(exports, AUDIO_STATE_STREAM_VOLUME);
+  NAPI_SET_CONSTANT(exports, AUDIO_STATE_PLAYING);
   return exports;
 }
 
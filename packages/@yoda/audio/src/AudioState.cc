@@ -0,0 +1,242 @@
+#include "AudioState.h"
+#include <errno.h>
+#include <stdio.h>
+#include <time.h>
+#include <vol_ctrl/volumecontrol.h>
+
+#define NS_PER_MS 1000000ULL
+#define NS_PER_SEC 1000000000ULL
+
+static const rk_stream_type_t audio_streams[AUDIO_STATE_STREAMS] = {
+  STREAM_AUDIO, STREAM_TTS,      STREAM_RING,   STREAM_VOICE_CALL,
+  STREAM_ALARM, STREAM_PLAYBACK, STREAM_SYSTEM,
+};
+
+static uint64_t monotonic_now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+AudioStateCache::AudioStateCache() {
+  pthread_mutex_init(&mutex, NULL);
+  pthread_condattr_t attr;
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&cond, &attr);
+  pthread_condattr_destroy(&attr);
+}
+
+AudioStateCache::~AudioStateCache() {
+  stopWatcher();
+  pthread_cond_destroy(&cond);
+  pthread_mutex_destroy(&mutex);
+}
+
+int AudioStateCache::indexOf(int stream) {
+  for (int i = 0; i < AUDIO_STATE_STREAMS; i++) {
+    if (audio_streams[i] == stream)
+      return i;
+  }
+  return -1;
+}
+
+void AudioStateCache::read(AudioStateSnapshot& out) {
+  out.muted = rk_is_mute();
+  out.volume = rk_get_volume();
+  for (int i = 0; i < AUDIO_STATE_STREAMS; i++) {
+    out.streams[i] = audio_streams[i];
+    out.volumes[i] = rk_get_stream_volume(audio_streams[i]);
+    out.playing[i] = rk_get_stream_playing_status(audio_streams[i]);
+  }
+}
+
+void AudioStateCache::ensureStarted() {
+  pthread_mutex_lock(&mutex);
+  if (!started) {
+    if (pthread_create(&thread, NULL, AudioStateCache::Run, this) == 0) {
+      started = true;
+    } else {
+      fprintf(stderr, "audio: failed to start the state watcher(%d)\n", errno);
+    }
+  }
+  pthread_mutex_unlock(&mutex);
+}
+
+void AudioStateCache::stopWatcher() {
+  pthread_mutex_lock(&mutex);
+  if (!started) {
+    pthread_mutex_unlock(&mutex);
+    return;
+  }
+  stopping = true;
+  pthread_cond_signal(&cond);
+  pthread_mutex_unlock(&mutex);
+  pthread_join(thread, NULL);
+  pthread_mutex_lock(&mutex);
+  started = false;
+  stopping = false;
+  pthread_mutex_unlock(&mutex);
+}
+
+bool AudioStateCache::isFresh() {
+  uint64_t now = monotonic_now();
+  pthread_mutex_lock(&mutex);
+  bool ret = loaded && now - loaded_at < AUDIO_STATE_TTL * NS_PER_MS;
+  pthread_mutex_unlock(&mutex);
+  return ret;
+}
+
+void AudioStateCache::snapshot(AudioStateSnapshot& out) {
+  if (!isFresh())
+    refresh();
+  pthread_mutex_lock(&mutex);
+  out = state;
+  pthread_mutex_unlock(&mutex);
+}
+
+void AudioStateCache::refresh() {
+  AudioStateSnapshot next;
+  pthread_mutex_lock(&mutex);
+  uint64_t current = generation;
+  pthread_mutex_unlock(&mutex);
+
+  // the driver is read without the lock, the setters are not blocked by it
+  uint64_t now = monotonic_now();
+  read(next);
+
+  bool queued = false;
+  pthread_mutex_lock(&mutex);
+  if (!loaded) {
+    state = next;
+    loaded = true;
+    loaded_at = now;
+  } else if (current == generation) {
+    queued = apply(next);
+    loaded_at = now;
+  }
+  pthread_mutex_unlock(&mutex);
+  notify(queued);
+}
+
+bool AudioStateCache::apply(const AudioStateSnapshot& next) {
+  bool queued = false;
+  if (next.muted != state.muted)
+    queued |= queue(AUDIO_STATE_MUTE, -1, next.muted);
+  if (next.volume != state.volume)
+    queued |= queue(AUDIO_STATE_VOLUME, -1, next.volume);
+  for (int i = 0; i < AUDIO_STATE_STREAMS; i++) {
+    if (next.volumes[i] != state.volumes[i])
+      queued |= queue(AUDIO_STATE_STREAM_VOLUME, next.streams[i],
+                      next.volumes[i]);
+    if (next.playing[i] != state.playing[i])
+      queued |= queue(AUDIO_STATE_PLAYING, next.streams[i], next.playing[i]);
+  }
+  state = next;
+  return queued;
+}
+
+bool AudioStateCache::queue(int type, int stream, int value) {
+  if (callback == NULL)
+    return false;
+  if (events.size() >= AUDIO_STATE_MAX_EVENTS)
+    events.erase(events.begin());
+  AudioStateEvent event = { type, stream, value };
+  events.push_back(event);
+  return true;
+}
+
+void AudioStateCache::notify(bool queued) {
+  if (!queued)
+    return;
+  pthread_mutex_lock(&mutex);
+  audio_state_callback cb = callback;
+  void* data = callback_data;
+  pthread_mutex_unlock(&mutex);
+  if (cb)
+    cb(data);
+}
+
+void AudioStateCache::setMuted(bool muted) {
+  bool queued = false;
+  pthread_mutex_lock(&mutex);
+  generation++;
+  if (loaded && state.muted != muted) {
+    state.muted = muted;
+    queued = queue(AUDIO_STATE_MUTE, -1, muted);
+  }
+  pthread_mutex_unlock(&mutex);
+  notify(queued);
+}
+
+void AudioStateCache::setVolume(int volume) {
+  bool queued = false;
+  pthread_mutex_lock(&mutex);
+  generation++;
+  if (loaded && state.volume != volume) {
+    state.volume = volume;
+    queued = queue(AUDIO_STATE_VOLUME, -1, volume);
+  }
+  pthread_mutex_unlock(&mutex);
+  notify(queued);
+}
+
+void AudioStateCache::setStreamVolume(int stream, int volume) {
+  int i = indexOf(stream);
+  if (i < 0)
+    return;
+  bool queued = false;
+  pthread_mutex_lock(&mutex);
+  generation++;
+  if (loaded && state.volumes[i] != volume) {
+    state.volumes[i] = volume;
+    queued = queue(AUDIO_STATE_STREAM_VOLUME, stream, volume);
+  }
+  pthread_mutex_unlock(&mutex);
+  notify(queued);
+}
+
+void AudioStateCache::setListener(audio_state_callback callback_,
+                                  void* data) {
+  pthread_mutex_lock(&mutex);
+  callback = callback_;
+  callback_data = data;
+  events.clear();
+  pthread_mutex_unlock(&mutex);
+  if (callback_ != NULL) {
+    if (!isFresh())
+      refresh();
+    ensureStarted();
+  } else {
+    stopWatcher();
+  }
+}
+
+void AudioStateCache::takeEvents(vector<AudioStateEvent>& out) {
+  pthread_mutex_lock(&mutex);
+  out.swap(events);
+  events.clear();
+  pthread_mutex_unlock(&mutex);
+}
+
+void* AudioStateCache::Run(void* data) {
+  static_cast<AudioStateCache*>(data)->loop();
+  return NULL;
+}
+
+void AudioStateCache::loop() {
+  pthread_mutex_lock(&mutex);
+  while (!stopping) {
+    uint64_t next = monotonic_now() + AUDIO_STATE_INTERVAL * NS_PER_MS;
+    struct timespec ts;
+    ts.tv_sec = next / NS_PER_SEC;
+    ts.tv_nsec = next % NS_PER_SEC;
+    pthread_cond_timedwait(&cond, &mutex, &ts);
+    if (stopping)
+      break;
+    pthread_mutex_unlock(&mutex);
+    refresh();
+    pthread_mutex_lock(&mutex);
+  }
+  pthread_mutex_unlock(&mutex);
+}
@@ -0,0 +1,107 @@
+#ifndef AUDIO_STATE_H
+#define AUDIO_STATE_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <vector>
+using namespace std;
+
+// the streams of rk_stream_type_t
+#define AUDIO_STATE_STREAMS 7
+// the interval in ms between two reads of the watcher
+#define AUDIO_STATE_INTERVAL 200
+// the ms a read of the driver is reused for by the queries
+#define AUDIO_STATE_TTL 50
+// the events kept for the listener, the oldest ones are dropped
+#define AUDIO_STATE_MAX_EVENTS 256
+
+enum AudioStateChange {
+  AUDIO_STATE_MUTE = 0,
+  AUDIO_STATE_VOLUME,
+  AUDIO_STATE_STREAM_VOLUME,
+  AUDIO_STATE_PLAYING,
+};
+
+struct AudioStateSnapshot {
+  bool muted;
+  // the media volume
+  int volume;
+  int streams[AUDIO_STATE_STREAMS];
+  int volumes[AUDIO_STATE_STREAMS];
+  bool playing[AUDIO_STATE_STREAMS];
+};
+
+struct AudioStateEvent {
+  int type;
+  // the stream of the STREAM_VOLUME and PLAYING changes, otherwise -1
+  int stream;
+  int value;
+};
+
+typedef void (*audio_state_callback)(void* data);
+
+/**
+ * @class AudioStateCache
+ * Keeps the mute, volumes and playing status read from `vol_ctrl`, so the
+ * queries don't call into the driver. The cache is updated by the setters
+ * of this process, and read again once it's older than the ttl to catch the
+ * changes of the other processes. A watcher thread reads the driver on every
+ * interval only while a listener is set.
+ */
+class AudioStateCache {
+ public:
+  AudioStateCache();
+  ~AudioStateCache();
+
+  /**
+   * @method snapshot
+   * copies the cached state, the driver is read again if it's expired.
+   */
+  void snapshot(AudioStateSnapshot& out);
+  /**
+   * @method refresh
+   * reads the driver on the calling thread.
+   */
+  void refresh();
+  void setMuted(bool muted);
+  void setVolume(int volume);
+  void setStreamVolume(int stream, int volume);
+  /**
+   * @method setListener
+   * the callback is called on any thread once the events are queued, the
+   * watcher runs until it's set to NULL.
+   */
+  void setListener(audio_state_callback callback, void* data);
+  void takeEvents(vector<AudioStateEvent>& events);
+
+ private:
+  static void* Run(void* data);
+  void loop();
+  void read(AudioStateSnapshot& out);
+  void ensureStarted();
+  void stopWatcher();
+  bool isFresh();
+  int indexOf(int stream);
+  // called with the lock held, returns if any event is queued.
+  bool apply(const AudioStateSnapshot& next);
+  bool queue(int type, int stream, int value);
+  void notify(bool queued);
+
+ private:
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  bool started = false;
+  bool loaded = false;
+  bool stopping = false;
+  // the monotonic ns of the last read
+  uint64_t loaded_at = 0;
+  // bumped by the setters to discard the reads they raced with
+  uint64_t generation = 0;
+  AudioStateSnapshot state;
+  vector<AudioStateEvent> events;
+  audio_state_callback callback = NULL;
+  void* callback_data = NULL;
+};
+
+#endif // AUDIO_STATE_H
@@ -0,0 +1,58 @@
+#include "VolumeCurve.h"
+#include <errno.h>
+#include <math.h>
+
+static double volume_curve_point(const double* levels, size_t count,
+                                 size_t i) {
+  if (levels)
+    return levels[i];
+  return (double)(VOLUME_CURVE_LEVELS - 1) * i / (count - 1);
+}
+
+static double volume_curve_interpolate(double a, double b, double t,
+                                       int interpolation) {
+  switch (interpolation) {
+    case VOLUME_INTERPOLATION_DB:
+      // the silence has no dB, so the segments from or to 0 stay linear
+      if (a > 0 && b > 0)
+        return a * pow(b / a, t);
+      break;
+    case VOLUME_INTERPOLATION_LOG:
+      return a + (b - a) * log10(1 + 9 * t);
+    default:
+      break;
+  }
+  return a + (b - a) * t;
+}
+
+int volume_curve_build(const double* levels, const double* values,
+                       size_t count, int interpolation, int* curve) {
+  if (count < 2)
+    return -EINVAL;
+  if (levels) {
+    if (levels[0] != 0 || levels[count - 1] != VOLUME_CURVE_LEVELS - 1)
+      return -EINVAL;
+    for (size_t i = 1; i < count; i++) {
+      if (!(levels[i] > levels[i - 1]))
+        return -EINVAL;
+    }
+  }
+  for (size_t i = 0; i < count; i++) {
+    if (!(values[i] >= 0))
+      return -EINVAL;
+  }
+
+  size_t segment = 0;
+  for (int level = 0; level < VOLUME_CURVE_LEVELS; level++) {
+    while (segment + 2 < count &&
+           level > volume_curve_point(levels, count, segment + 1))
+      segment++;
+    double from = volume_curve_point(levels, count, segment);
+    double to = volume_curve_point(levels, count, segment + 1);
+    double t = (level - from) / (to - from);
+    t = t < 0 ? 0 : (t > 1 ? 1 : t);
+    curve[level] = (int)lround(volume_curve_interpolate(
+        values[segment], values[segment + 1], t, interpolation));
+  }
+  return 0;
+}
@@ -0,0 +1,26 @@
+#ifndef VOLUME_CURVE_H
+#define VOLUME_CURVE_H
+
+#include <stddef.h>
+
+// the levels of a volume curve, 0..100
+#define VOLUME_CURVE_LEVELS 101
+
+enum VolumeInterpolation {
+  VOLUME_INTERPOLATION_LINEAR = 0,
+  // geometric between the points, so the steps are even in dB
+  VOLUME_INTERPOLATION_DB,
+  // the logarithmic taper along the levels of every segment
+  VOLUME_INTERPOLATION_LOG,
+};
+
+/**
+ * fills the full curve of VOLUME_CURVE_LEVELS values from the control points,
+ * the levels must be ascending in 0..100 and start with 0 and end with 100,
+ * or NULL to spread the values evenly, so 101 values are taken as they are.
+ * Returns 0 or -EINVAL.
+ */
+int volume_curve_build(const double* levels, const double* values,
+                       size_t count, int interpolation, int* curve);
+
+#endif // VOLUME_CURVE_H
@@ -0,0 +1,157 @@
+#include "VolumeRamp.h"
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+#include <vector>
+
+#define NS_PER_MS 1000000ULL
+#define NS_PER_SEC 1000000000ULL
+
+static uint64_t monotonic_now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+VolumeRamper::VolumeRamper(volume_set_callback set_) : set(set_) {
+  pthread_mutex_init(&mutex, NULL);
+  pthread_condattr_t attr;
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&cond, &attr);
+  pthread_condattr_destroy(&attr);
+}
+
+VolumeRamper::~VolumeRamper() {
+  if (started) {
+    pthread_mutex_lock(&mutex);
+    stopping = true;
+    pthread_cond_signal(&cond);
+    pthread_mutex_unlock(&mutex);
+    pthread_join(thread, NULL);
+  }
+  pthread_cond_destroy(&cond);
+  pthread_mutex_destroy(&mutex);
+}
+
+double VolumeRamper::ease(int fade, double t) {
+  switch (fade) {
+    case VOLUME_FADE_EASE_IN:
+      return t * t;
+    case VOLUME_FADE_EASE_OUT:
+      return 1 - (1 - t) * (1 - t);
+    case VOLUME_FADE_EASE_IN_OUT:
+      return t * t * (3 - 2 * t);
+    default:
+      return t;
+  }
+}
+
+bool VolumeRamper::start(int stream, int from, int target, uint32_t duration,
+                         int fade, volume_done_callback done, void* data) {
+  Ramp ramp = { from, target, from, fade,
+                monotonic_now(), (uint64_t)duration * NS_PER_MS,
+                done, data };
+  Ramp replaced = { 0 };
+  bool replacing = false;
+
+  pthread_mutex_lock(&mutex);
+  if (!started) {
+    if (pthread_create(&thread, NULL, VolumeRamper::Run, this) != 0) {
+      pthread_mutex_unlock(&mutex);
+      fprintf(stderr, "audio: failed to start the ramp thread(%d)\n", errno);
+      return false;
+    }
+    started = true;
+  }
+  auto it = ramps.find(stream);
+  if (it != ramps.end()) {
+    replaced = it->second;
+    replacing = true;
+    ramp.from = ramp.current = replaced.current;
+  }
+  ramps[stream] = ramp;
+  pthread_cond_signal(&cond);
+  pthread_mutex_unlock(&mutex);
+
+  if (replacing && replaced.done)
+    replaced.done(replaced.data, true, replaced.current);
+  return true;
+}
+
+bool VolumeRamper::cancel(int stream) {
+  pthread_mutex_lock(&mutex);
+  auto it = ramps.find(stream);
+  if (it == ramps.end()) {
+    pthread_mutex_unlock(&mutex);
+    return false;
+  }
+  Ramp ramp = it->second;
+  ramps.erase(it);
+  pthread_mutex_unlock(&mutex);
+
+  if (ramp.done)
+    ramp.done(ramp.data, true, ramp.current);
+  return true;
+}
+
+bool VolumeRamper::running(int stream) {
+  pthread_mutex_lock(&mutex);
+  bool found = ramps.find(stream) != ramps.end();
+  pthread_mutex_unlock(&mutex);
+  return found;
+}
+
+void* VolumeRamper::Run(void* data) {
+  static_cast<VolumeRamper*>(data)->loop();
+  return NULL;
+}
+
+void VolumeRamper::loop() {
+  vector<Ramp> finished;
+  pthread_mutex_lock(&mutex);
+  while (!stopping) {
+    if (ramps.empty()) {
+      pthread_cond_wait(&cond, &mutex);
+      continue;
+    }
+    uint64_t now = monotonic_now();
+    for (auto it = ramps.begin(); it != ramps.end();) {
+      Ramp& ramp = it->second;
+      double t = 1;
+      if (ramp.duration > 0 && now < ramp.begin + ramp.duration)
+        t = (double)(now - ramp.begin) / ramp.duration;
+      int volume = ramp.from +
+                   (int)lround((ramp.target - ramp.from) * ease(ramp.fade, t));
+      // the driver is called under the lock to keep the order with the
+      // ramps started meanwhile on the same stream.
+      if (volume != ramp.current) {
+        set(it->first, volume);
+        ramp.current = volume;
+      }
+      if (t >= 1) {
+        finished.push_back(ramp);
+        it = ramps.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    if (!finished.empty()) {
+      pthread_mutex_unlock(&mutex);
+      for (size_t i = 0; i < finished.size(); i++) {
+        if (finished[i].done)
+          finished[i].done(finished[i].data, false, finished[i].current);
+      }
+      finished.clear();
+      pthread_mutex_lock(&mutex);
+      continue;
+    }
+    uint64_t next = now + VOLUME_RAMP_INTERVAL * NS_PER_MS;
+    struct timespec ts;
+    ts.tv_sec = next / NS_PER_SEC;
+    ts.tv_nsec = next % NS_PER_SEC;
+    pthread_cond_timedwait(&cond, &mutex, &ts);
+  }
+  pthread_mutex_unlock(&mutex);
+}
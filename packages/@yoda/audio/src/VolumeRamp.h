@@ -0,0 +1,75 @@
+#ifndef VOLUME_RAMP_H
+#define VOLUME_RAMP_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <map>
+using namespace std;
+
+// the interval in ms between two steps of the ramps
+#define VOLUME_RAMP_INTERVAL 10
+
+enum VolumeFade {
+  VOLUME_FADE_LINEAR = 0,
+  VOLUME_FADE_EASE_IN,
+  VOLUME_FADE_EASE_OUT,
+  VOLUME_FADE_EASE_IN_OUT,
+};
+
+typedef int (*volume_set_callback)(int stream, int volume);
+typedef void (*volume_done_callback)(void* data, bool cancelled, int volume);
+
+/**
+ * @class VolumeRamper
+ * Fades the stream volumes on its own thread, every stream has at most one
+ * ramp and the driver is only called when the integer volume changes. The
+ * thread is started by the first ramp and sleeps while there is none.
+ */
+class VolumeRamper {
+ public:
+  VolumeRamper(volume_set_callback set);
+  ~VolumeRamper();
+
+  /**
+   * @method start
+   * ramps the stream from `from` to `target` in `duration` ms, the current
+   * ramp of the stream is cancelled and the new one starts from where it
+   * stopped. The done callback is called on the ramp thread once the target
+   * is reached.
+   */
+  bool start(int stream, int from, int target, uint32_t duration, int fade,
+             volume_done_callback done, void* data);
+  /**
+   * @method cancel
+   * stops the ramp of the stream at its current volume, the done callback
+   * is called on the calling thread.
+   */
+  bool cancel(int stream);
+  bool running(int stream);
+
+ private:
+  struct Ramp {
+    int from;
+    int target;
+    int current;
+    int fade;
+    uint64_t begin;
+    uint64_t duration;
+    volume_done_callback done;
+    void* data;
+  };
+  static void* Run(void* data);
+  static double ease(int fade, double t);
+  void loop();
+
+ private:
+  volume_set_callback set;
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  bool started = false;
+  bool stopping = false;
+  map<int, Ramp> ramps;
+};
+
+#endif // VOLUME_RAMP_H
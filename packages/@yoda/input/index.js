@@ -22,6 +22,13 @@ var ACTION_LONG_CLICK = 3
 // eslint-disable-next-line no-unused-vars
 var ACTION_SLIDE = 4
 
+var GESTURE_TYPES = {
+  click: 0,
+  longpress: 1,
+  combo: 2,
+  slide: 3
+}
+
 /**
  * Common base class for input events.
  * @constructor
@@ -59,6 +66,8 @@ function InputEvent (options) {
   this._handle = new InputWrap()
   this._handle.onevent = this.onevent.bind(this)
   this._handle.ongesture = this.ongesture.bind(this)
+  this._handle.onrecognized = this.onrecognized.bind(this)
+  this._gestures = []
 }
 inherits(InputEvent, EventEmitter)
 
@@ -153,6 +162,111 @@ InputEvent.prototype.ongesture = function (action, code, slideValue, clickCount,
   }
 }
 
+/**
+ * @private
+ * @param {Number} index - the index of the gesture config
+ * @param {Number} code - the key code
+ * @param {Number} value - the click count, repeat count, key count or step
+ * @param {Number} duration - the duration in ms
+ */
+InputEvent.prototype.onrecognized = function (index, code, value, duration) {
+  var gesture = this._gestures[index]
+  if (!gesture) {
+    return
+  }
+  /**
+   * the recognized gesture, emitted with the name of the gesture config too.
+   * @event module:@yoda/input~InputEvent#gesture
+   * @type {Object}
+   * @property {String} name - the name of the gesture config
+   * @property {String} type - click, longpress, combo or slide
+   * @property {Number} keyCode - the key code
+   * @property {Number} value - the click count of a click, the repeat count
+   *   (0 for the first) of a long press, the key count of a combo and the
+   *   signed step of a slide.
+   * @property {Number} duration - the press duration of a click or long press,
+   *   the interval of a combo or slide in ms.
+   */
+  var event = {
+    name: gesture.name,
+    type: gesture.type,
+    keyCode: code,
+    value: value,
+    duration: duration
+  }
+  this.emit('gesture', event)
+  if (gesture.name) {
+    this.emit(gesture.name, event)
+  }
+}
+
+/**
+ * Configure the native gesture recognizer, the timings are decided natively
+ * with the timestamps of the key events, and only the recognized gestures are
+ * emitted unless `raw` is true. An empty list stops the recognizer.
+ *
+ * @param {Object} config
+ * @param {Boolean} [config.raw=false] - if still emits the raw events.
+ * @param {Object[]} config.gestures
+ * @param {String} config.gestures[].name - the event name to emit.
+ * @param {String} config.gestures[].type - click, longpress, combo or slide.
+ * @param {Number} [config.gestures[].keyCode] - the key, any key if omitted.
+ * @param {Number[]} [config.gestures[].keys] - the keys of a combo.
+ * @param {Number} [config.gestures[].window] - the ms to count the clicks of
+ *   a click, or the ms all keys of a combo must be pressed within.
+ * @param {Number} [config.gestures[].threshold] - the ms to hold of a long
+ *   press, or the ms between the slides to accelerate.
+ * @param {Number} [config.gestures[].repeat] - the repeat interval in ms of a
+ *   long press, 0 to not repeat.
+ * @param {Number} [config.gestures[].maxStep] - the maximum step of a slide.
+ * @returns {Number} 0 on success.
+ * @fires module:@yoda/input~InputEvent#gesture
+ * @example
+ * inputEvent.setGestures({
+ *   gestures: [
+ *     { name: 'volume-up', type: 'longpress', keyCode: 115, threshold: 800, repeat: 200 },
+ *     { name: 'mute', type: 'click', keyCode: 113, window: 300 },
+ *     { name: 'reset', type: 'combo', keys: [ 113, 114 ], window: 200 },
+ *     { name: 'volume', type: 'slide', threshold: 150, maxStep: 5 }
+ *   ]
+ * })
+ */
+InputEvent.prototype.setGestures = function (config) {
+  var gestures = (config && config.gestures) || []
+  var rules = gestures.map((gesture) => {
+    var type = GESTURE_TYPES[gesture.type]
+    if (type === undefined) {
+      throw new TypeError(`unknown gesture type ${gesture.type}`)
+    }
+    var keys
+    if (gesture.type === 'combo') {
+      if (!Array.isArray(gesture.keys) || gesture.keys.length < 2 ||
+        gesture.keys.length > 4) {
+        throw new TypeError('keys of a combo must be 2 to 4 key codes')
+      }
+      keys = gesture.keys
+    } else {
+      keys = [ gesture.keyCode == null ? -1 : gesture.keyCode ]
+    }
+    var threshold = 0
+    var interval = 0
+    if (gesture.type === 'click') {
+      interval = gesture.window || 0
+    } else if (gesture.type === 'longpress') {
+      threshold = gesture.threshold || 1000
+      interval = gesture.repeat || 0
+    } else if (gesture.type === 'combo') {
+      threshold = gesture.window || 200
+    } else {
+      threshold = gesture.threshold || 200
+      interval = gesture.maxStep || 1
+    }
+    return [ type, threshold, interval ].concat(keys)
+  })
+  this._gestures = gestures
+  return this._handle.setGestures(rules, !!(config && config.raw))
+}
+
 /**
  * start handling event
  * @fires module:@yoda/input~InputEvent#keyup
@@ -172,6 +286,73 @@ InputEvent.prototype.disconnect = function () {
   return this._handle.disconnect()
 }
 
+/**
+ * record the received events with their timestamps into the file, which can
+ * be replayed by `replay()`.
+ * @param {String} path - the file to record into.
+ * @returns {Number} 0 on success.
+ */
+InputEvent.prototype.record = function (path) {
+  return this._handle.record(path)
+}
+
+/**
+ * stop recording.
+ */
+InputEvent.prototype.stopRecord = function () {
+  return this._handle.stopRecord()
+}
+
+/**
+ * replay the recorded file instead of listening to the input devices, the
+ * events are emitted as if they're received. It must not be called after
+ * `start()`.
+ * @param {String} path - the recorded file.
+ * @param {Object} [options]
+ * @param {Number} [options.speed=1] - the speed of the replay, 0 to replay
+ *   without delays.
+ * @param {Function} callback - fired with the latency stats when the file is
+ *   replayed, see `getLatency()`.
+ * @returns {Number} 0 on success.
+ */
+InputEvent.prototype.replay = function (path, options, callback) {
+  if (typeof options === 'function') {
+    callback = options
+    options = {}
+  }
+  var speed = (options && options.speed != null) ? options.speed : 1
+  if (typeof speed !== 'number' || speed < 0) {
+    throw new TypeError('speed must be a non-negative number')
+  }
+  return this._handle.replay(path, speed, () => {
+    var stats = this.getLatency()
+    this.disconnect()
+    if (typeof callback === 'function') {
+      callback(null, stats)
+    }
+  })
+}
+
+/**
+ * @typedef LatencyStats
+ * @property {Number} count - the delivered events.
+ * @property {Number} min - in ms.
+ * @property {Number} max - in ms.
+ * @property {Number} mean - in ms.
+ * @property {Number} p50 - in ms.
+ * @property {Number} p95 - in ms.
+ * @property {Number} p99 - in ms.
+ */
+
+/**
+ * get the stats of the latency from an event is posted by the source to it's
+ * delivered to `onevent`/`ongesture`, over the latest 4096 events.
+ * @returns {module:@yoda/input~LatencyStats}
+ */
+InputEvent.prototype.getLatency = function () {
+  return this._handle.getLatency()
+}
+
 /**
  * get the event handler
  * @function defaults
@@ -206,3 +387,4 @@ function getHandler (options) {
 }
 
 module.exports = getHandler
+module.exports.InputEvent = InputEvent
@@ -0,0 +1,335 @@
+#include "GestureRecognizer.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#define NS_PER_MS 1000000ULL
+
+static uint64_t monotonic_now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+GestureRecognizer::GestureRecognizer() {
+  pthread_mutex_init(&mutex, NULL);
+}
+
+GestureRecognizer::~GestureRecognizer() {
+  stop();
+  pthread_mutex_destroy(&mutex);
+}
+
+bool GestureRecognizer::start(gesture_callback cb, void* data) {
+  if (started)
+    return true;
+  callback = cb;
+  callback_data = data;
+  epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (epoll_fd < 0 || event_fd < 0)
+    goto failed;
+  struct epoll_event ev;
+  ev.events = EPOLLIN;
+  ev.data.fd = event_fd;
+  if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, event_fd, &ev) != 0)
+    goto failed;
+  stopping = false;
+  if (pthread_create(&thread, NULL, GestureRecognizer::Run, this) != 0)
+    goto failed;
+  pthread_mutex_lock(&mutex);
+  started = true;
+  pthread_mutex_unlock(&mutex);
+  return true;
+
+failed:
+  fprintf(stderr, "gesture: failed to start the recognizer(%d)\n", errno);
+  if (epoll_fd >= 0)
+    close(epoll_fd);
+  if (event_fd >= 0)
+    close(event_fd);
+  epoll_fd = event_fd = -1;
+  return false;
+}
+
+void GestureRecognizer::stop() {
+  // the feeds and the configures check the flag and wake up the thread under
+  // the lock, so none of them writes to the event fd once it's cleared.
+  pthread_mutex_lock(&mutex);
+  if (!started) {
+    pthread_mutex_unlock(&mutex);
+    return;
+  }
+  started = false;
+  stopping = true;
+  wakeup();
+  pthread_mutex_unlock(&mutex);
+  pthread_join(thread, NULL);
+  close(epoll_fd);
+  close(event_fd);
+  epoll_fd = event_fd = -1;
+}
+
+bool GestureRecognizer::running() {
+  pthread_mutex_lock(&mutex);
+  bool ret = started;
+  pthread_mutex_unlock(&mutex);
+  return ret;
+}
+
+void GestureRecognizer::configure(const vector<GestureRule>& rules_) {
+  pthread_mutex_lock(&mutex);
+  pending_rules = rules_;
+  rules_changed = true;
+  if (started)
+    wakeup();
+  pthread_mutex_unlock(&mutex);
+}
+
+void GestureRecognizer::feedKey(int key_code, bool down, uint64_t at) {
+  Input input;
+  input.key_code = key_code;
+  input.kind = down ? 1 : 0;
+  input.direction = 0;
+  input.at = at;
+  feed(input);
+}
+
+void GestureRecognizer::feedSlide(int key_code, int direction, uint64_t at) {
+  Input input;
+  input.key_code = key_code;
+  input.kind = 2;
+  input.direction = direction;
+  input.at = at;
+  feed(input);
+}
+
+void GestureRecognizer::feed(const Input& input) {
+  pthread_mutex_lock(&mutex);
+  if (started) {
+    inputs.push_back(input);
+    wakeup();
+  }
+  pthread_mutex_unlock(&mutex);
+}
+
+// wakes up the thread, the mutex must be held.
+void GestureRecognizer::wakeup() {
+  uint64_t one = 1;
+  if (write(event_fd, &one, sizeof(one)) < 0) {
+    fprintf(stderr, "gesture: failed to wake up the recognizer(%d)\n", errno);
+  }
+}
+
+void* GestureRecognizer::Run(void* data) {
+  GestureRecognizer* self = static_cast<GestureRecognizer*>(data);
+  struct epoll_event ev;
+  uint64_t counter;
+  while (!self->stopping) {
+    int timeout = self->nextTimeout(monotonic_now());
+    int r = epoll_wait(self->epoll_fd, &ev, 1, timeout);
+    if (r < 0 && errno != EINTR) {
+      fprintf(stderr, "gesture: epoll_wait failed(%d)\n", errno);
+      break;
+    }
+    if (r > 0 && read(self->event_fd, &counter, sizeof(counter)) < 0 &&
+        errno != EAGAIN) {
+      fprintf(stderr, "gesture: failed to read the event(%d)\n", errno);
+    }
+    if (self->stopping)
+      break;
+
+    deque<Input> received;
+    pthread_mutex_lock(&self->mutex);
+    received.swap(self->inputs);
+    if (self->rules_changed) {
+      self->rules = self->pending_rules;
+      self->rules_changed = false;
+      self->keys.clear();
+      self->slide_step = 0;
+    }
+    pthread_mutex_unlock(&self->mutex);
+
+    for (size_t i = 0; i < received.size(); i++) {
+      // the deadlines before the input are handled first
+      self->onTimers(received[i].at);
+      self->process(received[i]);
+    }
+    self->onTimers(monotonic_now());
+  }
+  return NULL;
+}
+
+void GestureRecognizer::process(const Input& input) {
+  if (input.kind == 1) {
+    onKeyDown(input.key_code, input.at);
+  } else if (input.kind == 0) {
+    onKeyUp(input.key_code, input.at);
+  } else {
+    onSlide(input.key_code, input.direction, input.at);
+  }
+}
+
+int GestureRecognizer::findRule(int type, int key_code) {
+  for (size_t i = 0; i < rules.size(); i++) {
+    const GestureRule& rule = rules[i];
+    if (rule.type != type)
+      continue;
+    if (rule.key_count == 0 || rule.keys[0] == GESTURE_ANY_KEY ||
+        rule.keys[0] == key_code)
+      return (int)i;
+  }
+  return -1;
+}
+
+void GestureRecognizer::onKeyDown(int key_code, uint64_t at) {
+  KeyState& state = keys[key_code];
+  if (state.down)
+    return;
+  // a pending multi-click is continued by this press
+  int clicks = state.clicks;
+  memset(&state, 0, sizeof(state));
+  state.clicks = clicks;
+  state.down = true;
+  state.down_at = at;
+  state.click_rule = -1;
+  state.longpress_rule = findRule(GESTURE_RULE_LONGPRESS, key_code);
+  if (state.longpress_rule >= 0) {
+    state.longpress_deadline =
+        at + rules[state.longpress_rule].threshold * NS_PER_MS;
+  }
+
+  for (size_t i = 0; i < rules.size(); i++) {
+    const GestureRule& rule = rules[i];
+    if (rule.type != GESTURE_RULE_COMBO || rule.key_count < 2)
+      continue;
+    bool matched = true;
+    bool involved = false;
+    uint64_t first = at;
+    for (int k = 0; k < rule.key_count && matched; k++) {
+      map<int, KeyState>::iterator it = keys.find(rule.keys[k]);
+      if (it == keys.end() || !it->second.down || it->second.consumed) {
+        matched = false;
+        break;
+      }
+      involved = involved || rule.keys[k] == key_code;
+      first = it->second.down_at < first ? it->second.down_at : first;
+    }
+    if (!matched || !involved ||
+        at - first > (uint64_t)rule.threshold * NS_PER_MS)
+      continue;
+    // the keys of the combo don't make any other gestures until released
+    for (int k = 0; k < rule.key_count; k++) {
+      KeyState& item = keys[rule.keys[k]];
+      item.consumed = true;
+      item.clicks = 0;
+      item.click_deadline = 0;
+      item.longpress_deadline = 0;
+    }
+    emit((int)i, rule.keys[0], rule.key_count,
+         (int)((at - first) / NS_PER_MS));
+    break;
+  }
+}
+
+void GestureRecognizer::onKeyUp(int key_code, uint64_t at) {
+  map<int, KeyState>::iterator it = keys.find(key_code);
+  if (it == keys.end() || !it->second.down)
+    return;
+  KeyState& state = it->second;
+  state.down = false;
+  state.longpress_deadline = 0;
+  if (state.consumed || state.repeats > 0)
+    return;
+
+  int rule = findRule(GESTURE_RULE_CLICK, key_code);
+  if (rule < 0)
+    return;
+  state.clicks += 1;
+  state.click_rule = rule;
+  if (rules[rule].interval <= 0) {
+    emit(rule, key_code, state.clicks,
+         (int)((at - state.down_at) / NS_PER_MS));
+    state.clicks = 0;
+  } else {
+    state.click_deadline = at + rules[rule].interval * NS_PER_MS;
+  }
+}
+
+void GestureRecognizer::onSlide(int key_code, int direction, uint64_t at) {
+  int rule = findRule(GESTURE_RULE_SLIDE, key_code);
+  if (rule < 0)
+    return;
+  const GestureRule& item = rules[rule];
+  uint64_t elapsed = at - last_slide_at;
+  if (last_slide_at > 0 && elapsed <= (uint64_t)item.threshold * NS_PER_MS) {
+    int max_step = item.interval > 0 ? item.interval : 1;
+    slide_step = slide_step < max_step ? slide_step + 1 : max_step;
+  } else {
+    slide_step = 1;
+  }
+  last_slide_at = at;
+  emit(rule, key_code, direction * slide_step,
+       (int)(elapsed / NS_PER_MS));
+}
+
+void GestureRecognizer::onTimers(uint64_t now) {
+  map<int, KeyState>::iterator it = keys.begin();
+  for (; it != keys.end(); ++it) {
+    KeyState& state = it->second;
+    if (state.click_deadline > 0 && now >= state.click_deadline) {
+      emit(state.click_rule, it->first, state.clicks, 0);
+      state.clicks = 0;
+      state.click_deadline = 0;
+    }
+    if (state.down && state.longpress_deadline > 0 &&
+        now >= state.longpress_deadline) {
+      const GestureRule& rule = rules[state.longpress_rule];
+      emit(state.longpress_rule, it->first, state.repeats,
+           (int)((state.longpress_deadline - state.down_at) / NS_PER_MS));
+      // a long press cancels the pending clicks of the key
+      state.clicks = 0;
+      state.click_deadline = 0;
+      state.repeats += 1;
+      state.longpress_deadline = rule.interval > 0
+                                     ? state.longpress_deadline +
+                                           rule.interval * NS_PER_MS
+                                     : 0;
+    }
+  }
+}
+
+int GestureRecognizer::nextTimeout(uint64_t now) {
+  uint64_t nearest = 0;
+  map<int, KeyState>::iterator it = keys.begin();
+  for (; it != keys.end(); ++it) {
+    const KeyState& state = it->second;
+    uint64_t deadlines[2] = { state.click_deadline,
+                              state.down ? state.longpress_deadline : 0 };
+    for (int i = 0; i < 2; i++) {
+      if (deadlines[i] > 0 && (nearest == 0 || deadlines[i] < nearest))
+        nearest = deadlines[i];
+    }
+  }
+  if (nearest == 0)
+    return -1;
+  if (nearest <= now)
+    return 0;
+  return (int)((nearest - now + NS_PER_MS - 1) / NS_PER_MS);
+}
+
+void GestureRecognizer::emit(int rule, int key_code, int value,
+                             int duration) {
+  if (callback == NULL || rule < 0)
+    return;
+  RecognizedGesture gesture;
+  gesture.rule = rule;
+  gesture.key_code = key_code;
+  gesture.value = value;
+  gesture.duration = duration;
+  callback(callback_data, gesture);
+}
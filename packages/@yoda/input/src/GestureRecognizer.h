@@ -0,0 +1,129 @@
+#ifndef GESTURE_RECOGNIZER_H
+#define GESTURE_RECOGNIZER_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <deque>
+#include <map>
+#include <vector>
+using namespace std;
+
+#define GESTURE_RULE_MAX_KEYS 4
+// matches any key code
+#define GESTURE_ANY_KEY -1
+
+enum GestureRuleType {
+  // released before any long press, counted within `interval` ms
+  GESTURE_RULE_CLICK = 0,
+  // held for `threshold` ms, then repeated every `interval` ms if non-zero
+  GESTURE_RULE_LONGPRESS,
+  // all keys are pressed within `threshold` ms
+  GESTURE_RULE_COMBO,
+  // the step grows by one up to `interval` while the slides come within
+  // `threshold` ms
+  GESTURE_RULE_SLIDE,
+};
+
+struct GestureRule {
+  int type;
+  int threshold;
+  int interval;
+  int key_count;
+  int keys[GESTURE_RULE_MAX_KEYS];
+};
+
+/**
+ * The recognized gesture, the value is the click count for a click, the repeat
+ * count for a long press, the key count for a combo and the signed step for a
+ * slide.
+ */
+struct RecognizedGesture {
+  int rule;
+  int key_code;
+  int value;
+  int duration;
+};
+
+typedef void (*gesture_callback)(void*, const RecognizedGesture&);
+
+/**
+ * @class GestureRecognizer
+ * Recognizes the configured gestures from the raw key events on its own
+ * thread, which waits on an epoll instance until the next input or the
+ * nearest deadline of the rules.
+ */
+class GestureRecognizer {
+ public:
+  GestureRecognizer();
+  ~GestureRecognizer();
+
+  bool start(gesture_callback cb, void* data);
+  void stop();
+  bool running();
+  void configure(const vector<GestureRule>& rules);
+  /**
+   * @method feedKey
+   * feeds a key down or up at the monotonic time in ns.
+   */
+  void feedKey(int key_code, bool down, uint64_t at);
+  /**
+   * @method feedSlide
+   * feeds a slide with the direction 1 or -1.
+   */
+  void feedSlide(int key_code, int direction, uint64_t at);
+
+ private:
+  struct Input {
+    int key_code;
+    // 1 for down, 0 for up and 2 for slide
+    int kind;
+    int direction;
+    uint64_t at;
+  };
+  struct KeyState {
+    bool down;
+    bool consumed;
+    uint64_t down_at;
+    int clicks;
+    uint64_t click_deadline;
+    int click_rule;
+    int repeats;
+    uint64_t longpress_deadline;
+    int longpress_rule;
+  };
+
+  static void* Run(void* data);
+  void feed(const Input& input);
+  void wakeup();
+  void process(const Input& input);
+  void onKeyDown(int key_code, uint64_t at);
+  void onKeyUp(int key_code, uint64_t at);
+  void onSlide(int key_code, int direction, uint64_t at);
+  void onTimers(uint64_t now);
+  int nextTimeout(uint64_t now);
+  int findRule(int type, int key_code);
+  void emit(int rule, int key_code, int value, int duration);
+
+ private:
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  int epoll_fd = -1;
+  int event_fd = -1;
+  volatile bool stopping = false;
+  gesture_callback callback = NULL;
+  void* callback_data = NULL;
+
+  // guarded by mutex
+  bool started = false;
+  deque<Input> inputs;
+  vector<GestureRule> pending_rules;
+  bool rules_changed = false;
+
+  // owned by the thread
+  vector<GestureRule> rules;
+  map<int, KeyState> keys;
+  uint64_t last_slide_at = 0;
+  int slide_step = 0;
+};
+
+#endif
@@ -1,4 +1,11 @@
 #include "InputNative.h"
+#include <errno.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/time.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <time.h>
 
@@ -12,206 +19,512 @@ static JNativeInfoType this_module_native_info = {
   .free_cb = (jerry_object_native_free_callback_t)iotjs_input_destroy
 };
 
-class InputInitializer {
- public:
-  InputInitializer() {
+// the gesture action of a slide from input-event
+#define INPUT_ACTION_SLIDE 4
+
+// the interval to retry the initialization of the input devices
+#define INPUT_INIT_RETRY_INTERVAL 1000
+
+InputEventHandler::InputEventHandler() {
+  // TODO
+}
+
+InputEventHandler::InputEventHandler(iotjs_input_t* inputwrap_) {
+  inputwrap = inputwrap_;
+  keyevent_ = { 0 };
+  gesture_ = { 0 };
+  need_destroy_ = false;
+  started_ = false;
+  epoll_fd_ = -1;
+  wakeup_fd_ = -1;
+  ring_head_ = 0;
+  ring_tail_ = 0;
+  dropped_ = 0;
+  notify_ = NULL;
+  onevent_ = jerry_create_undefined();
+  ongesture_ = jerry_create_undefined();
+  onrecognized_ = jerry_create_undefined();
+  deliver_raw_ = true;
+  pthread_mutex_init(&post_mutex_, NULL);
+  pthread_mutex_init(&record_mutex_, NULL);
+  record_file_ = NULL;
+  replay_file_ = NULL;
+  replay_speed_ = 1;
+  replay_callback_ = jerry_create_undefined();
+  latency_count_ = 0;
+}
+
+InputEventHandler::~InputEventHandler() {
+  recognizer_.stop();
+  stop();
+  stopRecord();
+  releaseCallbacks();
+  pthread_mutex_destroy(&record_mutex_);
+  pthread_mutex_destroy(&post_mutex_);
+}
+
+int InputEventHandler::start(int timeout_select, int timeout_dbclick,
+                             int timeout_slide) {
+  if (started_)
+    return 0;
+  timeout_select_ = timeout_select;
+  timeout_dbclick_ = timeout_dbclick;
+  timeout_slide_ = timeout_slide;
+  return startThread(InputEventHandler::Run);
+}
+
+int InputEventHandler::replay(const char* path, double speed,
+                              jerry_value_t callback) {
+  if (started_)
+    return -1;
+  replay_file_ = fopen(path, "r");
+  if (replay_file_ == NULL) {
+    fprintf(stderr, "input: cannot open %s(%d)\n", path, errno);
+    return -1;
   }
-  InputInitializer(iotjs_input_t* inputwrap_) {
-    inputwrap = inputwrap_;
-    initialized = false;
-    req.data = this;
+  replay_speed_ = speed;
+  jerry_release_value(replay_callback_);
+  replay_callback_ = jerry_acquire_value(callback);
+  latency_count_ = 0;
+  int r = startThread(InputEventHandler::RunReplay);
+  if (r != 0) {
+    fclose(replay_file_);
+    replay_file_ = NULL;
   }
-  ~InputInitializer() {
+  return r;
+}
+
+int InputEventHandler::startThread(void* (*run)(void*)) {
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (epoll_fd_ < 0 || wakeup_fd_ < 0) {
+    goto failed;
   }
+  struct epoll_event ev;
+  ev.events = EPOLLIN;
+  ev.data.fd = wakeup_fd_;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &ev) != 0) {
+    goto failed;
+  }
+  lookupCallbacks();
+  ring_head_ = 0;
+  ring_tail_ = 0;
+  notify_ = new uv_async_t;
+  notify_->data = this;
+  uv_async_init(uv_default_loop(), notify_, InputEventHandler::OnEvents);
 
- public:
-  int start(int timeout_select_, int timeout_dbclick_, int timeout_slide_) {
-    timeout_select = timeout_select_;
-    timeout_dbclick = timeout_dbclick_;
-    timeout_slide = timeout_slide_;
+  need_destroy_ = false;
+  if (pthread_create(&thread_, NULL, run, this) != 0) {
+    pthread_mutex_lock(&post_mutex_);
+    uv_close((uv_handle_t*)notify_, InputEventHandler::AfterClose);
+    notify_ = NULL;
+    pthread_mutex_unlock(&post_mutex_);
+    goto failed;
+  }
+  started_ = true;
+  return 0;
+
+failed:
+  fprintf(stderr, "input: failed to start the listener(%d)\n", errno);
+  if (epoll_fd_ >= 0)
+    close(epoll_fd_);
+  if (wakeup_fd_ >= 0)
+    close(wakeup_fd_);
+  epoll_fd_ = wakeup_fd_ = -1;
+  return -1;
+}
 
-    return uv_queue_work(uv_default_loop(), &req, InputInitializer::DoStart,
-                         InputInitializer::AfterStart);
+int InputEventHandler::stop() {
+  if (!started_)
+    return 0;
+  need_destroy_ = true;
+  uint64_t one = 1;
+  if (write(wakeup_fd_, &one, sizeof(one)) < 0) {
+    fprintf(stderr, "input: failed to wake up the listener(%d)\n", errno);
   }
-  int stop() {
-    return uv_cancel((uv_req_t*)&req);
+  // the listener returns at most after the select timeout
+  pthread_join(thread_, NULL);
+  // the events not yet delivered are dropped with the handle
+  pthread_mutex_lock(&post_mutex_);
+  uv_close((uv_handle_t*)notify_, InputEventHandler::AfterClose);
+  notify_ = NULL;
+  pthread_mutex_unlock(&post_mutex_);
+  close(epoll_fd_);
+  close(wakeup_fd_);
+  epoll_fd_ = wakeup_fd_ = -1;
+  if (replay_file_) {
+    fclose(replay_file_);
+    replay_file_ = NULL;
   }
+  started_ = false;
+  return 0;
+}
 
- public:
-  static void DoStart(uv_work_t* req) {
-    InputInitializer* initializer = (InputInitializer*)req->data;
-    while (true) {
-      fprintf(stdout, "config select(%dms) dbclick(%dms) slide(%dms)\n",
-              initializer->timeout_select, initializer->timeout_dbclick,
-              initializer->timeout_slide);
-      bool r =
-          init_input_key(IOTJS_INPUT_HAS_TOUCH, initializer->timeout_select,
-                         initializer->timeout_dbclick,
-                         initializer->timeout_slide);
-      if (r)
-        break;
-      sleep(1);
-    }
-  }
-  static void AfterStart(uv_work_t* req, int status) {
-    InputInitializer* initializer = (InputInitializer*)req->data;
-    iotjs_input_t* inputwrap = initializer->inputwrap;
-    IOTJS_VALIDATED_STRUCT_METHOD(iotjs_input_t, inputwrap);
+/**
+ * waits for the wakeup, returns true if the handler is woken up by `stop`.
+ */
+bool InputEventHandler::waitWakeup(int timeout) {
+  struct epoll_event ev;
+  int r = epoll_wait(epoll_fd_, &ev, 1, timeout);
+  return r > 0 || need_destroy_;
+}
 
-    if (!status /* success */) {
-      _this->event_handler->start();
-    } else {
-      // iotjs_input_onerror(_this);
+bool InputEventHandler::initialize() {
+  while (!need_destroy_) {
+    fprintf(stdout, "config select(%dms) dbclick(%dms) slide(%dms)\n",
+            timeout_select_, timeout_dbclick_, timeout_slide_);
+    if (init_input_key(IOTJS_INPUT_HAS_TOUCH, timeout_select_,
+                       timeout_dbclick_, timeout_slide_)) {
+      return true;
     }
+    if (waitWakeup(INPUT_INIT_RETRY_INTERVAL))
+      break;
   }
+  return false;
+}
 
- public:
-  bool initialized;
+void* InputEventHandler::Run(void* data) {
+  InputEventHandler* handler = (InputEventHandler*)data;
+  if (handler->initialize()) {
+    handler->listen();
+  }
+  fprintf(stdout, "input event handler stopped\n");
+  return NULL;
+}
 
- private:
-  iotjs_input_t* inputwrap;
-  uv_work_t req;
-  int timeout_select;
-  int timeout_dbclick;
-  int timeout_slide;
-};
+void InputEventHandler::listen() {
+  iotjs_input_event_t event;
+  while (true) {
+    if (need_destroy_ == true) {
+      break;
+    }
+    daemon_start_listener(&keyevent_, &gesture_);
+    if (keyevent_.new_action) {
+      event.kind = INPUT_EVENT_KEY;
+      event.key = keyevent_;
+      dispatch(event);
+      recordEvent(event);
+    }
+    if (gesture_.new_action) {
+      event.kind = INPUT_EVENT_GESTURE;
+      event.gesture = gesture_;
+      dispatch(event);
+      recordEvent(event);
+    }
+  }
+}
 
-class InputKeyEvent {
- public:
-  InputEventHandler* event_handler;
-  struct keyevent data;
-};
+void InputEventHandler::dispatch(iotjs_input_event_t& event) {
+  event.injected_at = uv_hrtime();
+  if (recognizer_.running()) {
+    if (event.kind == INPUT_EVENT_KEY &&
+        (event.key.value == 0 || event.key.value == 1)) {
+      recognizer_.feedKey(event.key.key_code, event.key.value == 1,
+                          event.injected_at);
+    } else if (event.kind == INPUT_EVENT_GESTURE &&
+               event.gesture.action == INPUT_ACTION_SLIDE) {
+      recognizer_.feedSlide(event.gesture.key_code,
+                            event.gesture.slide_value == 1 ? 1 : -1,
+                            event.injected_at);
+    }
+    if (!deliver_raw_)
+      return;
+  }
+  post(event);
+}
 
-class InputGestureEvent {
- public:
-  InputEventHandler* event_handler;
-  struct gesture data;
-};
+void InputEventHandler::OnRecognized(void* data,
+                                     const RecognizedGesture& gesture) {
+  InputEventHandler* handler = (InputEventHandler*)data;
+  iotjs_input_event_t event;
+  memset(&event, 0, sizeof(event));
+  event.kind = INPUT_EVENT_RECOGNIZED;
+  event.recognized = gesture;
+  handler->post(event);
+}
 
-InputEventHandler::InputEventHandler() {
-  // TODO
+void InputEventHandler::post(iotjs_input_event_t& event) {
+  if (event.injected_at == 0)
+    event.injected_at = uv_hrtime();
+  pthread_mutex_lock(&post_mutex_);
+  if (notify_ == NULL) {
+    pthread_mutex_unlock(&post_mutex_);
+    return;
+  }
+  uint32_t tail = ring_tail_.load(std::memory_order_relaxed);
+  uint32_t head = ring_head_.load(std::memory_order_acquire);
+  if (tail - head >= INPUT_EVENT_RING_SIZE) {
+    // the loop is too busy to catch up, drop the newest
+    dropped_ += 1;
+    fprintf(stderr, "input: ring is full, %u events dropped\n", dropped_);
+  } else {
+    ring_[tail & (INPUT_EVENT_RING_SIZE - 1)] = event;
+    ring_tail_.store(tail + 1, std::memory_order_release);
+  }
+  // the sends before the loop wakes up are coalesced
+  uv_async_send(notify_);
+  pthread_mutex_unlock(&post_mutex_);
 }
 
-InputEventHandler::InputEventHandler(iotjs_input_t* inputwrap_) {
-  inputwrap = inputwrap_;
-  keyevent_ = { 0 };
-  gesture_ = { 0 };
-  need_destroy_ = false;
-  req.data = this;
+int InputEventHandler::record(const char* path) {
+  FILE* fp = fopen(path, "w");
+  if (fp == NULL) {
+    fprintf(stderr, "input: cannot open %s(%d)\n", path, errno);
+    return -1;
+  }
+  fprintf(fp, "# yoda input record v1\n");
+  pthread_mutex_lock(&record_mutex_);
+  if (record_file_)
+    fclose(record_file_);
+  record_file_ = fp;
+  pthread_mutex_unlock(&record_mutex_);
+  return 0;
 }
 
-InputEventHandler::~InputEventHandler() {
-  // TODO
+int InputEventHandler::stopRecord() {
+  pthread_mutex_lock(&record_mutex_);
+  if (record_file_) {
+    fclose(record_file_);
+    record_file_ = NULL;
+  }
+  pthread_mutex_unlock(&record_mutex_);
+  return 0;
 }
 
-int InputEventHandler::start() {
-  return uv_queue_work(uv_default_loop(), &req, InputEventHandler::DoStart,
-                       InputEventHandler::AfterStart);
+/**
+ * The record is a line for each event, which starts with the kind and the
+ * monotonic time in us:
+ *   K <time> <value> <action> <key_code>
+ *   G <time> <action> <key_code> <slide_value> <click_count> <long_press_time>
+ */
+void InputEventHandler::recordEvent(const iotjs_input_event_t& event) {
+  pthread_mutex_lock(&record_mutex_);
+  if (record_file_ == NULL) {
+    pthread_mutex_unlock(&record_mutex_);
+    return;
+  }
+  unsigned long long time = event.injected_at / 1000;
+  if (event.kind == INPUT_EVENT_KEY) {
+    fprintf(record_file_, "K %llu %d %d %d\n", time, event.key.value,
+            event.key.action, event.key.key_code);
+  } else {
+    fprintf(record_file_, "G %llu %d %d %d %d %d\n", time,
+            event.gesture.action, event.gesture.key_code,
+            event.gesture.slide_value, event.gesture.click_count,
+            event.gesture.long_press_time);
+  }
+  fflush(record_file_);
+  pthread_mutex_unlock(&record_mutex_);
 }
 
-int InputEventHandler::stop() {
-  int r = uv_cancel((uv_req_t*)&req);
-  this->need_destroy_ = true;
-  return r;
+void* InputEventHandler::RunReplay(void* data) {
+  InputEventHandler* handler = (InputEventHandler*)data;
+  handler->replayFile();
+  fprintf(stdout, "input replay stopped\n");
+  return NULL;
 }
 
-void InputEventHandler::DoStart(uv_work_t* req) {
-  InputEventHandler* handler = (InputEventHandler*)req->data;
-  while (true) {
-    if (handler->need_destroy_ == true) {
-      break;
+/**
+ * The stand-in source of `daemon_start_listener`, posts the recorded events
+ * at the recorded pace divided by the speed.
+ */
+void InputEventHandler::replayFile() {
+  char line[256];
+  unsigned long long first = 0;
+  uint64_t base = uv_hrtime();
+  bool has_first = false;
+  iotjs_input_event_t event;
+
+  while (!need_destroy_ && fgets(line, sizeof(line), replay_file_)) {
+    unsigned long long time;
+    memset(&event, 0, sizeof(event));
+    if (line[0] == 'K' &&
+        sscanf(line + 1, "%llu %d %d %d", &time, &event.key.value,
+               &event.key.action, &event.key.key_code) == 4) {
+      event.kind = INPUT_EVENT_KEY;
+      event.key.new_action = true;
+      gettimeofday(&event.key.key_timeval, NULL);
+    } else if (line[0] == 'G' &&
+               sscanf(line + 1, "%llu %d %d %d %d %d", &time,
+                      &event.gesture.action, &event.gesture.key_code,
+                      &event.gesture.slide_value, &event.gesture.click_count,
+                      &event.gesture.long_press_time) == 6) {
+      event.kind = INPUT_EVENT_GESTURE;
+      event.gesture.new_action = true;
+    } else {
+      continue;
     }
-    daemon_start_listener(&handler->keyevent_, &handler->gesture_);
-    // Send InputKeyEvent
-    if (handler->keyevent_.new_action) {
-      uv_async_t* async = new uv_async_t;
-      InputKeyEvent* event = new InputKeyEvent();
-      event->event_handler = handler;
-      event->data.new_action = handler->keyevent_.new_action;
-      event->data.value = handler->keyevent_.value;
-      event->data.action = handler->keyevent_.action;
-      event->data.key_code = handler->keyevent_.key_code;
-      event->data.key_timeval = handler->keyevent_.key_timeval;
-      async->data = (void*)event;
-      uv_async_init(uv_default_loop(), async, InputEventHandler::OnKeyEvent);
-      uv_async_send(async);
+    if (!has_first) {
+      first = time;
+      has_first = true;
     }
-    // Send InputGestureEvent
-    if (handler->gesture_.new_action) {
-      uv_async_t* async = new uv_async_t;
-      InputGestureEvent* event = new InputGestureEvent();
-      event->event_handler = handler;
-      event->data.new_action = handler->gesture_.new_action;
-      event->data.action = handler->gesture_.action;
-      event->data.key_code = handler->gesture_.key_code;
-      event->data.slide_value = handler->gesture_.slide_value;
-      event->data.click_count = handler->gesture_.click_count;
-      event->data.long_press_time = handler->gesture_.long_press_time;
-      async->data = (void*)event;
-      uv_async_init(uv_default_loop(), async,
-                    InputEventHandler::OnGestureEvent);
-      uv_async_send(async);
+    if (replay_speed_ > 0 && time > first) {
+      uint64_t due = base + (uint64_t)((time - first) * 1000 / replay_speed_);
+      uint64_t now = uv_hrtime();
+      if (due > now && waitWakeup((int)((due - now + 999999) / 1000000)))
+        break;
     }
+    dispatch(event);
+  }
+  if (!need_destroy_) {
+    memset(&event, 0, sizeof(event));
+    event.kind = INPUT_EVENT_REPLAY_END;
+    post(event);
   }
 }
 
-void InputEventHandler::AfterStart(uv_work_t* req, int status) {
-  fprintf(stdout, "input event handler stopped\n");
+void InputEventHandler::addLatency(uint64_t injected_at) {
+  double ms = (uv_hrtime() - injected_at) / 1e6;
+  latency_samples_[latency_count_ % INPUT_LATENCY_SAMPLES] = ms;
+  latency_count_ += 1;
 }
 
-void InputEventHandler::OnKeyEvent(uv_async_t* async) {
-  InputKeyEvent* event = (InputKeyEvent*)async->data;
-  iotjs_input_t* input = event->event_handler->inputwrap;
-  IOTJS_VALIDATED_STRUCT_METHOD(iotjs_input_t, input);
+static int compare_double(const void* a, const void* b) {
+  double x = *(const double*)a;
+  double y = *(const double*)b;
+  return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+jerry_value_t InputEventHandler::getLatency() {
+  uint32_t n = latency_count_ < INPUT_LATENCY_SAMPLES ? latency_count_
+                                                      : INPUT_LATENCY_SAMPLES;
+  jerry_value_t jstats = jerry_create_object();
+  iotjs_jval_set_property_number(jstats, "count", latency_count_);
+  if (n == 0)
+    return jstats;
+
+  double* sorted = new double[n];
+  double sum = 0;
+  memcpy(sorted, latency_samples_, n * sizeof(double));
+  qsort(sorted, n, sizeof(double), compare_double);
+  for (uint32_t i = 0; i < n; i++) {
+    sum += sorted[i];
+  }
+  iotjs_jval_set_property_number(jstats, "min", sorted[0]);
+  iotjs_jval_set_property_number(jstats, "max", sorted[n - 1]);
+  iotjs_jval_set_property_number(jstats, "mean", sum / n);
+  iotjs_jval_set_property_number(jstats, "p50", sorted[(n - 1) * 50 / 100]);
+  iotjs_jval_set_property_number(jstats, "p95", sorted[(n - 1) * 95 / 100]);
+  iotjs_jval_set_property_number(jstats, "p99", sorted[(n - 1) * 99 / 100]);
+  delete[] sorted;
+  return jstats;
+}
 
+void InputEventHandler::OnEvents(uv_async_t* async) {
+  InputEventHandler* handler = (InputEventHandler*)async->data;
+  uint32_t head = handler->ring_head_.load(std::memory_order_relaxed);
+  uint32_t tail = handler->ring_tail_.load(std::memory_order_acquire);
+  for (; head != tail; head++) {
+    const iotjs_input_event_t& event =
+        handler->ring_[head & (INPUT_EVENT_RING_SIZE - 1)];
+    if (event.kind == INPUT_EVENT_REPLAY_END) {
+      if (jerry_value_is_function(handler->replay_callback_)) {
+        iotjs_jargs_t jargs = iotjs_jargs_create(0);
+        iotjs_make_callback(handler->replay_callback_,
+                            jerry_create_undefined(), &jargs);
+        iotjs_jargs_destroy(&jargs);
+      }
+    } else {
+      handler->addLatency(event.injected_at);
+      if (event.kind == INPUT_EVENT_RECOGNIZED) {
+        handler->deliverRecognized(event.recognized);
+      } else if (event.kind == INPUT_EVENT_GESTURE) {
+        handler->deliverGestureEvent(event.gesture);
+      } else {
+        handler->deliverKeyEvent(event.key);
+      }
+    }
+    handler->ring_head_.store(head + 1, std::memory_order_release);
+  }
+}
+
+void InputEventHandler::AfterClose(uv_handle_t* handle) {
+  delete (uv_async_t*)handle;
+}
+
+// the callbacks are looked up once, instead of on every event
+void InputEventHandler::lookupCallbacks() {
+  iotjs_input_t* input = inputwrap;
+  IOTJS_VALIDATED_STRUCT_METHOD(iotjs_input_t, input);
   jerry_value_t jthis = iotjs_jobjectwrap_jobject(&_this->jobjectwrap);
-  jerry_value_t onevent = iotjs_jval_get_property(jthis, "onevent");
-  if (!jerry_value_is_function(onevent)) {
+  jerry_release_value(onevent_);
+  jerry_release_value(ongesture_);
+  jerry_release_value(onrecognized_);
+  onevent_ = iotjs_jval_get_property(jthis, "onevent");
+  ongesture_ = iotjs_jval_get_property(jthis, "ongesture");
+  onrecognized_ = iotjs_jval_get_property(jthis, "onrecognized");
+}
+
+void InputEventHandler::releaseCallbacks() {
+  jerry_release_value(onevent_);
+  jerry_release_value(ongesture_);
+  jerry_release_value(onrecognized_);
+  jerry_release_value(replay_callback_);
+  onevent_ = jerry_create_undefined();
+  ongesture_ = jerry_create_undefined();
+  onrecognized_ = jerry_create_undefined();
+  replay_callback_ = jerry_create_undefined();
+}
+
+int InputEventHandler::setGestures(const vector<GestureRule>& rules,
+                                   bool raw) {
+  deliver_raw_ = raw;
+  recognizer_.configure(rules);
+  if (rules.empty()) {
+    recognizer_.stop();
+    return 0;
+  }
+  if (started_) {
+    lookupCallbacks();
+  }
+  return recognizer_.start(InputEventHandler::OnRecognized, this) ? 0 : -1;
+}
+
+void InputEventHandler::deliverRecognized(const RecognizedGesture& data) {
+  if (!jerry_value_is_function(onrecognized_)) {
+    fprintf(stderr, "no onrecognized function is registered\n");
+    return;
+  }
+  iotjs_jargs_t jargs = iotjs_jargs_create(4);
+  iotjs_jargs_append_number(&jargs, (double)data.rule);
+  iotjs_jargs_append_number(&jargs, (double)data.key_code);
+  iotjs_jargs_append_number(&jargs, (double)data.value);
+  iotjs_jargs_append_number(&jargs, (double)data.duration);
+  iotjs_make_callback(onrecognized_, jerry_create_undefined(), &jargs);
+  iotjs_jargs_destroy(&jargs);
+}
+
+void InputEventHandler::deliverKeyEvent(const struct keyevent& data) {
+  if (!jerry_value_is_function(onevent_)) {
     fprintf(stderr, "no onevent function is registered\n");
     return;
   }
   iotjs_jargs_t jargs = iotjs_jargs_create(4);
-  iotjs_jargs_append_number(&jargs, (double)event->data.value);
-  iotjs_jargs_append_number(&jargs, (double)event->data.action);
-  iotjs_jargs_append_number(&jargs, (double)event->data.key_code);
+  iotjs_jargs_append_number(&jargs, (double)data.value);
+  iotjs_jargs_append_number(&jargs, (double)data.action);
+  iotjs_jargs_append_number(&jargs, (double)data.key_code);
 
-  struct timeval key_time = event->data.key_timeval;
+  struct timeval key_time = data.key_timeval;
   double jkey_time =
       static_cast<double>(key_time.tv_sec * 1000.0 + key_time.tv_usec / 1000);
   iotjs_jargs_append_number(&jargs, jkey_time);
-  iotjs_make_callback(onevent, jerry_create_undefined(), &jargs);
+  iotjs_make_callback(onevent_, jerry_create_undefined(), &jargs);
   iotjs_jargs_destroy(&jargs);
-  jerry_release_value(onevent);
-  uv_close((uv_handle_t*)async, InputEventHandler::AfterCallback);
 }
 
-void InputEventHandler::OnGestureEvent(uv_async_t* async) {
-  InputGestureEvent* event = (InputGestureEvent*)async->data;
-  iotjs_input_t* input = event->event_handler->inputwrap;
-  IOTJS_VALIDATED_STRUCT_METHOD(iotjs_input_t, input);
-
-  jerry_value_t jthis = iotjs_jobjectwrap_jobject(&_this->jobjectwrap);
-  jerry_value_t onevent = iotjs_jval_get_property(jthis, "ongesture");
-  if (!jerry_value_is_function(onevent)) {
-    fprintf(stderr, "no onevent function is registered\n");
+void InputEventHandler::deliverGestureEvent(const struct gesture& data) {
+  if (!jerry_value_is_function(ongesture_)) {
+    fprintf(stderr, "no ongesture function is registered\n");
     return;
   }
   iotjs_jargs_t jargs = iotjs_jargs_create(5);
-  iotjs_jargs_append_number(&jargs, (double)event->data.action);
-  iotjs_jargs_append_number(&jargs, (double)event->data.key_code);
-  iotjs_jargs_append_number(&jargs, (double)event->data.slide_value);
-  iotjs_jargs_append_number(&jargs, (double)event->data.click_count);
-  iotjs_jargs_append_number(&jargs, (double)event->data.long_press_time);
-  iotjs_make_callback(onevent, jerry_create_undefined(), &jargs);
+  iotjs_jargs_append_number(&jargs, (double)data.action);
+  iotjs_jargs_append_number(&jargs, (double)data.key_code);
+  iotjs_jargs_append_number(&jargs, (double)data.slide_value);
+  iotjs_jargs_append_number(&jargs, (double)data.click_count);
+  iotjs_jargs_append_number(&jargs, (double)data.long_press_time);
+  iotjs_make_callback(ongesture_, jerry_create_undefined(), &jargs);
   iotjs_jargs_destroy(&jargs);
-  jerry_release_value(onevent);
-  uv_close((uv_handle_t*)async, InputEventHandler::AfterCallback);
-}
-
-void InputEventHandler::AfterCallback(uv_handle_t* handle) {
-  uv_async_t* async = (uv_async_t*)handle;
-  delete async->data;
-  delete handle;
 }
 
 iotjs_input_t* iotjs_input_create(const jerry_value_t jinput) {
@@ -220,13 +533,13 @@ iotjs_input_t* iotjs_input_create(const jerry_value_t jinput) {
 
   iotjs_jobjectwrap_initialize(&_this->jobjectwrap, jinput,
                                &this_module_native_info);
-  _this->initializer = new InputInitializer(inputwrap);
   _this->event_handler = new InputEventHandler(inputwrap);
   return inputwrap;
 }
 
 void iotjs_input_destroy(iotjs_input_t* input) {
   IOTJS_VALIDATED_STRUCT_DESTRUCTOR(iotjs_input_t, input);
+  delete _this->event_handler;
   iotjs_jobjectwrap_destroy(&_this->jobjectwrap);
   IOTJS_RELEASE(input);
 }
@@ -246,8 +559,8 @@ JS_FUNCTION(Start) {
   int timeout_select = JS_GET_ARG(0, number);
   int timeout_dbclick = JS_GET_ARG(1, number);
   int timeout_slide = JS_GET_ARG(2, number);
-  int r =
-      _this->initializer->start(timeout_select, timeout_dbclick, timeout_slide);
+  int r = _this->event_handler->start(timeout_select, timeout_dbclick,
+                                      timeout_slide);
   return jerry_create_number(r);
 }
 
@@ -255,13 +568,98 @@ JS_FUNCTION(Disconnect) {
   JS_DECLARE_THIS_PTR(input, input);
   IOTJS_VALIDATED_STRUCT_METHOD(iotjs_input_t, input);
 
-  if (!_this->initializer->initialized)
-    _this->initializer->stop();
   if (_this->event_handler != NULL)
     _this->event_handler->stop();
   return jerry_create_boolean(true);
 }
 
+JS_FUNCTION(Record) {
+  JS_DECLARE_THIS_PTR(input, input);
+  IOTJS_VALIDATED_STRUCT_METHOD(iotjs_input_t, input);
+  if (jargc < 1 || !jerry_value_is_string(jargv[0])) {
+    return JS_CREATE_ERROR(COMMON, "path must be a string");
+  }
+  jerry_size_t size = jerry_get_string_size(jargv[0]);
+  jerry_char_t path[size + 1];
+  jerry_string_to_char_buffer(jargv[0], path, size);
+  path[size] = '\0';
+
+  int r = _this->event_handler->record((char*)path);
+  return jerry_create_number(r);
+}
+
+JS_FUNCTION(StopRecord) {
+  JS_DECLARE_THIS_PTR(input, input);
+  IOTJS_VALIDATED_STRUCT_METHOD(iotjs_input_t, input);
+
+  int r = _this->event_handler->stopRecord();
+  return jerry_create_number(r);
+}
+
+JS_FUNCTION(Replay) {
+  JS_DECLARE_THIS_PTR(input, input);
+  IOTJS_VALIDATED_STRUCT_METHOD(iotjs_input_t, input);
+  if (jargc < 3 || !jerry_value_is_string(jargv[0]) ||
+      !jerry_value_is_function(jargv[2])) {
+    return JS_CREATE_ERROR(COMMON, "path, speed and callback are required");
+  }
+  jerry_size_t size = jerry_get_string_size(jargv[0]);
+  jerry_char_t path[size + 1];
+  jerry_string_to_char_buffer(jargv[0], path, size);
+  path[size] = '\0';
+
+  double speed = JS_GET_ARG(1, number);
+  int r = _this->event_handler->replay((char*)path, speed, jargv[2]);
+  return jerry_create_number(r);
+}
+
+JS_FUNCTION(GetLatency) {
+  JS_DECLARE_THIS_PTR(input, input);
+  IOTJS_VALIDATED_STRUCT_METHOD(iotjs_input_t, input);
+  return _this->event_handler->getLatency();
+}
+
+JS_FUNCTION(SetGestures) {
+  JS_DECLARE_THIS_PTR(input, input);
+  IOTJS_VALIDATED_STRUCT_METHOD(iotjs_input_t, input);
+  if (jargc < 2 || !jerry_value_is_array(jargv[0])) {
+    return JS_CREATE_ERROR(COMMON, "rules must be an array");
+  }
+
+  // each rule is [type, threshold, interval, ...keys]
+  vector<GestureRule> rules;
+  uint32_t count = jerry_get_array_length(jargv[0]);
+  for (uint32_t i = 0; i < count; i++) {
+    jerry_value_t jrule = jerry_get_property_by_index(jargv[0], i);
+    uint32_t len =
+        jerry_value_is_array(jrule) ? jerry_get_array_length(jrule) : 0;
+    if (len < 3) {
+      jerry_release_value(jrule);
+      return JS_CREATE_ERROR(COMMON, "invalid gesture rule");
+    }
+    GestureRule rule;
+    memset(&rule, 0, sizeof(rule));
+    int values[3 + GESTURE_RULE_MAX_KEYS];
+    for (uint32_t k = 0; k < len && k < 3 + GESTURE_RULE_MAX_KEYS; k++) {
+      jerry_value_t jval = jerry_get_property_by_index(jrule, k);
+      values[k] = (int)jerry_get_number_value(jval);
+      jerry_release_value(jval);
+    }
+    rule.type = values[0];
+    rule.threshold = values[1];
+    rule.interval = values[2];
+    rule.key_count = 0;
+    for (uint32_t k = 3; k < len && k < 3 + GESTURE_RULE_MAX_KEYS; k++) {
+      rule.keys[rule.key_count++] = values[k];
+    }
+    rules.push_back(rule);
+    jerry_release_value(jrule);
+  }
+  bool raw = JS_GET_ARG(1, boolean);
+  int r = _this->event_handler->setGestures(rules, raw);
+  return jerry_create_number(r);
+}
+
 void init(jerry_value_t exports) {
   jerry_value_t jconstructor = jerry_create_external_function(Input);
   iotjs_jval_set_property_jval(exports, "InputWrap", jconstructor);
@@ -269,6 +667,11 @@ void init(jerry_value_t exports) {
   jerry_value_t proto = jerry_create_object();
   iotjs_jval_set_method(proto, "start", Start);
   iotjs_jval_set_method(proto, "disconnect", Disconnect);
+  iotjs_jval_set_method(proto, "record", Record);
+  iotjs_jval_set_method(proto, "stopRecord", StopRecord);
+  iotjs_jval_set_method(proto, "replay", Replay);
+  iotjs_jval_set_method(proto, "getLatency", GetLatency);
+  iotjs_jval_set_method(proto, "setGestures", SetGestures);
   iotjs_jval_set_property_jval(jconstructor, "prototype", proto);
 
   jerry_release_value(proto);
@@ -2,6 +2,10 @@
 #define INPUT_NATIVE_H
 
 #include <stdio.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <atomic>
+#include "GestureRecognizer.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -14,18 +18,53 @@ extern "C" {
 #include <uv.h>
 #include <input-event/input-event.h>
 
-class InputInitializer;
 class InputEventHandler;
 
+// the capacity of the event ring, must be a power of 2
+#define INPUT_EVENT_RING_SIZE 128
+
+// the samples kept to compute the delivery latency percentiles
+#define INPUT_LATENCY_SAMPLES 4096
+
+enum InputEventKind {
+  INPUT_EVENT_KEY = 0,
+  INPUT_EVENT_GESTURE,
+  // the replay has reached the end of the file
+  INPUT_EVENT_REPLAY_END,
+  // a gesture from the recognizer
+  INPUT_EVENT_RECOGNIZED,
+};
+
+typedef struct {
+  // cppcheck-suppress unusedStructMember
+  int kind;
+  struct keyevent key;
+  struct gesture gesture;
+  RecognizedGesture recognized;
+  // the monotonic time in ns the event is posted at
+  uint64_t injected_at;
+} iotjs_input_event_t;
+
 typedef struct {
   iotjs_jobjectwrap_t jobjectwrap;
-  InputInitializer* initializer;
   InputEventHandler* event_handler;
 } IOTJS_VALIDATED_STRUCT(iotjs_input_t);
 
 static iotjs_input_t* iotjs_input_create(const jerry_value_t jinput);
 static void iotjs_input_destroy(iotjs_input_t* input);
 
+/**
+ * @class InputEventHandler
+ * Initializes the input devices and listens to them on a dedicated thread, so
+ * that no libuv threadpool worker is occupied. The thread waits on an epoll
+ * instance with a wakeup eventfd, so the retries and the listening stop as
+ * soon as the handler is stopped.
+ *
+ * The events are written into a preallocated ring, and delivered in batch on
+ * the loop through one persistent async handle. If gestures are configured,
+ * the key events are fed to the recognizer, and only the recognized gestures
+ * are delivered unless the raw events are asked.
+ */
 class InputEventHandler {
  public:
   InputEventHandler();
@@ -33,22 +72,92 @@ class InputEventHandler {
   ~InputEventHandler();
 
  public:
-  int start();
+  int start(int timeout_select, int timeout_dbclick, int timeout_slide);
   int stop();
+  /**
+   * @method record
+   * records the received events with their timestamps into the file.
+   */
+  int record(const char* path);
+  int stopRecord();
+  /**
+   * @method replay
+   * replays the recorded file instead of listening to the devices.
+   * @param {double} speed - 1 for the real speed, 0 for no delay.
+   * @param {jerry_value_t} callback - called when the file is replayed.
+   */
+  int replay(const char* path, double speed, jerry_value_t callback);
+  /**
+   * @method getLatency
+   * @return {jerry_value_t} the stats of the ms from the event is posted to
+   *         it's delivered to JS.
+   */
+  jerry_value_t getLatency();
+  /**
+   * @method setGestures
+   * configures the gesture recognizer, it's stopped if no rules are given.
+   * @param {bool} raw - if the raw events are still delivered.
+   */
+  int setGestures(const vector<GestureRule>& rules, bool raw);
 
  public:
-  static void DoStart(uv_work_t* req);
-  static void AfterStart(uv_work_t* req, int status);
-  static void OnKeyEvent(uv_async_t* async);
-  static void OnGestureEvent(uv_async_t* async);
-  static void AfterCallback(uv_handle_t* handle);
+  static void* Run(void* data);
+  static void* RunReplay(void* data);
+  static void OnRecognized(void* data, const RecognizedGesture& gesture);
+  static void OnEvents(uv_async_t* async);
+  static void AfterClose(uv_handle_t* handle);
+
+ private:
+  bool initialize();
+  bool waitWakeup(int timeout);
+  void listen();
+  void replayFile();
+  int startThread(void* (*run)(void*));
+  void recordEvent(const iotjs_input_event_t& event);
+  void dispatch(iotjs_input_event_t& event);
+  void post(iotjs_input_event_t& event);
+  void deliverRecognized(const RecognizedGesture& data);
+  void lookupCallbacks();
+  void addLatency(uint64_t injected_at);
+  void deliverKeyEvent(const struct keyevent& data);
+  void deliverGestureEvent(const struct gesture& data);
+  void releaseCallbacks();
 
  private:
   iotjs_input_t* inputwrap;
   struct keyevent keyevent_;
   struct gesture gesture_;
-  bool need_destroy_;
-  uv_work_t req;
+  volatile bool need_destroy_;
+  bool started_;
+  pthread_t thread_;
+  int epoll_fd_;
+  int wakeup_fd_;
+  int timeout_select_;
+  int timeout_dbclick_;
+  int timeout_slide_;
+
+  // single consumer (the loop), the producers are serialized by post_mutex_
+  iotjs_input_event_t ring_[INPUT_EVENT_RING_SIZE];
+  std::atomic<uint32_t> ring_head_;
+  std::atomic<uint32_t> ring_tail_;
+  uint32_t dropped_;
+  uv_async_t* notify_;
+  // the listener and the recognizer are both producers of the ring
+  pthread_mutex_t post_mutex_;
+  jerry_value_t onevent_;
+  jerry_value_t ongesture_;
+  jerry_value_t onrecognized_;
+
+  GestureRecognizer recognizer_;
+  bool deliver_raw_;
+
+  pthread_mutex_t record_mutex_;
+  FILE* record_file_;
+  FILE* replay_file_;
+  double replay_speed_;
+  jerry_value_t replay_callback_;
+  double latency_samples_[INPUT_LATENCY_SAMPLES];
+  uint32_t latency_count_;
 };
 
 #ifdef __cplusplus
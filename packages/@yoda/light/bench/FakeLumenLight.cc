@@ -0,0 +1,98 @@
+#include "FakeLumenLight.h"
+#include <lumenflinger/LumenLight.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static pthread_mutex_t fake_mutex = PTHREAD_MUTEX_INITIALIZER;
+static vector<FakeLumenRecord> fake_records;
+// the index of the next record once the ring is full
+static size_t fake_next = 0;
+static vector<uint8_t> fake_frame;
+
+static int fake_env(const char* name, int fallback) {
+  const char* value = getenv(name);
+  int ret = value != NULL ? atoi(value) : 0;
+  return ret > 0 ? ret : fallback;
+}
+
+static uint64_t monotonic_now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// appends the record, the fake_mutex must be held.
+static void fake_push(const FakeLumenRecord& record) {
+  if (fake_records.size() < FAKE_LUMEN_MAX_RECORDS) {
+    fake_records.push_back(record);
+  } else {
+    fake_records[fake_next] = record;
+    fake_next = (fake_next + 1) % FAKE_LUMEN_MAX_RECORDS;
+  }
+}
+
+LumenLight::LumenLight() {
+}
+
+LumenLight::~LumenLight() {
+}
+
+bool LumenLight::lumen_set_enable(bool enable) {
+  return true;
+}
+
+int LumenLight::lumen_draw(unsigned char* buf, int len) {
+  int cost = fake_env("LIGHT_FAKE_DRAW_US", 0);
+  if (cost > 0) {
+    usleep(cost);
+  }
+  FakeLumenRecord record;
+  record.at = monotonic_now();
+  pthread_mutex_lock(&fake_mutex);
+  record.changed = fake_frame.size() != (size_t)len ||
+                   memcmp(fake_frame.data(), buf, len) != 0;
+  record.skipped = false;
+  fake_frame.assign(buf, buf + len);
+  fake_push(record);
+  pthread_mutex_unlock(&fake_mutex);
+  return 0;
+}
+
+void fake_lumen_skip() {
+  FakeLumenRecord record;
+  record.at = monotonic_now();
+  record.changed = false;
+  record.skipped = true;
+  pthread_mutex_lock(&fake_mutex);
+  fake_push(record);
+  pthread_mutex_unlock(&fake_mutex);
+}
+
+int LumenLight::getLedCount() {
+  return fake_env("LIGHT_FAKE_LEDS", 12);
+}
+
+int LumenLight::getPixelFormat() {
+  return fake_env("LIGHT_FAKE_FORMAT", 3);
+}
+
+int LumenLight::getFps() {
+  return fake_env("LIGHT_FAKE_FPS", 30);
+}
+
+void fake_lumen_records(vector<FakeLumenRecord>& records,
+                        vector<uint8_t>& last_frame, bool reset) {
+  pthread_mutex_lock(&fake_mutex);
+  records.assign(fake_records.begin() + fake_next, fake_records.end());
+  records.insert(records.end(), fake_records.begin(),
+                 fake_records.begin() + fake_next);
+  last_frame = fake_frame;
+  if (reset) {
+    fake_records.clear();
+    fake_next = 0;
+  }
+  pthread_mutex_unlock(&fake_mutex);
+}
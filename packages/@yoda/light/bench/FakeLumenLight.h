@@ -0,0 +1,42 @@
+#ifndef FAKE_LUMEN_LIGHT_H
+#define FAKE_LUMEN_LIGHT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+using namespace std;
+
+// the draws kept in memory, the oldest ones are overwritten
+#define FAKE_LUMEN_MAX_RECORDS 16384
+
+/**
+ * The stand-in of the LumenLight driver for the benchmarks, every draw is
+ * recorded with its monotonic time in ns instead of being written to the
+ * LEDs. The profile is read from the environment:
+ *
+ * - LIGHT_FAKE_LEDS, defaults to 12.
+ * - LIGHT_FAKE_FORMAT, defaults to 3.
+ * - LIGHT_FAKE_FPS, defaults to 30.
+ * - LIGHT_FAKE_DRAW_US, the simulated cost of a draw, defaults to 0.
+ */
+struct FakeLumenRecord {
+  uint64_t at;
+  // if the frame differs from the previous draw
+  bool changed;
+  // skipped by the dirty check before reaching the driver
+  bool skipped;
+};
+
+/**
+ * records a frame skipped as identical to the showing one, so that the ticks
+ * are timed whether or not they reach the driver.
+ */
+void fake_lumen_skip();
+
+/**
+ * copies the recorded draws in time order and the last frame.
+ */
+void fake_lumen_records(vector<FakeLumenRecord>& records,
+                        vector<uint8_t>& last_frame, bool reset);
+
+#endif // FAKE_LUMEN_LIGHT_H
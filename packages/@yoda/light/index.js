@@ -17,6 +17,19 @@
  * - `fill()`: fill the color on all the lights, and write immediately.
  * - `pixel()`: fill the color on the given light by index.
  * - `write()`: write the current buffer.
+ *
+ * And the following methods operate on the whole buffer in one call:
+ * - `colors()`: copy the per-LED colors from a buffer.
+ * - `gradient()`: fill a range with the linear gradient of 2 colors.
+ * - `scale()`, `blend()`: fade the buffer or blend another frame over it.
+ * - `rotate()`, `shift()`: move the LEDs on the ring.
+ *
+ * The `animate()` plays the keyframes natively on its own thread at the
+ * maximum fps of the device, it doesn't take the JS thread during the play.
+ *
+ * The named layers are stacked over the buffer by their z-order when it's
+ * written, each of them could be updated by `drawLayer()` or an animation
+ * without re-rendering the others.
  */
 
 var native = require('./light.node')
@@ -33,6 +46,18 @@ var logger = require('logger')('light')
 
 var config = native.getProfile()
 
+/**
+ * The easing of a keyframe, applied to the transition towards the next one.
+ * @enum {Number}
+ */
+var Easing = {
+  linear: 0,
+  easeIn: 1,
+  easeOut: 2,
+  easeInOut: 3,
+  step: 4
+}
+
 var enabled = false;
 
 (function bootstrap () {
@@ -89,6 +114,39 @@ module.exports = {
     return this
   },
 
+  /**
+   * @typedef RenderStats
+   * @property {Number} drawn - the frames written to the driver.
+   * @property {Number} skipped - the frames skipped since they are identical
+   *           to the showing one.
+   * @property {Number} failed - the frames which the driver failed to write.
+   */
+
+  /**
+   * Get the counters of the rendered frames, including the animation ones.
+   * @function getStats
+   * @param {Boolean} [reset=false] - reset the counters after reading.
+   * @returns {module:@yoda/light~RenderStats}
+   */
+  getStats: function getStats (reset) {
+    return native.getStats(!!reset)
+  },
+
+  /**
+   * Get the draws recorded by the fake driver, which is only available when
+   * the module is built with `-DLIGHT_FAKE_DRIVER=ON` for benchmarks.
+   * @function getDriverRecords
+   * @param {Boolean} [reset=false] - clear the records after reading.
+   * @returns {Object|null} the monotonic `times` in ms, the `changed` and
+   *          `skipped` flags and the `lastFrame`, or null on the real driver.
+   */
+  getDriverRecords: function getDriverRecords (reset) {
+    if (typeof native.getDriverRecords !== 'function') {
+      return null
+    }
+    return native.getDriverRecords(!!reset)
+  },
+
   /**
    * Get the hardware profile data
    * @function getProfile
@@ -160,6 +218,243 @@ module.exports = {
   clear: function clearColor () {
     native.fill(0, 0, 0)
     return this
+  },
+
+  /**
+   * Copy the per-LED colors into the buffer.
+   * @function colors
+   * @param {Buffer} colors - the colors in the profile format, commonly rgb.
+   * @param {Number} [start=0] - the index of the first LED to write.
+   * @example
+   * light.colors(Buffer.from([255, 0, 0, 0, 255, 0])) // red and green
+   */
+  colors: function colors (buffer, start) {
+    native.colors(buffer, start || 0)
+    return this
+  },
+
+  /**
+   * Fill the LEDs in a range with the linear gradient of 2 colors.
+   * @function gradient
+   * @param {Number} from - the index of the first LED.
+   * @param {Number} to - the index of the last LED.
+   * @param {Object} start - the color `{ r, g, b, a }` at the first LED.
+   * @param {Object} end - the color `{ r, g, b, a }` at the last LED.
+   */
+  gradient: function gradient (from, to, start, end) {
+    start = applyAlpha(start)
+    end = applyAlpha(end)
+    native.gradient(from, to, start.r, start.g, start.b, end.r, end.g, end.b)
+    return this
+  },
+
+  /**
+   * Scale all the colors of the buffer.
+   * @function scale
+   * @param {Number} alpha - the factor from 0 to 1.
+   */
+  scale: function scale (alpha) {
+    native.scale(alpha)
+    return this
+  },
+
+  /**
+   * Blend a frame over the buffer.
+   * @function blend
+   * @param {Buffer} frame - the frame which covers all the LEDs.
+   * @param {Number} alpha - the opacity of the frame from 0 to 1.
+   */
+  blend: function blend (frame, alpha) {
+    native.blend(frame, alpha)
+    return this
+  },
+
+  /**
+   * Rotate the LEDs on the ring.
+   * @function rotate
+   * @param {Number} steps - the LEDs to move, positive is clockwise.
+   */
+  rotate: function rotate (steps) {
+    native.rotate(steps)
+    return this
+  },
+
+  /**
+   * Shift the LEDs like `rotate()`, the vacated LEDs are cleared.
+   * @function shift
+   * @param {Number} steps - the LEDs to move, positive is clockwise.
+   */
+  shift: function shift (steps) {
+    native.shift(steps)
+    return this
+  },
+
+  /**
+   * Set the global brightness, which is applied when the buffer is rendered,
+   * the buffer itself is kept unscaled.
+   * @function setBrightness
+   * @param {Number} alpha - the brightness from 0 to 1.
+   */
+  setBrightness: function setBrightness (alpha) {
+    native.setBrightness(alpha)
+    return this
+  },
+
+  /**
+   * @typedef Keyframe
+   * @property {Number} time - the offset in ms from the start.
+   * @property {Buffer|Object} frame - the frame which covers all the LEDs or
+   *           the color `{ r, g, b, a }` to fill.
+   * @property {String} [easing='linear'] - the easing towards the next
+   *           keyframe, see `Easing`.
+   */
+
+  /**
+   * Play the keyframes natively, the current animation is cancelled.
+   * @function animate
+   * @param {module:@yoda/light~Keyframe[]} keyframes - the keyframes in time order.
+   * @param {Object} [options]
+   * @param {Number} [options.repeat=0] - the extra loops, -1 for forever.
+   * @param {Number} [options.fps] - defaults to the maximum fps.
+   * @param {String} [options.layer] - the layer to animate, defaults to the
+   *        buffer.
+   * @param {Function} [callback] - called with `cancelled` when it's done.
+   * @example
+   * light.animate([
+   *   { time: 0, frame: { r: 0, g: 0, b: 0 }, easing: 'easeIn' },
+   *   { time: 500, frame: { r: 0, g: 0, b: 150 } }
+   * ], { repeat: 2 }, (cancelled) => {})
+   */
+  animate: function animate (keyframes, options, callback) {
+    if (typeof options === 'function') {
+      callback = options
+      options = null
+    }
+    options = Object.assign({ repeat: 0, fps: 0 }, options)
+    var size = config.leds * config.format
+    var frames = Buffer.alloc(size * keyframes.length)
+    var times = []
+    var easings = []
+    keyframes.forEach((keyframe, index) => {
+      var frame = keyframe.frame
+      if (!Buffer.isBuffer(frame)) {
+        frame = colorFrame(frame)
+      }
+      frame.copy(frames, index * size, 0, Math.min(frame.length, size))
+      times.push(keyframe.time)
+      var easing = Easing[keyframe.easing || 'linear']
+      if (easing === undefined) {
+        throw new TypeError(`unknown easing ${keyframe.easing}`)
+      }
+      easings.push(easing)
+    })
+    native.animate(frames, times, easings, options.repeat, options.fps,
+      callback || function noop () {}, options.layer)
+    return this
+  },
+
+  /**
+   * @typedef SequenceInfo
+   * @property {Number} frames - the number of the recorded frames.
+   * @property {Number} duration - the duration in ms.
+   * @property {Boolean} loop - if the sequence loops until it's stopped.
+   * @property {Boolean} finishes - if the script calls back when it ends.
+   */
+
+  /**
+   * Play a sequence precompiled by `tools/light-compile` with its recorded
+   * timings, it replaces the current animation like `animate()`.
+   * @function playSequence
+   * @param {String} path - the path of the `.lseq` file.
+   * @param {Object} [options]
+   * @param {Number} [options.repeat] - defaults to the loop of the sequence.
+   * @param {String} [options.layer] - the layer to play on.
+   * @param {Function} [callback] - called with `cancelled` when it's done.
+   * @returns {module:@yoda/light~SequenceInfo}
+   */
+  playSequence: function playSequence (path, options, callback) {
+    if (typeof options === 'function') {
+      callback = options
+      options = null
+    }
+    options = options || {}
+    return native.play(path, options.repeat, callback || function noop () {},
+      options.layer)
+  },
+
+  /**
+   * Stop the current animation, its callback gets `cancelled` as true.
+   * @function stopAnimation
+   */
+  stopAnimation: function stopAnimation () {
+    native.stopAnimation()
+    return this
+  },
+
+  /**
+   * Create or update a layer, which is shown after its first drawing.
+   * @function setLayer
+   * @param {String} name - the layer name.
+   * @param {Object} [options]
+   * @param {Number} [options.z=0] - the higher one is stacked above.
+   * @param {Number} [options.alpha=1] - the opacity of the layer.
+   * @param {Boolean} [options.keyed=false] - if the black LEDs of the layer
+   *        are transparent.
+   */
+  setLayer: function setLayer (name, options) {
+    options = Object.assign({ z: 0, alpha: 1, keyed: false }, options)
+    native.setLayer(name, options.z, options.alpha, !!options.keyed)
+    return this
+  },
+
+  /**
+   * Draw the frame of a layer, it's shown on the next `write()`.
+   * @function drawLayer
+   * @param {String} name - the layer name.
+   * @param {Buffer|Object} frame - the frame or the color `{ r, g, b, a }`.
+   * @param {Buffer} [mask] - the opacity of every LED from 0 to 255.
+   */
+  drawLayer: function drawLayer (name, frame, mask) {
+    if (!Buffer.isBuffer(frame)) {
+      frame = colorFrame(frame)
+    }
+    native.updateLayer(name, frame, mask)
+    return this
+  },
+
+  /**
+   * Remove a layer, it's hidden on the next `write()`.
+   * @function removeLayer
+   * @param {String} name - the layer name.
+   * @returns {Boolean} if the layer existed.
+   */
+  removeLayer: function removeLayer (name) {
+    return native.removeLayer(name)
+  },
+
+  Easing: Easing
+
+}
+
+function applyAlpha (color) {
+  var alpha = color.a
+  if (typeof alpha === 'number' && alpha >= 0 && alpha < 1) {
+    return {
+      r: Math.floor(alpha * color.r),
+      g: Math.floor(alpha * color.g),
+      b: Math.floor(alpha * color.b)
+    }
   }
+  return color
+}
 
+function colorFrame (color) {
+  color = applyAlpha(color)
+  var frame = Buffer.alloc(config.leds * config.format)
+  for (var i = 0; i < frame.length; i += config.format) {
+    frame[i] = color.r
+    frame[i + 1] = color.g
+    frame[i + 2] = color.b
+  }
+  return frame
 }
@@ -0,0 +1,181 @@
+#include "LightAnimator.h"
+#include "LightFrame.h"
+#include <errno.h>
+#include <stdio.h>
+#include <time.h>
+
+#define NS_PER_MS 1000000ULL
+#define NS_PER_SEC 1000000000ULL
+
+static uint64_t monotonic_now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+static double light_ease(int easing, double p) {
+  switch (easing) {
+    case LIGHT_EASING_IN:
+      return p * p;
+    case LIGHT_EASING_OUT:
+      return 1 - (1 - p) * (1 - p);
+    case LIGHT_EASING_IN_OUT:
+      return p < 0.5 ? 2 * p * p : 1 - 2 * (1 - p) * (1 - p);
+    case LIGHT_EASING_STEP:
+      return 0;
+    default:
+      return p;
+  }
+}
+
+LightAnimator::LightAnimator() {
+  pthread_mutex_init(&mutex, NULL);
+  pthread_condattr_t attr;
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&cond, &attr);
+  pthread_condattr_destroy(&attr);
+}
+
+LightAnimator::~LightAnimator() {
+  stop();
+  pthread_cond_destroy(&cond);
+  pthread_mutex_destroy(&mutex);
+}
+
+void LightAnimator::setTarget(light_draw_callback draw_, void* data) {
+  draw = draw_;
+  draw_data = data;
+}
+
+bool LightAnimator::start(const LightTimeline& timeline_, int fps,
+                          light_done_callback done_, void* data) {
+  stop();
+  if (draw == NULL || fps <= 0 || timeline_.times.empty() ||
+      timeline_.easings.size() < timeline_.times.size() ||
+      timeline_.frames.size() < timeline_.times.size() * timeline_.frame_size)
+    return false;
+  timeline = timeline_;
+  interval = NS_PER_SEC / fps;
+  done = done_;
+  done_data = data;
+  stopping = false;
+  finished = false;
+  if (pthread_create(&thread, NULL, LightAnimator::Run, this) != 0) {
+    fprintf(stderr, "light: failed to start the animation(%d)\n", errno);
+    return false;
+  }
+  started = true;
+  return true;
+}
+
+void LightAnimator::stop() {
+  if (!started)
+    return;
+  pthread_mutex_lock(&mutex);
+  stopping = true;
+  pthread_cond_signal(&cond);
+  pthread_mutex_unlock(&mutex);
+  pthread_join(thread, NULL);
+  started = false;
+}
+
+bool LightAnimator::running() {
+  pthread_mutex_lock(&mutex);
+  bool ret = started && !finished;
+  pthread_mutex_unlock(&mutex);
+  return ret;
+}
+
+void* LightAnimator::Run(void* data) {
+  LightAnimator* self = static_cast<LightAnimator*>(data);
+  const LightTimeline& timeline = self->timeline;
+  uint64_t duration = (uint64_t)timeline.times.back() * NS_PER_MS;
+  vector<uint8_t> out(timeline.frame_size);
+  uint64_t begin = monotonic_now();
+  uint64_t tick = begin;
+  bool cancelled = false;
+
+  for (;;) {
+    uint64_t elapsed = tick - begin;
+    uint64_t offset = duration;
+    bool last = true;
+    if (duration > 0) {
+      uint64_t loop = elapsed / duration;
+      if (timeline.repeat < 0 || loop <= (uint64_t)timeline.repeat) {
+        offset = elapsed % duration;
+        last = false;
+      }
+    }
+    self->renderAt(offset, out.data());
+    self->draw(self->draw_data, out.data(), out.size());
+    if (last)
+      break;
+
+    tick = self->nextTick(tick, begin, duration);
+    struct timespec deadline;
+    deadline.tv_sec = tick / NS_PER_SEC;
+    deadline.tv_nsec = tick % NS_PER_SEC;
+    pthread_mutex_lock(&self->mutex);
+    while (!self->stopping && monotonic_now() < tick) {
+      pthread_cond_timedwait(&self->cond, &self->mutex, &deadline);
+    }
+    cancelled = self->stopping;
+    pthread_mutex_unlock(&self->mutex);
+    if (cancelled)
+      break;
+  }
+
+  pthread_mutex_lock(&self->mutex);
+  self->finished = true;
+  pthread_mutex_unlock(&self->mutex);
+  if (self->done != NULL) {
+    self->done(self->done_data, cancelled);
+  }
+  return NULL;
+}
+
+uint64_t LightAnimator::nextTick(uint64_t tick, uint64_t begin,
+                                 uint64_t duration) {
+  uint64_t now = monotonic_now();
+  if (!timeline.timed) {
+    tick += interval;
+    if (tick <= now) {
+      // drop the missed ticks rather than rendering them in a burst
+      tick += ((now - tick) / interval + 1) * interval;
+    }
+    return tick;
+  }
+  // the next keyframe of the current loop, or the start of the next loop
+  uint64_t loop_start = begin + ((tick - begin) / duration) * duration;
+  uint64_t next = loop_start + duration;
+  for (size_t i = 0; i < timeline.times.size(); i++) {
+    uint64_t at = loop_start + (uint64_t)timeline.times[i] * NS_PER_MS;
+    if (at > tick) {
+      next = at;
+      break;
+    }
+  }
+  // a late keyframe is drawn right away, the frame is picked by the time
+  return next > now ? next : now;
+}
+
+void LightAnimator::renderAt(uint64_t offset, uint8_t* out) {
+  const vector<uint32_t>& times = timeline.times;
+  size_t len = timeline.frame_size;
+  const uint8_t* frames = timeline.frames.data();
+  size_t count = times.size();
+  uint64_t ms = offset / NS_PER_MS;
+  size_t i = 0;
+  while (i + 1 < count && times[i + 1] <= ms) {
+    i++;
+  }
+  if (i + 1 >= count || ms < times[i]) {
+    light_frame_scale(out, frames + i * len, len, LIGHT_ALPHA_ONE);
+    return;
+  }
+  double p = (double)(offset - times[i] * NS_PER_MS) /
+             ((times[i + 1] - times[i]) * NS_PER_MS);
+  uint16_t alpha = light_frame_alpha(light_ease(timeline.easings[i], p));
+  light_frame_blend(out, frames + i * len, frames + (i + 1) * len, len, alpha);
+}
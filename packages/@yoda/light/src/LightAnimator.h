@@ -0,0 +1,86 @@
+#ifndef LIGHT_ANIMATOR_H
+#define LIGHT_ANIMATOR_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+using namespace std;
+
+enum LightEasing {
+  LIGHT_EASING_LINEAR = 0,
+  LIGHT_EASING_IN,
+  LIGHT_EASING_OUT,
+  LIGHT_EASING_IN_OUT,
+  // holds the keyframe until the next one
+  LIGHT_EASING_STEP,
+};
+
+/**
+ * The keyframes of an animation, the frames are stored back to back and the
+ * easing of a keyframe applies to the transition towards the next one.
+ */
+struct LightTimeline {
+  vector<uint8_t> frames;
+  // the ascending offsets in ms
+  vector<uint32_t> times;
+  vector<int> easings;
+  size_t frame_size;
+  // the extra loops after the first one, negative to loop forever
+  int repeat;
+  // draws at the keyframe times instead of every tick of the fps
+  bool timed;
+};
+
+typedef int (*light_draw_callback)(void* data, const uint8_t* frame,
+                                   size_t len);
+typedef void (*light_done_callback)(void* data, bool cancelled);
+
+/**
+ * @class LightAnimator
+ * Plays a timeline on its own thread, a frame is interpolated and drawn at
+ * every tick of the given fps, the ticks are scheduled on the monotonic clock
+ * and the late ones are dropped instead of being accumulated.
+ */
+class LightAnimator {
+ public:
+  LightAnimator();
+  ~LightAnimator();
+
+  void setTarget(light_draw_callback draw, void* data);
+  /**
+   * @method start
+   * stops the current animation, then plays the timeline. The done callback
+   * is called on the animation thread.
+   */
+  bool start(const LightTimeline& timeline, int fps, light_done_callback done,
+             void* data);
+  /**
+   * @method stop
+   * cancels the current animation and waits for its thread.
+   */
+  void stop();
+  bool running();
+
+ private:
+  static void* Run(void* data);
+  void renderAt(uint64_t offset, uint8_t* out);
+  uint64_t nextTick(uint64_t tick, uint64_t begin, uint64_t duration);
+
+ private:
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  bool started = false;
+  bool finished = false;
+  bool stopping = false;
+
+  LightTimeline timeline;
+  uint64_t interval = 0;
+  light_draw_callback draw = NULL;
+  void* draw_data = NULL;
+  light_done_callback done = NULL;
+  void* done_data = NULL;
+};
+
+#endif // LIGHT_ANIMATOR_H
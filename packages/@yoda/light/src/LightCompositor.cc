@@ -0,0 +1,151 @@
+#include "LightCompositor.h"
+#include "LightFrame.h"
+#include <string.h>
+#include <algorithm>
+
+LightCompositor::LightCompositor() {
+  pthread_mutex_init(&mutex, NULL);
+}
+
+LightCompositor::~LightCompositor() {
+  pthread_mutex_destroy(&mutex);
+}
+
+void LightCompositor::configure(int count_, int bit_) {
+  pthread_mutex_lock(&mutex);
+  count = count_;
+  bit = bit_;
+  base.assign((size_t)count * bit, 0);
+  layers.clear();
+  stack.clear();
+  pthread_mutex_unlock(&mutex);
+}
+
+bool LightCompositor::empty() {
+  pthread_mutex_lock(&mutex);
+  bool ret = layers.empty();
+  pthread_mutex_unlock(&mutex);
+  return ret;
+}
+
+bool LightCompositor::setLayer(const string& name, int z, double alpha,
+                               bool keyed) {
+  pthread_mutex_lock(&mutex);
+  map<string, Layer>::iterator it = layers.find(name);
+  if (it == layers.end()) {
+    if (layers.size() >= LIGHT_MAX_LAYERS || count <= 0) {
+      pthread_mutex_unlock(&mutex);
+      return false;
+    }
+    Layer& layer = layers[name];
+    layer.order = created++;
+    layer.frame.assign((size_t)count * bit, 0);
+    // shows nothing until the first update
+    layer.mask.assign((size_t)count, 0);
+    layer.masked = true;
+    it = layers.find(name);
+  }
+  Layer& layer = it->second;
+  layer.z = z;
+  layer.alpha = light_frame_alpha(alpha);
+  layer.keyed = keyed;
+  sortLayers();
+  pthread_mutex_unlock(&mutex);
+  return true;
+}
+
+bool LightCompositor::updateLayer(const string& name, const uint8_t* frame,
+                                  const uint8_t* mask) {
+  pthread_mutex_lock(&mutex);
+  map<string, Layer>::iterator it = layers.find(name);
+  if (it == layers.end()) {
+    pthread_mutex_unlock(&mutex);
+    return false;
+  }
+  Layer& layer = it->second;
+  memcpy(layer.frame.data(), frame, layer.frame.size());
+  if (mask != NULL) {
+    memcpy(layer.mask.data(), mask, layer.mask.size());
+    layer.masked = true;
+  } else if (layer.keyed) {
+    for (int i = 0; i < count; i++) {
+      const uint8_t* pixel = frame + i * bit;
+      bool lit = false;
+      for (int c = 0; c < bit; c++) {
+        lit = lit || pixel[c] != 0;
+      }
+      layer.mask[i] = lit ? 255 : 0;
+    }
+    layer.masked = true;
+  } else {
+    layer.masked = false;
+  }
+  pthread_mutex_unlock(&mutex);
+  return true;
+}
+
+bool LightCompositor::removeLayer(const string& name) {
+  pthread_mutex_lock(&mutex);
+  bool removed = layers.erase(name) > 0;
+  if (removed) {
+    sortLayers();
+  }
+  pthread_mutex_unlock(&mutex);
+  return removed;
+}
+
+bool LightCompositor::hasLayer(const string& name) {
+  pthread_mutex_lock(&mutex);
+  bool ret = layers.find(name) != layers.end();
+  pthread_mutex_unlock(&mutex);
+  return ret;
+}
+
+void LightCompositor::clear() {
+  pthread_mutex_lock(&mutex);
+  layers.clear();
+  stack.clear();
+  pthread_mutex_unlock(&mutex);
+}
+
+void LightCompositor::flatten(uint8_t* out) {
+  pthread_mutex_lock(&mutex);
+  flattenLocked(out);
+  pthread_mutex_unlock(&mutex);
+}
+
+void LightCompositor::compose(const uint8_t* frame, uint8_t* out) {
+  pthread_mutex_lock(&mutex);
+  memcpy(base.data(), frame, base.size());
+  flattenLocked(out);
+  pthread_mutex_unlock(&mutex);
+}
+
+void LightCompositor::flattenLocked(uint8_t* out) {
+  size_t len = base.size();
+  memcpy(out, base.data(), len);
+  for (size_t i = 0; i < stack.size(); i++) {
+    const Layer* layer = stack[i];
+    if (layer->masked) {
+      light_frame_blend_mask(out, layer->frame.data(), layer->mask.data(),
+                             count, bit, layer->alpha);
+    } else {
+      light_frame_blend(out, out, layer->frame.data(), len, layer->alpha);
+    }
+  }
+}
+
+bool LightCompositor::lowerLayer(const Layer* a, const Layer* b) {
+  if (a->z != b->z)
+    return a->z < b->z;
+  return a->order < b->order;
+}
+
+void LightCompositor::sortLayers() {
+  stack.clear();
+  map<string, Layer>::iterator it = layers.begin();
+  for (; it != layers.end(); ++it) {
+    stack.push_back(&it->second);
+  }
+  sort(stack.begin(), stack.end(), LightCompositor::lowerLayer);
+}
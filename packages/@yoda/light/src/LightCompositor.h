@@ -0,0 +1,82 @@
+#ifndef LIGHT_COMPOSITOR_H
+#define LIGHT_COMPOSITOR_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+using namespace std;
+
+// the maximum number of the named layers
+#define LIGHT_MAX_LAYERS 16
+
+/**
+ * @class LightCompositor
+ * Stacks the named layers over the base frame, which is the frame rendered
+ * by `render()`. Every layer has its own frame, alpha and z-order, and an
+ * optional per-LED mask to let the base show through. It's shared by the
+ * loop and the animation threads.
+ */
+class LightCompositor {
+ public:
+  LightCompositor();
+  ~LightCompositor();
+
+  void configure(int count, int bit);
+  bool empty();
+  /**
+   * @method setLayer
+   * creates or updates the layer, a keyed layer treats its black LEDs as
+   * transparent.
+   */
+  bool setLayer(const string& name, int z, double alpha, bool keyed);
+  /**
+   * @method updateLayer
+   * replaces the frame of the layer, the mask is 1 byte per LED and NULL to
+   * derive it from the keyed flag.
+   */
+  bool updateLayer(const string& name, const uint8_t* frame,
+                   const uint8_t* mask);
+  bool removeLayer(const string& name);
+  bool hasLayer(const string& name);
+  void clear();
+  /**
+   * @method flatten
+   * blends the layers in z-order over the base into `out`.
+   */
+  void flatten(uint8_t* out);
+  /**
+   * @method compose
+   * sets the base and flattens at once, so that the base of another thread
+   * is never flattened in between.
+   */
+  void compose(const uint8_t* frame, uint8_t* out);
+
+ private:
+  struct Layer {
+    int z;
+    uint16_t alpha;
+    bool keyed;
+    bool masked;
+    uint64_t order;
+    vector<uint8_t> frame;
+    vector<uint8_t> mask;
+  };
+  static bool lowerLayer(const Layer* a, const Layer* b);
+  void sortLayers();
+  void flattenLocked(uint8_t* out);
+
+ private:
+  pthread_mutex_t mutex;
+  int count = 0;
+  int bit = 3;
+  uint64_t created = 0;
+  vector<uint8_t> base;
+  map<string, Layer> layers;
+  // the layers in z-order, ties are kept in the creation order
+  vector<Layer*> stack;
+};
+
+#endif // LIGHT_COMPOSITOR_H
@@ -0,0 +1,134 @@
+#include "LightFrame.h"
+#include <string.h>
+#include <algorithm>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define LIGHT_FRAME_NEON 1
+#endif
+
+uint16_t light_frame_alpha(double alpha) {
+  if (!(alpha > 0))
+    return 0;
+  if (alpha >= 1)
+    return LIGHT_ALPHA_ONE;
+  return (uint16_t)(alpha * LIGHT_ALPHA_ONE);
+}
+
+void light_frame_scale(uint8_t* dst, const uint8_t* src, size_t len,
+                       uint16_t factor) {
+  if (factor >= LIGHT_ALPHA_ONE) {
+    if (dst != src)
+      memmove(dst, src, len);
+    return;
+  }
+  if (factor == 0) {
+    memset(dst, 0, len);
+    return;
+  }
+  size_t i = 0;
+#ifdef LIGHT_FRAME_NEON
+  uint8x8_t f = vdup_n_u8((uint8_t)factor);
+  for (; i + 8 <= len; i += 8) {
+    uint16x8_t x = vmull_u8(vld1_u8(src + i), f);
+    vst1_u8(dst + i, vshrn_n_u16(x, 8));
+  }
+#endif
+  for (; i < len; i++) {
+    dst[i] = (uint8_t)((src[i] * factor) >> 8);
+  }
+}
+
+void light_frame_blend(uint8_t* dst, const uint8_t* a, const uint8_t* b,
+                       size_t len, uint16_t alpha) {
+  if (alpha == 0) {
+    light_frame_scale(dst, a, len, LIGHT_ALPHA_ONE);
+    return;
+  }
+  if (alpha >= LIGHT_ALPHA_ONE) {
+    light_frame_scale(dst, b, len, LIGHT_ALPHA_ONE);
+    return;
+  }
+  // both of the weights fit into a byte, so does the sum into 16 bits
+  uint16_t inverse = LIGHT_ALPHA_ONE - alpha;
+  size_t i = 0;
+#ifdef LIGHT_FRAME_NEON
+  uint8x8_t wa = vdup_n_u8((uint8_t)inverse);
+  uint8x8_t wb = vdup_n_u8((uint8_t)alpha);
+  for (; i + 8 <= len; i += 8) {
+    uint16x8_t x = vmull_u8(vld1_u8(a + i), wa);
+    x = vmlal_u8(x, vld1_u8(b + i), wb);
+    vst1_u8(dst + i, vshrn_n_u16(x, 8));
+  }
+#endif
+  for (; i < len; i++) {
+    dst[i] = (uint8_t)((a[i] * inverse + b[i] * alpha) >> 8);
+  }
+}
+
+void light_frame_blend_mask(uint8_t* dst, const uint8_t* src,
+                            const uint8_t* mask, int count, int bit,
+                            uint16_t alpha) {
+  for (int i = 0; i < count; i++) {
+    uint16_t weight = (uint16_t)((alpha * mask[i]) / 255);
+    if (weight == 0)
+      continue;
+    uint16_t inverse = LIGHT_ALPHA_ONE - weight;
+    uint8_t* d = dst + i * bit;
+    const uint8_t* s = src + i * bit;
+    for (int c = 0; c < bit; c++) {
+      d[c] = (uint8_t)((d[c] * inverse + s[c] * weight) >> 8);
+    }
+  }
+}
+
+void light_frame_gradient(uint8_t* frame, int count, int bit, int from,
+                          int to, const uint8_t* start, const uint8_t* end) {
+  if (from > to)
+    std::swap(from, to);
+  from = std::max(from, 0);
+  to = std::min(to, count - 1);
+  int span = to - from;
+  for (int i = from; i <= to; i++) {
+    // 16.16 fixed point position of the LED within the range
+    int t = span > 0 ? ((i - from) << 16) / span : 0;
+    uint8_t* pixel = frame + i * bit;
+    for (int c = 0; c < 3; c++) {
+      int delta = (int)end[c] - (int)start[c];
+      pixel[c] = (uint8_t)(start[c] + ((delta * t) >> 16));
+    }
+  }
+}
+
+static int light_frame_normalize(int steps, int count) {
+  steps %= count;
+  return steps < 0 ? steps + count : steps;
+}
+
+void light_frame_rotate(uint8_t* frame, int count, int bit, int steps) {
+  if (count <= 0)
+    return;
+  steps = light_frame_normalize(steps, count);
+  if (steps == 0)
+    return;
+  size_t len = (size_t)count * bit;
+  std::rotate(frame, frame + len - (size_t)steps * bit, frame + len);
+}
+
+void light_frame_shift(uint8_t* frame, int count, int bit, int steps) {
+  if (count <= 0 || steps == 0)
+    return;
+  size_t len = (size_t)count * bit;
+  if (steps >= count || steps <= -count) {
+    memset(frame, 0, len);
+    return;
+  }
+  size_t moved = (size_t)(steps > 0 ? steps : -steps) * bit;
+  if (steps > 0) {
+    memmove(frame + moved, frame, len - moved);
+    memset(frame, 0, moved);
+  } else {
+    memmove(frame, frame + moved, len - moved);
+    memset(frame + len - moved, 0, moved);
+  }
+}
@@ -0,0 +1,56 @@
+#ifndef LIGHT_FRAME_H
+#define LIGHT_FRAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * The kernels operate on a whole frame of `count` LEDs, each LED takes `bit`
+ * bytes and the first 3 bytes are the rgb. The alpha factors are the fixed
+ * point numbers in 0..256, where 256 keeps the color unchanged.
+ */
+#define LIGHT_ALPHA_ONE 256
+
+/**
+ * converts an alpha in 0..1 to the fixed point factor.
+ */
+uint16_t light_frame_alpha(double alpha);
+
+/**
+ * dst = src * factor, `dst` could be the same as `src`.
+ */
+void light_frame_scale(uint8_t* dst, const uint8_t* src, size_t len,
+                       uint16_t factor);
+
+/**
+ * dst = a * (1 - alpha) + b * alpha, `dst` could be the same as `a` or `b`.
+ */
+void light_frame_blend(uint8_t* dst, const uint8_t* a, const uint8_t* b,
+                       size_t len, uint16_t alpha);
+
+/**
+ * dst = dst * (1 - w) + src * w for every LED, where w = alpha * mask / 255
+ * and the mask is 1 byte per LED.
+ */
+void light_frame_blend_mask(uint8_t* dst, const uint8_t* src,
+                            const uint8_t* mask, int count, int bit,
+                            uint16_t alpha);
+
+/**
+ * fills the LEDs in [from, to] with the linear gradient of `start` to `end`,
+ * the colors are 3 bytes rgb.
+ */
+void light_frame_gradient(uint8_t* frame, int count, int bit, int from,
+                          int to, const uint8_t* start, const uint8_t* end);
+
+/**
+ * rotates the ring by `steps` LEDs, a positive step moves the LED i to i+1.
+ */
+void light_frame_rotate(uint8_t* frame, int count, int bit, int steps);
+
+/**
+ * shifts the LEDs by `steps` like `rotate`, the vacated LEDs are cleared.
+ */
+void light_frame_shift(uint8_t* frame, int count, int bit, int steps);
+
+#endif // LIGHT_FRAME_H
@@ -1,11 +1,134 @@
 #include "LightNative.h"
+#include "LightFrame.h"
+#include "LightAnimator.h"
+#include "LightCompositor.h"
+#include "LightSequence.h"
 #include <lumenflinger/LumenLight.h>
+#ifdef LIGHT_FAKE_DRIVER
+#include "FakeLumenLight.h"
+#endif
 #include <errno.h>
+#include <pthread.h>
 
 LumenLight light;
 char* frame = NULL;
 int ledCount = 0;
 int ledBit = 3;
+uint16_t brightness = LIGHT_ALPHA_ONE;
+// serializes the drawing of the loop and the animation threads, and guards
+// all the states below.
+pthread_mutex_t draw_mutex = PTHREAD_MUTEX_INITIALIZER;
+// serializes the composing and the drawing of the loop and the animation
+// threads, so the latest composed frame is the last one drawn.
+pthread_mutex_t present_mutex = PTHREAD_MUTEX_INITIALIZER;
+LightAnimator animator;
+
+// the next frame is composed into the back buffer, and swapped with the front
+// one which holds what the driver is showing.
+uint8_t* frontBuffer = NULL;
+uint8_t* backBuffer = NULL;
+// false if the driver content is unknown, e.g. after an explicit write.
+bool frontValid = false;
+uint64_t framesDrawn = 0;
+uint64_t framesSkipped = 0;
+uint64_t framesFailed = 0;
+
+LightCompositor compositor;
+// the flattened frame of the loop thread
+uint8_t* composed = NULL;
+// the flattened frame of the animation thread
+vector<uint8_t> animationComposed;
+// the layer updated by the animation, empty for the base frame, it's only
+// changed while the animator is stopped.
+string animationLayer;
+// the last frame of the animation on the base, the renders are composed over
+// it instead of the frame while the animation owns the base. Both are guarded
+// by present_mutex.
+vector<uint8_t> animationFrame;
+bool animationOwnsBase = false;
+// the animation whose end hands the base back to the frame
+iotjs_light_animation_t* currentAnimation = NULL;
+
+/**
+ * draws the frame with the global brightness, it's the target of both the
+ * render and the animator. The frame is skipped if it's identical to the
+ * showing one.
+ */
+static int DrawFrame(void* data, const uint8_t* bytes, size_t len) {
+  pthread_mutex_lock(&draw_mutex);
+  if (NULL == backBuffer || len != (size_t)(ledCount * ledBit)) {
+    pthread_mutex_unlock(&draw_mutex);
+    return -EINVAL;
+  }
+  light_frame_scale(backBuffer, bytes, len, brightness);
+  if (frontValid && memcmp(backBuffer, frontBuffer, len) == 0) {
+    framesSkipped += 1;
+#ifdef LIGHT_FAKE_DRIVER
+    fake_lumen_skip();
+#endif
+    pthread_mutex_unlock(&draw_mutex);
+    return 0;
+  }
+  uint8_t* swapped = frontBuffer;
+  frontBuffer = backBuffer;
+  backBuffer = swapped;
+  int r = light.lumen_draw(frontBuffer, (int)len);
+  frontValid = r == 0;
+  if (r == 0) {
+    framesDrawn += 1;
+  } else {
+    framesFailed += 1;
+  }
+  pthread_mutex_unlock(&draw_mutex);
+  if (r != 0) {
+    fprintf(stderr, "lumen_draw failed, it returns %d, (%d)%s\n", r, errno,
+            strerror(errno));
+  }
+  return r;
+}
+
+/**
+ * flattens the layers over the base frame, then draws the result. The base is
+ * recorded even without any layer, since a layer animated later is flattened
+ * over it. The present_mutex must be held.
+ */
+static int Present(const uint8_t* base, uint8_t* out, size_t len) {
+  compositor.compose(base, out);
+  return DrawFrame(NULL, out, len);
+}
+
+static int DrawAnimation(void* data, const uint8_t* bytes, size_t len) {
+  pthread_mutex_lock(&present_mutex);
+  int r;
+  if (!animationLayer.empty()) {
+    compositor.updateLayer(animationLayer, bytes, NULL);
+    compositor.flatten(animationComposed.data());
+    r = DrawFrame(NULL, animationComposed.data(), len);
+  } else if (len != animationFrame.size()) {
+    r = -EINVAL;
+  } else {
+    memcpy(animationFrame.data(), bytes, len);
+    animationOwnsBase = true;
+    r = Present(animationFrame.data(), animationComposed.data(), len);
+  }
+  pthread_mutex_unlock(&present_mutex);
+  return r;
+}
+
+/**
+ * stops the animation and copies its last frame back into the frame, so that
+ * the next render continues from what's shown.
+ */
+static void StopAnimator() {
+  animator.stop();
+  currentAnimation = NULL;
+  pthread_mutex_lock(&present_mutex);
+  if (animationOwnsBase && frame != NULL) {
+    memcpy(frame, animationFrame.data(), animationFrame.size());
+  }
+  animationOwnsBase = false;
+  pthread_mutex_unlock(&present_mutex);
+}
 
 JS_FUNCTION(Enable) {
   light.lumen_set_enable(true);
@@ -14,13 +137,39 @@ JS_FUNCTION(Enable) {
   if (ledCount <= 0) {
     return JS_CREATE_ERROR(RANGE, "Can't get the number of leds");
   }
-  frame = new char[ledCount * ledBit];
+  if (NULL == frame) {
+    frame = new char[ledCount * ledBit]();
+    composed = new uint8_t[ledCount * ledBit]();
+    animationComposed.assign(ledCount * ledBit, 0);
+    animationFrame.assign(ledCount * ledBit, 0);
+    compositor.configure(ledCount, ledBit);
+    pthread_mutex_lock(&draw_mutex);
+    frontBuffer = new uint8_t[ledCount * ledBit]();
+    backBuffer = new uint8_t[ledCount * ledBit]();
+    pthread_mutex_unlock(&draw_mutex);
+  }
+  // the driver may have been reset while disabled
+  pthread_mutex_lock(&draw_mutex);
+  frontValid = false;
+  pthread_mutex_unlock(&draw_mutex);
   return jerry_create_boolean(true);
 }
 
 JS_FUNCTION(Disable) {
+  StopAnimator();
   light.lumen_set_enable(false);
-  delete frame;
+  compositor.clear();
+  delete[] frame;
+  delete[] composed;
+  frame = NULL;
+  composed = NULL;
+  pthread_mutex_lock(&draw_mutex);
+  delete[] frontBuffer;
+  delete[] backBuffer;
+  frontBuffer = NULL;
+  backBuffer = NULL;
+  frontValid = false;
+  pthread_mutex_unlock(&draw_mutex);
   return jerry_create_boolean(true);
 }
 
@@ -28,7 +177,10 @@ JS_FUNCTION(Write) {
   iotjs_bufferwrap_t* buffer = iotjs_bufferwrap_from_jbuffer(jargv[0]);
   int srclen = (int)iotjs_bufferwrap_length(buffer);
   unsigned char* bytes = (unsigned char*)iotjs_bufferwrap_buffer(buffer);
+  pthread_mutex_lock(&draw_mutex);
   int r = light.lumen_draw(bytes, srclen + 1);
+  frontValid = false;
+  pthread_mutex_unlock(&draw_mutex);
   if (r != 0) {
     fprintf(stderr, "lumen_draw failed, it returns %d, (%d)%s\n", r, errno,
             strerror(errno));
@@ -41,11 +193,11 @@ JS_FUNCTION(Render) {
     return JS_CREATE_ERROR(COMMON,
                            "LumenLight is disabled, please enable first")
   }
-  int r = light.lumen_draw((unsigned char*)frame, ledCount * ledBit);
-  if (r != 0) {
-    fprintf(stderr, "lumen_draw failed, it returns %d, (%d)%s\n", r, errno,
-            strerror(errno));
-  }
+  pthread_mutex_lock(&present_mutex);
+  const uint8_t* base =
+      animationOwnsBase ? animationFrame.data() : (const uint8_t*)frame;
+  int r = Present(base, composed, ledCount * ledBit);
+  pthread_mutex_unlock(&present_mutex);
   return jerry_create_number(r);
 }
 
@@ -102,7 +254,408 @@ JS_FUNCTION(Fill) {
   return jerry_create_undefined();
 }
 
+/*
+ * colors(buffer, start)
+ * copies the per-LED colors of the buffer into the frame from the LED start.
+ */
+JS_FUNCTION(Colors) {
+  if (NULL == frame) {
+    return JS_CREATE_ERROR(COMMON,
+                           "LumenLight is disabled, please enable first")
+  }
+  iotjs_bufferwrap_t* buffer = iotjs_bufferwrap_from_jbuffer(jargv[0]);
+  int start = jargc > 1 ? jerry_get_number_value(jargv[1]) : 0;
+  if (start >= ledCount || start < 0) {
+    return JS_CREATE_ERROR(RANGE, "The position of the led is out of range");
+  }
+  size_t len = iotjs_bufferwrap_length(buffer);
+  size_t available = (size_t)(ledCount - start) * ledBit;
+  memcpy(frame + start * ledBit, iotjs_bufferwrap_buffer(buffer),
+         len < available ? len : available);
+  return jerry_create_undefined();
+}
+
+/*
+ * gradient(from, to, r0, g0, b0, r1, g1, b1)
+ */
+JS_FUNCTION(Gradient) {
+  if (NULL == frame) {
+    return JS_CREATE_ERROR(COMMON,
+                           "LumenLight is disabled, please enable first")
+  }
+  int from = jerry_get_number_value(jargv[0]);
+  int to = jerry_get_number_value(jargv[1]);
+  uint8_t start[3];
+  uint8_t end[3];
+  for (int i = 0; i < 3; i++) {
+    start[i] = (uint8_t)jerry_get_number_value(jargv[2 + i]);
+    end[i] = (uint8_t)jerry_get_number_value(jargv[5 + i]);
+  }
+  light_frame_gradient((uint8_t*)frame, ledCount, ledBit, from, to, start,
+                       end);
+  return jerry_create_undefined();
+}
+
+/*
+ * scale(alpha)
+ */
+JS_FUNCTION(Scale) {
+  if (NULL == frame) {
+    return JS_CREATE_ERROR(COMMON,
+                           "LumenLight is disabled, please enable first")
+  }
+  uint16_t factor = light_frame_alpha(jerry_get_number_value(jargv[0]));
+  light_frame_scale((uint8_t*)frame, (const uint8_t*)frame,
+                    ledCount * ledBit, factor);
+  return jerry_create_undefined();
+}
+
+/*
+ * blend(buffer, alpha)
+ * blends the buffer over the frame, the buffer must cover the whole frame.
+ */
+JS_FUNCTION(Blend) {
+  if (NULL == frame) {
+    return JS_CREATE_ERROR(COMMON,
+                           "LumenLight is disabled, please enable first")
+  }
+  iotjs_bufferwrap_t* buffer = iotjs_bufferwrap_from_jbuffer(jargv[0]);
+  size_t len = ledCount * ledBit;
+  if (iotjs_bufferwrap_length(buffer) < len) {
+    return JS_CREATE_ERROR(RANGE, "The buffer is smaller than the frame");
+  }
+  uint16_t alpha = light_frame_alpha(jerry_get_number_value(jargv[1]));
+  light_frame_blend((uint8_t*)frame, (const uint8_t*)frame,
+                    (const uint8_t*)iotjs_bufferwrap_buffer(buffer), len,
+                    alpha);
+  return jerry_create_undefined();
+}
+
+/*
+ * rotate(steps)
+ */
+JS_FUNCTION(Rotate) {
+  if (NULL == frame) {
+    return JS_CREATE_ERROR(COMMON,
+                           "LumenLight is disabled, please enable first")
+  }
+  int steps = jerry_get_number_value(jargv[0]);
+  light_frame_rotate((uint8_t*)frame, ledCount, ledBit, steps);
+  return jerry_create_undefined();
+}
+
+/*
+ * shift(steps)
+ */
+JS_FUNCTION(Shift) {
+  if (NULL == frame) {
+    return JS_CREATE_ERROR(COMMON,
+                           "LumenLight is disabled, please enable first")
+  }
+  int steps = jerry_get_number_value(jargv[0]);
+  light_frame_shift((uint8_t*)frame, ledCount, ledBit, steps);
+  return jerry_create_undefined();
+}
+
+/*
+ * setBrightness(alpha)
+ * the global factor applied on render, the frame itself is kept unscaled.
+ */
+JS_FUNCTION(SetBrightness) {
+  pthread_mutex_lock(&draw_mutex);
+  brightness = light_frame_alpha(jerry_get_number_value(jargv[0]));
+  pthread_mutex_unlock(&draw_mutex);
+  return jerry_create_undefined();
+}
+
+/*
+ * getStats(reset)
+ */
+JS_FUNCTION(GetStats) {
+  jerry_value_t stats = jerry_create_object();
+  pthread_mutex_lock(&draw_mutex);
+  iotjs_jval_set_property_number(stats, "drawn", (double)framesDrawn);
+  iotjs_jval_set_property_number(stats, "skipped", (double)framesSkipped);
+  iotjs_jval_set_property_number(stats, "failed", (double)framesFailed);
+  if (jargc > 0 && jerry_get_boolean_value(jargv[0])) {
+    framesDrawn = framesSkipped = framesFailed = 0;
+  }
+  pthread_mutex_unlock(&draw_mutex);
+  return stats;
+}
+
+static void AfterAnimationClose(uv_handle_t* handle) {
+  iotjs_light_animation_t* animation = (iotjs_light_animation_t*)handle;
+  jerry_release_value(animation->callback);
+  delete animation;
+}
+
+static void OnAnimationDone(uv_async_t* handle) {
+  iotjs_light_animation_t* animation = (iotjs_light_animation_t*)handle;
+  if (animation == currentAnimation) {
+    // completed, a replaced or stopped one has handed the base back already
+    StopAnimator();
+  }
+  if (jerry_value_is_function(animation->callback)) {
+    iotjs_jargs_t jargs = iotjs_jargs_create(1);
+    iotjs_jargs_append_bool(&jargs, animation->cancelled);
+    iotjs_make_callback(animation->callback, jerry_create_undefined(), &jargs);
+    iotjs_jargs_destroy(&jargs);
+  }
+  uv_close((uv_handle_t*)handle, AfterAnimationClose);
+}
+
+static void AnimationDone(void* data, bool cancelled) {
+  iotjs_light_animation_t* animation = (iotjs_light_animation_t*)data;
+  animation->cancelled = cancelled;
+  uv_async_send(&animation->async);
+}
+
+/**
+ * replaces the current animation, the callback is released once the
+ * animation is reported.
+ * @return {const char*} NULL on success, or the error message.
+ */
+static const char* StartAnimation(const LightTimeline& timeline, int fps,
+                                    jerry_value_t callback,
+                                    jerry_value_t jlayer) {
+  string layer;
+  if (jerry_value_is_string(jlayer)) {
+    jerry_size_t size = jerry_get_string_size(jlayer);
+    jerry_char_t name[size + 1];
+    jerry_string_to_char_buffer(jlayer, name, size);
+    name[size] = '\0';
+    layer.assign((char*)name, size);
+    if (!compositor.hasLayer(layer)) {
+      return "The layer is not found";
+    }
+  }
+  StopAnimator();
+  animationLayer = layer;
+
+  iotjs_light_animation_t* animation = new iotjs_light_animation_t;
+  animation->callback = jerry_acquire_value(callback);
+  animation->cancelled = false;
+  uv_async_init(uv_default_loop(), &animation->async, OnAnimationDone);
+  if (!animator.start(timeline, fps, AnimationDone, animation)) {
+    uv_close((uv_handle_t*)&animation->async, AfterAnimationClose);
+    return "Failed to start the animation";
+  }
+  currentAnimation = animation;
+  return NULL;
+}
+
+/*
+ * animate(frames, times, easings, repeat, fps, callback, layer)
+ * plays the keyframes on the animation thread, the frames buffer holds the
+ * keyframes back to back. The callback is called with `cancelled` once the
+ * animation is completed or replaced. The animation updates the given layer
+ * instead of the base frame if present.
+ */
+JS_FUNCTION(Animate) {
+  if (NULL == frame) {
+    return JS_CREATE_ERROR(COMMON,
+                           "LumenLight is disabled, please enable first")
+  }
+  iotjs_bufferwrap_t* buffer = iotjs_bufferwrap_from_jbuffer(jargv[0]);
+  LightTimeline timeline;
+  timeline.frame_size = ledCount * ledBit;
+  uint32_t count = jerry_get_array_length(jargv[1]);
+  if (count == 0 || jerry_get_array_length(jargv[2]) < count) {
+    return JS_CREATE_ERROR(COMMON, "The keyframes are empty or incomplete");
+  }
+  if (iotjs_bufferwrap_length(buffer) < count * timeline.frame_size) {
+    return JS_CREATE_ERROR(RANGE, "The buffer is smaller than the keyframes");
+  }
+  for (uint32_t i = 0; i < count; i++) {
+    jerry_value_t jtime = jerry_get_property_by_index(jargv[1], i);
+    jerry_value_t jeasing = jerry_get_property_by_index(jargv[2], i);
+    uint32_t time = (uint32_t)jerry_get_number_value(jtime);
+    timeline.times.push_back(time);
+    timeline.easings.push_back((int)jerry_get_number_value(jeasing));
+    jerry_release_value(jtime);
+    jerry_release_value(jeasing);
+    if (i > 0 && time < timeline.times[i - 1]) {
+      return JS_CREATE_ERROR(RANGE, "The keyframes must be in time order");
+    }
+  }
+  const uint8_t* bytes = (const uint8_t*)iotjs_bufferwrap_buffer(buffer);
+  timeline.frames.assign(bytes, bytes + count * timeline.frame_size);
+  timeline.repeat = jerry_get_number_value(jargv[3]);
+  int fps = jerry_get_number_value(jargv[4]);
+  if (fps <= 0) {
+    fps = light.getFps();
+  }
+  timeline.timed = false;
+  jerry_value_t jlayer = jargc > 6 ? jargv[6] : jerry_create_undefined();
+  const char* err = StartAnimation(timeline, fps, jargv[5], jlayer);
+  if (err != NULL) {
+    return JS_CREATE_ERROR(COMMON, err);
+  }
+  return jerry_create_undefined();
+}
+
+/*
+ * play(path, repeat, callback, layer)
+ * plays the precompiled sequence like animate, the repeat is the one of the
+ * sequence if it's not a number.
+ */
+JS_FUNCTION(Play) {
+  if (NULL == frame) {
+    return JS_CREATE_ERROR(COMMON,
+                           "LumenLight is disabled, please enable first")
+  }
+  jerry_size_t size = jerry_get_string_size(jargv[0]);
+  jerry_char_t path[size + 1];
+  jerry_string_to_char_buffer(jargv[0], path, size);
+  path[size] = '\0';
+
+  LightTimeline timeline;
+  LightSequenceInfo info;
+  int r = light_sequence_load((char*)path, ledCount, ledBit, timeline, info);
+  if (r != 0) {
+    return JS_CREATE_ERROR(COMMON, "Failed to load the sequence");
+  }
+  if (jerry_value_is_number(jargv[1])) {
+    timeline.repeat = jerry_get_number_value(jargv[1]);
+  }
+  jerry_value_t jlayer = jargc > 3 ? jargv[3] : jerry_create_undefined();
+  const char* err = StartAnimation(timeline, light.getFps(), jargv[2], jlayer);
+  if (err != NULL) {
+    return JS_CREATE_ERROR(COMMON, err);
+  }
+  jerry_value_t jinfo = jerry_create_object();
+  iotjs_jval_set_property_number(jinfo, "frames", info.frames);
+  iotjs_jval_set_property_number(jinfo, "duration", info.duration);
+  iotjs_jval_set_property_boolean(jinfo, "loop",
+                                  (info.flags & LIGHT_SEQUENCE_LOOP) != 0);
+  iotjs_jval_set_property_boolean(jinfo, "finishes",
+                                  (info.flags & LIGHT_SEQUENCE_FINISHES) != 0);
+  return jinfo;
+}
+
+/*
+ * stopAnimation()
+ * the callback of the animation is called with `cancelled` as true.
+ */
+JS_FUNCTION(StopAnimation) {
+  StopAnimator();
+  return jerry_create_undefined();
+}
+
+/*
+ * setLayer(name, z, alpha, keyed)
+ * creates or updates the layer, it's shown after the first updateLayer.
+ */
+JS_FUNCTION(SetLayer) {
+  if (NULL == frame) {
+    return JS_CREATE_ERROR(COMMON,
+                           "LumenLight is disabled, please enable first")
+  }
+  jerry_size_t size = jerry_get_string_size(jargv[0]);
+  jerry_char_t name[size + 1];
+  jerry_string_to_char_buffer(jargv[0], name, size);
+  name[size] = '\0';
+  int z = jerry_get_number_value(jargv[1]);
+  double alpha = jerry_get_number_value(jargv[2]);
+  bool keyed = jerry_get_boolean_value(jargv[3]);
+  if (!compositor.setLayer(string((char*)name, size), z, alpha, keyed)) {
+    return JS_CREATE_ERROR(RANGE, "Too many layers");
+  }
+  return jerry_create_undefined();
+}
+
+/*
+ * updateLayer(name, frame, mask)
+ * the mask is 1 byte per LED, it's optional.
+ */
+JS_FUNCTION(UpdateLayer) {
+  if (NULL == frame) {
+    return JS_CREATE_ERROR(COMMON,
+                           "LumenLight is disabled, please enable first")
+  }
+  jerry_size_t size = jerry_get_string_size(jargv[0]);
+  jerry_char_t name[size + 1];
+  jerry_string_to_char_buffer(jargv[0], name, size);
+  name[size] = '\0';
+  iotjs_bufferwrap_t* buffer = iotjs_bufferwrap_from_jbuffer(jargv[1]);
+  if (iotjs_bufferwrap_length(buffer) < (size_t)(ledCount * ledBit)) {
+    return JS_CREATE_ERROR(RANGE, "The buffer is smaller than the frame");
+  }
+  const uint8_t* mask = NULL;
+  if (jargc > 2 && jerry_value_is_object(jargv[2])) {
+    iotjs_bufferwrap_t* jmask = iotjs_bufferwrap_from_jbuffer(jargv[2]);
+    if (iotjs_bufferwrap_length(jmask) < (size_t)ledCount) {
+      return JS_CREATE_ERROR(RANGE, "The mask is smaller than the LEDs");
+    }
+    mask = (const uint8_t*)iotjs_bufferwrap_buffer(jmask);
+  }
+  if (!compositor.updateLayer(string((char*)name, size),
+                              (const uint8_t*)iotjs_bufferwrap_buffer(buffer),
+                              mask)) {
+    return JS_CREATE_ERROR(COMMON, "The layer is not found");
+  }
+  return jerry_create_undefined();
+}
+
+/*
+ * boolean removeLayer(name)
+ */
+JS_FUNCTION(RemoveLayer) {
+  jerry_size_t size = jerry_get_string_size(jargv[0]);
+  jerry_char_t name[size + 1];
+  jerry_string_to_char_buffer(jargv[0], name, size);
+  name[size] = '\0';
+  bool removed = compositor.removeLayer(string((char*)name, size));
+  return jerry_create_boolean(removed);
+}
+
+#ifdef LIGHT_FAKE_DRIVER
+/*
+ * getDriverRecords(reset)
+ * the draws recorded by the fake driver, the times are monotonic in ms. The
+ * frames skipped by the dirty check are recorded as well.
+ */
+JS_FUNCTION(GetDriverRecords) {
+  vector<FakeLumenRecord> records;
+  vector<uint8_t> last;
+  fake_lumen_records(records, last,
+                     jargc > 0 && jerry_get_boolean_value(jargv[0]));
+  jerry_value_t jtimes = jerry_create_array(records.size());
+  jerry_value_t jchanged = jerry_create_array(records.size());
+  jerry_value_t jskipped = jerry_create_array(records.size());
+  for (size_t i = 0; i < records.size(); i++) {
+    jerry_value_t jtime = jerry_create_number(records[i].at / 1e6);
+    jerry_value_t jflag = jerry_create_boolean(records[i].changed);
+    jerry_value_t jskip = jerry_create_boolean(records[i].skipped);
+    jerry_release_value(jerry_set_property_by_index(jtimes, i, jtime));
+    jerry_release_value(jerry_set_property_by_index(jchanged, i, jflag));
+    jerry_release_value(jerry_set_property_by_index(jskipped, i, jskip));
+    jerry_release_value(jtime);
+    jerry_release_value(jflag);
+    jerry_release_value(jskip);
+  }
+  jerry_value_t jlast = jerry_create_array(last.size());
+  for (size_t i = 0; i < last.size(); i++) {
+    jerry_value_t jbyte = jerry_create_number(last[i]);
+    jerry_release_value(jerry_set_property_by_index(jlast, i, jbyte));
+    jerry_release_value(jbyte);
+  }
+  jerry_value_t jrecords = jerry_create_object();
+  iotjs_jval_set_property_jval(jrecords, "times", jtimes);
+  iotjs_jval_set_property_jval(jrecords, "changed", jchanged);
+  iotjs_jval_set_property_jval(jrecords, "skipped", jskipped);
+  iotjs_jval_set_property_jval(jrecords, "lastFrame", jlast);
+  jerry_release_value(jtimes);
+  jerry_release_value(jchanged);
+  jerry_release_value(jskipped);
+  jerry_release_value(jlast);
+  return jrecords;
+}
+#endif
+
 void init(jerry_value_t exports) {
+  animator.setTarget(DrawAnimation, NULL);
   iotjs_jval_set_method(exports, "enable", Enable);
   iotjs_jval_set_method(exports, "disable", Disable);
   iotjs_jval_set_method(exports, "getProfile", GetProfile);
@@ -110,6 +663,23 @@ void init(jerry_value_t exports) {
   iotjs_jval_set_method(exports, "render", Render);
   iotjs_jval_set_method(exports, "pixel", Pixel);
   iotjs_jval_set_method(exports, "fill", Fill);
+  iotjs_jval_set_method(exports, "colors", Colors);
+  iotjs_jval_set_method(exports, "gradient", Gradient);
+  iotjs_jval_set_method(exports, "scale", Scale);
+  iotjs_jval_set_method(exports, "blend", Blend);
+  iotjs_jval_set_method(exports, "rotate", Rotate);
+  iotjs_jval_set_method(exports, "shift", Shift);
+  iotjs_jval_set_method(exports, "setBrightness", SetBrightness);
+  iotjs_jval_set_method(exports, "animate", Animate);
+  iotjs_jval_set_method(exports, "stopAnimation", StopAnimation);
+  iotjs_jval_set_method(exports, "play", Play);
+  iotjs_jval_set_method(exports, "getStats", GetStats);
+  iotjs_jval_set_method(exports, "setLayer", SetLayer);
+  iotjs_jval_set_method(exports, "updateLayer", UpdateLayer);
+  iotjs_jval_set_method(exports, "removeLayer", RemoveLayer);
+#ifdef LIGHT_FAKE_DRIVER
+  iotjs_jval_set_method(exports, "getDriverRecords", GetDriverRecords);
+#endif
 }
 
 NODE_MODULE(light, init)
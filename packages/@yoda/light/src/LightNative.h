@@ -11,6 +11,7 @@ extern "C" {
 #include <iotjs_def.h>
 #include <iotjs_binding.h>
 #include <iotjs_objectwrap.h>
+#include <uv.h>
 
 typedef struct {
   iotjs_jobjectwrap_t jobjectwrap;
@@ -26,4 +27,15 @@ extern size_t iotjs_bufferwrap_length(iotjs_bufferwrap_t* bufferwrap);
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
+
+/**
+ * The completion of an animation, which is reported to its JS callback on
+ * the loop thread.
+ */
+typedef struct {
+  uv_async_t async;
+  jerry_value_t callback;
+  bool cancelled;
+} iotjs_light_animation_t;
+
 #endif // LIGHT_NATIVE_H
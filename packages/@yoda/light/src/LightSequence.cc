@@ -0,0 +1,78 @@
+#include "LightSequence.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+// the size of the header before the frames
+#define LIGHT_SEQUENCE_HEADER_SIZE 16
+
+static bool read_exact(FILE* fp, void* buf, size_t size) {
+  return fread(buf, 1, size, fp) == size;
+}
+
+int light_sequence_load(const char* path, int count, int bit,
+                        LightTimeline& timeline, LightSequenceInfo& info) {
+  FILE* fp = fopen(path, "rb");
+  if (fp == NULL)
+    return -errno;
+
+  char magic[4];
+  uint16_t leds;
+  uint8_t format;
+  uint8_t flags;
+  struct stat st;
+  int r = -EINVAL;
+  if (!read_exact(fp, magic, sizeof(magic)) ||
+      memcmp(magic, LIGHT_SEQUENCE_MAGIC, sizeof(magic)) != 0 ||
+      !read_exact(fp, &leds, sizeof(leds)) ||
+      !read_exact(fp, &format, sizeof(format)) ||
+      !read_exact(fp, &flags, sizeof(flags)) ||
+      !read_exact(fp, &info.frames, sizeof(info.frames)) ||
+      !read_exact(fp, &info.duration, sizeof(info.duration)))
+    goto done;
+  if (leds != count || format != bit || info.frames == 0) {
+    fprintf(stderr, "light: %s is compiled for %d leds of format %d\n", path,
+            leds, format);
+    goto done;
+  }
+  timeline.frame_size = (size_t)count * bit;
+  // the number of frames is untrusted, it must fit into the file before the
+  // frames are allocated.
+  if (fstat(fileno(fp), &st) != 0 || st.st_size < LIGHT_SEQUENCE_HEADER_SIZE ||
+      info.frames > (uint64_t)(st.st_size - LIGHT_SEQUENCE_HEADER_SIZE) /
+                         (sizeof(uint32_t) + timeline.frame_size)) {
+    fprintf(stderr, "light: %s is truncated\n", path);
+    goto done;
+  }
+
+  timeline.frames.resize(timeline.frame_size * info.frames);
+  timeline.times.clear();
+  timeline.easings.clear();
+  for (uint32_t i = 0; i < info.frames; i++) {
+    uint32_t time;
+    if (!read_exact(fp, &time, sizeof(time)) ||
+        !read_exact(fp, &timeline.frames[i * timeline.frame_size],
+                    timeline.frame_size) ||
+        (i > 0 && time < timeline.times.back()) || time > info.duration)
+      goto done;
+    timeline.times.push_back(time);
+    timeline.easings.push_back(LIGHT_EASING_STEP);
+  }
+  if (info.duration > timeline.times.back()) {
+    // holds the last frame until the end
+    vector<uint8_t> last(timeline.frames.end() - timeline.frame_size,
+                         timeline.frames.end());
+    timeline.frames.insert(timeline.frames.end(), last.begin(), last.end());
+    timeline.times.push_back(info.duration);
+    timeline.easings.push_back(LIGHT_EASING_STEP);
+  }
+  info.flags = flags;
+  timeline.repeat = (flags & LIGHT_SEQUENCE_LOOP) ? -1 : 0;
+  timeline.timed = true;
+  r = 0;
+
+done:
+  fclose(fp);
+  return r;
+}
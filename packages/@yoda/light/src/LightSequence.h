@@ -0,0 +1,42 @@
+#ifndef LIGHT_SEQUENCE_H
+#define LIGHT_SEQUENCE_H
+
+#include <stdint.h>
+#include "LightAnimator.h"
+
+/**
+ * The precompiled frame sequence of a light script, which is generated by
+ * `tools/light-compile`, all the numbers are little-endian:
+ *
+ *   magic     "YLS1"
+ *   u16       the number of LEDs
+ *   u8        the pixel format
+ *   u8        the flags, see LightSequenceFlags
+ *   u32       the number of frames
+ *   u32       the duration in ms
+ *   frames    u32 time in ms + the LEDs * format bytes, in time order
+ */
+#define LIGHT_SEQUENCE_MAGIC "YLS1"
+
+enum LightSequenceFlags {
+  // the sequence loops until it's stopped
+  LIGHT_SEQUENCE_LOOP = 1 << 0,
+  // the script calls back when the sequence ends
+  LIGHT_SEQUENCE_FINISHES = 1 << 1,
+};
+
+struct LightSequenceInfo {
+  uint32_t frames;
+  uint32_t duration;
+  int flags;
+};
+
+/**
+ * loads the sequence as a timed timeline, it's rejected unless its LEDs and
+ * format match the device.
+ * @return {int} 0 on success, or a negative errno.
+ */
+int light_sequence_load(const char* path, int count, int bit,
+                        LightTimeline& timeline, LightSequenceInfo& info);
+
+#endif // LIGHT_SEQUENCE_H
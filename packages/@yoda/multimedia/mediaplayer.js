@@ -57,6 +57,7 @@ var AudioManager = require('@yoda/audio').AudioManager
  * @fires module:@yoda/multimedia~MediaPlayer#playbackcomplete
  * @fires module:@yoda/multimedia~MediaPlayer#bufferingupdate
  * @fires module:@yoda/multimedia~MediaPlayer#seekcomplete
+ * @fires module:@yoda/multimedia~MediaPlayer#positionupdate
  * @fires module:@yoda/multimedia~MediaPlayer#error
  */
 function MediaPlayer (stream) {
@@ -83,6 +84,51 @@ MediaPlayer.status = {
   prepared: 'prepared'
 }
 
+/**
+ * Keep the given number of pre-initialized players for the stream, the new
+ * `MediaPlayer` instances of the stream take them without paying the setup.
+ *
+ * @memberof module:@yoda/multimedia~MediaPlayer
+ * @method warmup
+ * @param {number} [stream=STREAM_PLAYBACK] - the stream type of the players.
+ * @param {number} [count=1] - the number of idle players, at most 4.
+ * @returns {number} the number of idle players of the stream.
+ */
+MediaPlayer.warmup = function warmup (stream, count) {
+  var streamName = AudioManager.getStreamName(stream || AudioManager.STREAM_PLAYBACK)
+  return native.warmup(streamName, count === undefined ? 1 : count)
+}
+
+/**
+ * Start connecting and buffering the given resource in background, e.g. the
+ * next item of a playlist. The next `MediaPlayer` of the same stream which
+ * prepares the same uri adopts the prefetched player, at most 2 resources
+ * are kept and the oldest one is dropped.
+ *
+ * @memberof module:@yoda/multimedia~MediaPlayer
+ * @method prefetch
+ * @param {string} uri - the resource uri to prefetch.
+ * @param {number} [stream=STREAM_PLAYBACK] - the stream type of the player.
+ * @throws {Error} uri must be a valid string.
+ */
+MediaPlayer.prefetch = function prefetch (uri, stream) {
+  if (!uri) {
+    throw new Error('url must be a valid string')
+  }
+  var streamName = AudioManager.getStreamName(stream || AudioManager.STREAM_PLAYBACK)
+  return native.prefetch(streamName, uri)
+}
+
+/**
+ * Release all the idle and prefetched players.
+ *
+ * @memberof module:@yoda/multimedia~MediaPlayer
+ * @method clearPool
+ */
+MediaPlayer.clearPool = function clearPool () {
+  return native.clearPool()
+}
+
 /**
  * Initialize the media player, set callbacks
  * @private
@@ -95,6 +141,7 @@ MediaPlayer.prototype._initialize = function () {
   this._handle.onbufferingupdate = this.onbufferingupdate.bind(this)
   this._handle.onseekcomplete = this.onseekcomplete.bind(this)
   this._handle.onplayingstatus = this.onplayingstatus.bind(this)
+  this._handle.onpositionupdate = this.onpositionupdate.bind(this)
   this._handle.onblockpausemode = this.onblockpausemode.bind(this)
   this._handle.onerror = this.onerror.bind(this)
 }
@@ -104,8 +151,7 @@ MediaPlayer.prototype._initialize = function () {
  * @private
  */
 MediaPlayer.prototype.onprepared = function () {
-  var vol = AudioManager.getVolume(this._stream)
-  AudioManager.setVolume(this._stream, vol)
+  AudioManager.refreshVolume(this._stream)
   this.status = MediaPlayer.status.prepared
   /**
    * Prepared event, media resource is loaded
@@ -147,6 +193,16 @@ MediaPlayer.prototype.onplayingstatus = function (ext1, ext2) {
   // TODO: nothing to to now
 }
 
+MediaPlayer.prototype.onpositionupdate = function (position, duration) {
+  /**
+   * Fired by the position watcher when the position or duration is changed.
+   * @event module:@yoda/multimedia~MediaPlayer#positionupdate
+   * @param {number} position - the position in ms.
+   * @param {number} duration - the duration in ms.
+   */
+  this.emit('positionupdate', position, duration)
+}
+
 MediaPlayer.prototype.onblockpausemode = function (ext1, ext2) {
   this.blockpausemodeEnabled = ext1 === 0
   /**
@@ -250,6 +306,49 @@ MediaPlayer.prototype.seek = function (pos, callback) {
   })
 }
 
+/**
+ * Set the minimum interval between 2 deliveries of the given event, the event
+ * within the interval is postponed along with the events after it. Note that
+ * the pending `bufferingupdate` and `playingstatus` events are always coalesced
+ * to the latest value, and dropped once the playback is completed or failed.
+ * The interval of `positionupdate` is set by `watchPosition()`.
+ *
+ * @param {string} event - the event name, like `bufferingupdate`.
+ * @param {number} interval - the minimum interval in ms, 0 to disable.
+ * @throws {Error} unknown event name.
+ */
+MediaPlayer.prototype.setEventInterval = function (event, interval) {
+  if (typeof interval !== 'number' || interval < 0) {
+    throw new TypeError('interval must be a non-negative number')
+  }
+  if (event === 'positionupdate') {
+    throw new Error('the interval of positionupdate is set by watchPosition()')
+  }
+  if (!this._handle.setEventInterval(event, interval)) {
+    throw new Error(`unknown event name ${event}`)
+  }
+}
+
+/**
+ * Watch the position and duration of the playback, they are checked natively
+ * in the given interval and emitted by the `positionupdate` event only if
+ * changed, instead of polling the `position` and `duration` properties.
+ *
+ * @param {number} [interval=1000] - the interval to check in ms.
+ * @param {number} [threshold=0] - the minimum position change in ms to emit.
+ * @fires module:@yoda/multimedia~MediaPlayer#positionupdate
+ */
+MediaPlayer.prototype.watchPosition = function (interval, threshold) {
+  return this._handle.watchPosition(interval || 1000, threshold || 0)
+}
+
+/**
+ * Stop watching the position.
+ */
+MediaPlayer.prototype.unwatchPosition = function () {
+  return this._handle.unwatchPosition()
+}
+
 /**
  * get the  volume
  */
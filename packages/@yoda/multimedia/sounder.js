@@ -63,26 +63,34 @@ function _playSound (filename, stream, holdconnection, callback) {
   }
   var streamType = stream || AudioManager.STREAM_SYSTEM
   var streamName = AudioManager.getStreamName(streamType)
-  native.prepare(filename, streamName, holdconnection, (err) => {
-    if (err) {
-      return callback(err)
-    }
-    if (!holdconnection) {
-      // FIXME(Yorkie): is this exactly needs?
-      var vol = AudioManager.getVolume(streamType)
-      AudioManager.setVolume(streamType, vol)
-    }
+  var refresh = null
+  if (!holdconnection) {
+    // FIXME(Yorkie): is this exactly needs?
+    // the volume is restored on the new connection between the prepare and
+    // the start.
+    refresh = () => AudioManager.refreshVolume(streamType)
+  }
 
-    // start playing the actual playback
-    native.start((err) => {
-      if (err) {
-        return callback(err)
-      }
-      return callback()
-    })
-  })
+  // prepare and start the playback within a single native work
+  native.play(filename, streamName, holdconnection, refresh, callback)
 }
 
+/**
+ * @typedef PlayStats
+ * @memberof module:@yoda/multimedia.Sounder
+ * @property {number} queue - the ms waited in the threadpool queue.
+ * @property {number} prepare - the ms spent on preparing the player.
+ * @property {number} start - the ms spent on starting the playback.
+ * @property {number} total - the ms from `play()` to the callback.
+ */
+
+/**
+ * @callback playCallback
+ * @memberof module:@yoda/multimedia.Sounder
+ * @param {Error} err - the error if something went wrong.
+ * @param {module:@yoda/multimedia.Sounder.PlayStats} stats - the stage durations.
+ */
+
 /**
  * Play the given WAV file.
  * @function play
@@ -90,7 +98,7 @@ function _playSound (filename, stream, holdconnection, callback) {
  * @param {string} filename - specify the file to be played.
  * @param {number} [stream=STREAM_PLAYBACK] - the stream type of the player.
  * @param {boolean}  [holdconnection=false] - whether the current player connection should be hold.
- * @param {callback} callback - playback callback
+ * @param {module:@yoda/multimedia.Sounder~playCallback} callback - playback callback
  * @throw {Error} player is not ready, please use `ready` event.
  */
 Sounder.play = function play (filename, stream, holdconnection, callback) {
@@ -1,76 +1,434 @@
 #include "MediaPlayer.h"
 
+static const char* multimedia_event_callbacks[MULTIMEDIA_EVENT_MAX] = {
+  "onprepared",      "onplaybackcomplete", "onbufferingupdate",
+  "onseekcomplete",  "onplayingstatus",    "onblockpausemode",
+  "onerror",         "onpositionupdate",
+};
+
+MultimediaListener::MultimediaListener(iotjs_player_t* player_) {
+  prepared = false;
+  closed = false;
+  player = player_;
+  for (int i = 0; i < MULTIMEDIA_EVENT_MAX; i++) {
+    intervals[i] = 0;
+    delivered_at[i] = 0;
+    callbacks[i] = 0;
+    callback_cached[i] = false;
+  }
+  uv_mutex_init(&mutex);
+  notify_handle.data = (void*)this;
+  uv_async_init(uv_default_loop(), &notify_handle,
+                MultimediaListener::DoNotify);
+  notify_timer.data = (void*)this;
+  uv_timer_init(uv_default_loop(), &notify_timer);
+  position_timer.data = (void*)this;
+  uv_timer_init(uv_default_loop(), &position_timer);
+  position_threshold = 0;
+  last_position = -1;
+  last_duration = -1;
+}
+
+MultimediaListener::~MultimediaListener() {
+  prepared = false;
+  player = NULL;
+  uv_mutex_destroy(&mutex);
+}
+
+int MultimediaListener::getEventSlot(int type) {
+  switch (type) {
+    case MEDIA_PREPARED:
+      return MULTIMEDIA_EVENT_PREPARED;
+    case MEDIA_PLAYBACK_COMPLETE:
+      return MULTIMEDIA_EVENT_PLAYBACK_COMPLETE;
+    case MEDIA_BUFFERING_UPDATE:
+      return MULTIMEDIA_EVENT_BUFFERING_UPDATE;
+    case MEDIA_SEEK_COMPLETE:
+      return MULTIMEDIA_EVENT_SEEK_COMPLETE;
+    case MEDIA_PLAYING_STATUS:
+      return MULTIMEDIA_EVENT_PLAYING_STATUS;
+    case MEDIA_BLOCK_PAUSE_MODE:
+      return MULTIMEDIA_EVENT_BLOCK_PAUSE_MODE;
+    case MEDIA_ERROR:
+      return MULTIMEDIA_EVENT_ERROR;
+    default:
+      return -1;
+  }
+}
+
 // cppcheck-suppress unusedFunction
 void MultimediaListener::notify(int type, int ext1, int ext2, int from) {
-  printf("got event %d thread %d\n", type, from);
   if (type == MEDIA_PREPARED) {
     this->prepared = true;
   }
-  if (this->prepared || type == MEDIA_ERROR) {
-    // only if prepared or event is MEDIA_ERROR, enables the notify
-    uv_async_t* async_handle = new uv_async_t;
-    iotjs_player_event_t* event = new iotjs_player_event_t;
-    event->player = this->getPlayer();
-    event->type = type;
-    event->ext1 = ext1;
-    event->ext2 = ext2;
-    event->from = from;
-    async_handle->data = (void*)event;
-    uv_async_init(uv_default_loop(), async_handle,
-                  MultimediaListener::DoNotify);
-    uv_async_send(async_handle);
+  // only if prepared or event is MEDIA_ERROR, enables the notify
+  if (!this->prepared && type != MEDIA_ERROR) {
+    return;
+  }
+  int slot = getEventSlot(type);
+  if (slot < 0) {
+    fprintf(stdout, "unhandled media event type: %d\n", type);
+    return;
+  }
+
+  iotjs_player_event_t event;
+  event.player = this->getPlayer();
+  event.type = type;
+  event.ext1 = ext1;
+  event.ext2 = ext2;
+  event.from = from;
+
+  uv_mutex_lock(&mutex);
+  if (closed) {
+    uv_mutex_unlock(&mutex);
+    return;
+  }
+  bool coalesced = false;
+  if (slot == MULTIMEDIA_EVENT_BUFFERING_UPDATE ||
+      slot == MULTIMEDIA_EVENT_PLAYING_STATUS) {
+    // status events only carry the latest value, so just overwrite the
+    // pending one if it's not delivered yet.
+    for (size_t i = 0; i < events.size(); i++) {
+      if (events[i].type == type) {
+        events[i] = event;
+        coalesced = true;
+        break;
+      }
+    }
+  }
+  if (!coalesced) {
+    events.push_back(event);
+  }
+  uv_mutex_unlock(&mutex);
+  if (!coalesced) {
+    uv_async_send(&notify_handle);
   }
 }
 
 void MultimediaListener::DoNotify(uv_async_t* handle) {
-  iotjs_player_event_t* event = (iotjs_player_event_t*)handle->data;
-  iotjs_player_t* player_wrap = event->player;
-  IOTJS_VALIDATED_STRUCT_METHOD(iotjs_player_t, player_wrap);
+  MultimediaListener* listener = (MultimediaListener*)handle->data;
+  listener->flush();
+}
 
-  jerry_value_t jthis = iotjs_jobjectwrap_jobject(&_this->jobjectwrap);
-  jerry_value_t notifyFn;
-  fprintf(stdout, "try to notify the event type %d\n", event->type);
-
-  if (event->type == MEDIA_PREPARED) {
-    notifyFn = iotjs_jval_get_property(jthis, "onprepared");
-  } else if (event->type == MEDIA_PLAYBACK_COMPLETE) {
-    notifyFn = iotjs_jval_get_property(jthis, "onplaybackcomplete");
-  } else if (event->type == MEDIA_BUFFERING_UPDATE) {
-    notifyFn = iotjs_jval_get_property(jthis, "onbufferingupdate");
-  } else if (event->type == MEDIA_SEEK_COMPLETE) {
-    notifyFn = iotjs_jval_get_property(jthis, "onseekcomplete");
-  } else if (event->type == MEDIA_PLAYING_STATUS) {
-    notifyFn = iotjs_jval_get_property(jthis, "onplayingstatus");
-  } else if (event->type == MEDIA_BLOCK_PAUSE_MODE) {
-    notifyFn = iotjs_jval_get_property(jthis, "onblockpausemode");
-  } else if (event->type == MEDIA_ERROR) {
+void MultimediaListener::OnNotifyTimer(uv_timer_t* handle) {
+  MultimediaListener* listener = (MultimediaListener*)handle->data;
+  listener->flush();
+}
+
+void MultimediaListener::flush() {
+  std::deque<iotjs_player_event_t> ready;
+  uint64_t now = uv_now(uv_default_loop());
+  uint64_t wait = 0;
+
+  uv_mutex_lock(&mutex);
+  // the status events before a terminal one are stale once it's queued, so
+  // they're dropped instead of holding the terminal event back.
+  std::deque<iotjs_player_event_t>::iterator it = events.end();
+  while (it != events.begin()) {
+    --it;
+    if (it->type == MEDIA_PLAYBACK_COMPLETE || it->type == MEDIA_ERROR) {
+      std::deque<iotjs_player_event_t>::iterator end = it;
+      for (it = events.begin(); it != end;) {
+        if (it->type == MEDIA_BUFFERING_UPDATE ||
+            it->type == MEDIA_PLAYING_STATUS) {
+          it = events.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      break;
+    }
+  }
+  // the events are delivered in order, so stop at the first one which is
+  // kept pending until the minimum interval of its type is elapsed.
+  while (!events.empty()) {
+    iotjs_player_event_t& event = events.front();
+    int slot = getEventSlot(event.type);
+    uint64_t next = delivered_at[slot] + intervals[slot];
+    if (intervals[slot] > 0 && delivered_at[slot] > 0 && now < next) {
+      wait = next - now;
+      break;
+    }
+    delivered_at[slot] = now;
+    ready.push_back(event);
+    events.pop_front();
+  }
+  uv_mutex_unlock(&mutex);
+
+  for (size_t i = 0; i < ready.size(); i++) {
+    if (closed)
+      break;
+    deliver(&ready[i]);
+  }
+  if (wait > 0 && !closed) {
+    uv_timer_start(&notify_timer, MultimediaListener::OnNotifyTimer, wait, 0);
+  }
+}
+
+void MultimediaListener::deliver(iotjs_player_event_t* event) {
+  int slot = getEventSlot(event->type);
+  if (event->type == MEDIA_ERROR) {
     fprintf(stderr, "[jsruntime] player occurrs an error %d %d %d", event->ext1,
             event->ext2, event->from);
-    notifyFn = iotjs_jval_get_property(jthis, "onerror");
-  } else {
-    fprintf(stdout, "unhandled media event type: %d\n", event->type);
-    goto clean;
   }
-  if (!jerry_value_is_function(notifyFn)) {
-    fprintf(stderr, "no function is registered\n");
-    goto clean;
+  jerry_value_t notifyFn;
+  if (!getCallback(slot, &notifyFn)) {
+    return;
   }
 
   iotjs_jargs_t jargs = iotjs_jargs_create(2);
   iotjs_jargs_append_number(&jargs, event->ext1);
   iotjs_jargs_append_number(&jargs, event->ext2);
+  iotjs_make_callback(notifyFn, jerry_create_undefined(), &jargs);
+  iotjs_jargs_destroy(&jargs);
+}
 
+bool MultimediaListener::getCallback(int slot, jerry_value_t* fn) {
+  if (!callback_cached[slot]) {
+    // the callbacks are assigned once by the JavaScript player, so cache them
+    // at the first time to avoid looking up the property on every event.
+    iotjs_player_t* player_wrap = this->getPlayer();
+    IOTJS_VALIDATED_STRUCT_METHOD(iotjs_player_t, player_wrap);
+    jerry_value_t jthis = iotjs_jobjectwrap_jobject(&_this->jobjectwrap);
+    jerry_value_t notifyFn =
+        iotjs_jval_get_property(jthis, multimedia_event_callbacks[slot]);
+    if (!jerry_value_is_function(notifyFn)) {
+      fprintf(stderr, "no function is registered for %s\n",
+              multimedia_event_callbacks[slot]);
+      jerry_release_value(notifyFn);
+      return false;
+    }
+    callbacks[slot] = notifyFn;
+    callback_cached[slot] = true;
+  }
+  *fn = callbacks[slot];
+  return true;
+}
+
+void MultimediaListener::watchPosition(int interval, int threshold) {
+  if (closed)
+    return;
+  position_threshold = threshold > 0 ? threshold : 0;
+  last_position = -1;
+  last_duration = -1;
+  uv_timer_start(&position_timer, MultimediaListener::OnPositionTimer,
+                 interval, interval);
+}
+
+void MultimediaListener::unwatchPosition() {
+  uv_timer_stop(&position_timer);
+}
+
+void MultimediaListener::OnPositionTimer(uv_timer_t* handle) {
+  MultimediaListener* listener = (MultimediaListener*)handle->data;
+  iotjs_player_t* player_wrap = listener->getPlayer();
+  IOTJS_VALIDATED_STRUCT_METHOD(iotjs_player_t, player_wrap);
+
+  if (listener->closed || _this->handle == NULL || !listener->isPrepared())
+    return;
+
+  int position = -1;
+  int duration = -1;
+  _this->handle->getCurrentPosition(&position);
+  _this->handle->getDuration(&duration);
+  int delta = position - listener->last_position;
+  if (delta < 0)
+    delta = -delta;
+  if (duration == listener->last_duration &&
+      (position == listener->last_position ||
+       delta < listener->position_threshold)) {
+    return;
+  }
+  listener->last_position = position;
+  listener->last_duration = duration;
+
+  jerry_value_t notifyFn;
+  if (!listener->getCallback(MULTIMEDIA_EVENT_POSITION_UPDATE, &notifyFn))
+    return;
+  iotjs_jargs_t jargs = iotjs_jargs_create(2);
+  iotjs_jargs_append_number(&jargs, position);
+  iotjs_jargs_append_number(&jargs, duration);
   iotjs_make_callback(notifyFn, jerry_create_undefined(), &jargs);
   iotjs_jargs_destroy(&jargs);
-  jerry_release_value(notifyFn);
+}
 
-clean:
-  delete event;
-  uv_close((uv_handle_t*)handle, MultimediaListener::AfterNotify);
+bool MultimediaListener::setEventInterval(const char* name, int ms) {
+  // the position updates are paced by watchPosition() instead
+  for (int i = 0; i < MULTIMEDIA_EVENT_POSITION_UPDATE; i++) {
+    // skip the "on" prefix of the callback name
+    if (strcmp(multimedia_event_callbacks[i] + 2, name) == 0) {
+      intervals[i] = ms > 0 ? ms : 0;
+      return true;
+    }
+  }
+  return false;
 }
 
-void MultimediaListener::AfterNotify(uv_handle_t* handle) {
-  delete handle;
+void MultimediaListener::close() {
+  uv_mutex_lock(&mutex);
+  if (closed) {
+    uv_mutex_unlock(&mutex);
+    return;
+  }
+  closed = true;
+  events.clear();
+  uv_mutex_unlock(&mutex);
+
+  uv_timer_stop(&notify_timer);
+  uv_timer_stop(&position_timer);
+  uv_close((uv_handle_t*)&notify_handle, MultimediaListener::AfterClose);
+  uv_close((uv_handle_t*)&notify_timer, MultimediaListener::AfterClose);
+  uv_close((uv_handle_t*)&position_timer, MultimediaListener::AfterClose);
+  for (int i = 0; i < MULTIMEDIA_EVENT_MAX; i++) {
+    if (callback_cached[i]) {
+      jerry_release_value(callbacks[i]);
+      callback_cached[i] = false;
+    }
+  }
+}
+
+void MultimediaListener::AfterClose(uv_handle_t* handle) {
+  // the handles are owned by the listener, which is deleted with the player.
+  handle->data = NULL;
+}
+
+MultimediaPrefetchListener::MultimediaPrefetchListener() {
+  target = NULL;
+  prepared = false;
+  failed = false;
+  uv_mutex_init(&mutex);
+}
+
+MultimediaPrefetchListener::~MultimediaPrefetchListener() {
+  target = NULL;
+  uv_mutex_destroy(&mutex);
+}
+
+// cppcheck-suppress unusedFunction
+void MultimediaPrefetchListener::notify(int type, int ext1, int ext2,
+                                        int from) {
+  uv_mutex_lock(&mutex);
+  if (target != NULL) {
+    target->notify(type, ext1, ext2, from);
+  } else if (type == MEDIA_PREPARED) {
+    prepared = true;
+  } else if (type == MEDIA_ERROR) {
+    failed = true;
+  }
+  uv_mutex_unlock(&mutex);
+}
+
+bool MultimediaPrefetchListener::adopt(MultimediaListener* target_) {
+  uv_mutex_lock(&mutex);
+  if (failed) {
+    uv_mutex_unlock(&mutex);
+    return false;
+  }
+  target = target_;
+  if (prepared) {
+    // replay the prepared event which is received before adoption.
+    target->notify(MEDIA_PREPARED, 0, 0, 0);
+  }
+  uv_mutex_unlock(&mutex);
+  return true;
+}
+
+#define MULTIMEDIA_POOL_MAX_IDLE 4
+#define MULTIMEDIA_POOL_MAX_PREFETCH 2
+
+std::map<std::string, std::deque<MediaPlayer*> > MultimediaPlayerPool::idle;
+std::deque<std::pair<std::string, MultimediaPlayerPool::PrefetchEntry> >
+    MultimediaPlayerPool::prefetched;
+
+MediaPlayer* MultimediaPlayerPool::acquire(const char* tag) {
+  std::deque<MediaPlayer*>& players = idle[tag];
+  if (!players.empty()) {
+    MediaPlayer* handle = players.front();
+    players.pop_front();
+    return handle;
+  }
+  MediaPlayer* handle = new MediaPlayer(tag[0] ? tag : NULL, 5 /** s */, true);
+  handle->enableCacheMode(true);
+  return handle;
+}
+
+void MultimediaPlayerPool::release(const char* tag, MediaPlayer* handle) {
+  std::deque<MediaPlayer*>& players = idle[tag];
+  if (players.size() >= MULTIMEDIA_POOL_MAX_IDLE) {
+    delete handle;
+    return;
+  }
+  players.push_back(handle);
+}
+
+int MultimediaPlayerPool::warmup(const char* tag, int count) {
+  if (count > MULTIMEDIA_POOL_MAX_IDLE)
+    count = MULTIMEDIA_POOL_MAX_IDLE;
+  std::deque<MediaPlayer*>& players = idle[tag];
+  while ((int)players.size() < count) {
+    MediaPlayer* handle =
+        new MediaPlayer(tag[0] ? tag : NULL, 5 /** s */, true);
+    handle->enableCacheMode(true);
+    players.push_back(handle);
+  }
+  return players.size();
+}
+
+bool MultimediaPlayerPool::prefetch(const char* tag, const char* url) {
+  for (size_t i = 0; i < prefetched.size(); i++) {
+    if (prefetched[i].first == url && prefetched[i].second.tag == tag)
+      return true;
+  }
+  PrefetchEntry entry;
+  entry.tag = tag;
+  entry.handle = acquire(tag);
+  entry.listener = new MultimediaPrefetchListener();
+  entry.handle->setListener(entry.listener);
+  entry.handle->setDataSource(url);
+  entry.handle->prepareAsync();
+  prefetched.push_back(std::make_pair(std::string(url), entry));
+
+  while (prefetched.size() > MULTIMEDIA_POOL_MAX_PREFETCH) {
+    evict(&prefetched.front().second);
+    prefetched.pop_front();
+  }
+  return true;
+}
+
+bool MultimediaPlayerPool::take(const char* tag, const char* url,
+                                PrefetchEntry* entry) {
+  std::deque<std::pair<std::string, PrefetchEntry> >::iterator it;
+  for (it = prefetched.begin(); it != prefetched.end(); ++it) {
+    if (it->first == url && it->second.tag == tag) {
+      *entry = it->second;
+      prefetched.erase(it);
+      return true;
+    }
+  }
+  return false;
+}
+
+void MultimediaPlayerPool::evict(PrefetchEntry* entry) {
+  entry->handle->stop();
+  delete entry->handle;
+  delete entry->listener;
+  entry->handle = NULL;
+  entry->listener = NULL;
+}
+
+void MultimediaPlayerPool::clear() {
+  for (size_t i = 0; i < prefetched.size(); i++) {
+    evict(&prefetched[i].second);
+  }
+  prefetched.clear();
+
+  std::map<std::string, std::deque<MediaPlayer*> >::iterator it;
+  for (it = idle.begin(); it != idle.end(); ++it) {
+    for (size_t i = 0; i < it->second.size(); i++) {
+      delete it->second[i];
+    }
+  }
+  idle.clear();
 }
 
 bool MultimediaListener::isPrepared() {
@@ -103,6 +461,8 @@ static iotjs_player_t* iotjs_player_create(jerry_value_t jplayer) {
                                &this_module_native_info);
   _this->handle = NULL;
   _this->listener = new MultimediaListener(player_wrap);
+  _this->prefetch_listener = NULL;
+  _this->tag[0] = '\0';
   _this->id = (global_id++);
 
   _this->close_handle.data = (void*)player_wrap;
@@ -112,12 +472,23 @@ static iotjs_player_t* iotjs_player_create(jerry_value_t jplayer) {
 
 static void iotjs_player_destroy(iotjs_player_t* player_wrap) {
   IOTJS_VALIDATED_STRUCT_DESTRUCTOR(iotjs_player_t, player_wrap);
-  delete _this->handle;
+  if (_this->handle != NULL) {
+    // the player is detached and reset to be recycled by the next one
+    _this->handle->setListener(NULL);
+    _this->handle->stop();
+    _this->handle->reset();
+    MultimediaPlayerPool::release(_this->tag, _this->handle);
+  }
+  delete _this->prefetch_listener;
+  delete _this->listener;
   iotjs_jobjectwrap_destroy(&_this->jobjectwrap);
   IOTJS_RELEASE(player_wrap);
 }
 
 static void iotjs_player_onclose(uv_async_t* handle) {
+  iotjs_player_t* player_wrap = (iotjs_player_t*)handle->data;
+  IOTJS_VALIDATED_STRUCT_METHOD(iotjs_player_t, player_wrap);
+  _this->listener->close();
   uv_close((uv_handle_t*)handle, iotjs_player_async_onclose);
 }
 
@@ -129,18 +500,14 @@ JS_FUNCTION(Player) {
   IOTJS_VALIDATED_STRUCT_METHOD(iotjs_player_t, player_wrap);
 
   jerry_value_t jtag = jargv[0];
-  if (!jerry_value_is_string(jtag)) {
-    _this->handle = new MediaPlayer(NULL, 5 /** s */, true);
-    _this->handle->enableCacheMode(true);
-  } else {
+  if (jerry_value_is_string(jtag)) {
     jerry_size_t size = jerry_get_string_size(jtag);
-    char* tag = iotjs_buffer_allocate(size + 1);
-    jerry_string_to_char_buffer(jtag, (jerry_char_t*)tag, size);
-    tag[size] = '\0';
-    _this->handle = new MediaPlayer(tag, 5 /** s */, true);
-    _this->handle->enableCacheMode(true);
-    iotjs_buffer_release(tag);
+    if (size >= MULTIMEDIA_TAG_SIZE)
+      return JS_CREATE_ERROR(COMMON, "tag is too long");
+    jerry_string_to_char_buffer(jtag, (jerry_char_t*)_this->tag, size);
+    _this->tag[size] = '\0';
   }
+  _this->handle = MultimediaPlayerPool::acquire(_this->tag);
 
   if (_this->listener == NULL)
     return JS_CREATE_ERROR(COMMON, "listener is not initialized");
@@ -164,6 +531,24 @@ JS_FUNCTION(Prepare) {
   jerry_string_to_char_buffer(jsource, (jerry_char_t*)source, srclen);
   source[srclen] = '\0';
 
+  MultimediaPlayerPool::PrefetchEntry entry;
+  if (_this->prefetch_listener == NULL && !_this->listener->isPrepared() &&
+      MultimediaPlayerPool::take(_this->tag, source, &entry)) {
+    if (entry.listener->adopt(_this->listener)) {
+      // the prefetched player replaces the one acquired in constructor, which
+      // is never prepared and goes back to the pool.
+      _this->handle->setListener(NULL);
+      MultimediaPlayerPool::release(_this->tag, _this->handle);
+      _this->handle = entry.handle;
+      _this->prefetch_listener = entry.listener;
+      return jerry_create_undefined();
+    }
+    fprintf(stderr, "prefetching %s failed, prepare again\n", source);
+    entry.handle->stop();
+    delete entry.handle;
+    delete entry.listener;
+  }
+
   _this->handle->setDataSource(source);
   _this->handle->prepareAsync();
   return jerry_create_undefined();
@@ -364,9 +749,89 @@ JS_FUNCTION(SessionIdSetter) {
   }
 }
 
+JS_FUNCTION(SetEventInterval) {
+  JS_DECLARE_THIS_PTR(player, player);
+  IOTJS_VALIDATED_STRUCT_METHOD(iotjs_player_t, player);
+
+  jerry_value_t jname = jargv[0];
+  if (!jerry_value_is_string(jname))
+    return JS_CREATE_ERROR(COMMON, "event name must be a string");
+
+  jerry_size_t size = jerry_get_string_size(jname);
+  char name[size + 1];
+  jerry_string_to_char_buffer(jname, (jerry_char_t*)name, size);
+  name[size] = '\0';
+
+  int ms = JS_GET_ARG(1, number);
+  return jerry_create_boolean(_this->listener->setEventInterval(name, ms));
+}
+
+JS_FUNCTION(WatchPosition) {
+  JS_DECLARE_THIS_PTR(player, player);
+  IOTJS_VALIDATED_STRUCT_METHOD(iotjs_player_t, player);
+
+  int interval = JS_GET_ARG(0, number);
+  int threshold = JS_GET_ARG(1, number);
+  if (interval <= 0)
+    return JS_CREATE_ERROR(COMMON, "interval must be greater than 0");
+  _this->listener->watchPosition(interval, threshold);
+  return jerry_create_undefined();
+}
+
+JS_FUNCTION(UnwatchPosition) {
+  JS_DECLARE_THIS_PTR(player, player);
+  IOTJS_VALIDATED_STRUCT_METHOD(iotjs_player_t, player);
+
+  _this->listener->unwatchPosition();
+  return jerry_create_undefined();
+}
+
+static bool get_string_arg(jerry_value_t jval, char* buf, size_t len) {
+  if (!jerry_value_is_string(jval))
+    return false;
+  jerry_size_t size = jerry_get_string_size(jval);
+  if (size >= len)
+    return false;
+  jerry_string_to_char_buffer(jval, (jerry_char_t*)buf, size);
+  buf[size] = '\0';
+  return true;
+}
+
+JS_FUNCTION(Warmup) {
+  char tag[MULTIMEDIA_TAG_SIZE];
+  if (!get_string_arg(jargv[0], tag, sizeof(tag)))
+    return JS_CREATE_ERROR(COMMON, "tag must be a string");
+  int count = JS_GET_ARG(1, number);
+  return jerry_create_number(MultimediaPlayerPool::warmup(tag, count));
+}
+
+JS_FUNCTION(Prefetch) {
+  char tag[MULTIMEDIA_TAG_SIZE];
+  if (!get_string_arg(jargv[0], tag, sizeof(tag)))
+    return JS_CREATE_ERROR(COMMON, "tag must be a string");
+
+  jerry_value_t jsource = jargv[1];
+  if (!jerry_value_is_string(jsource))
+    return JS_CREATE_ERROR(COMMON, "source must be a string");
+  jerry_size_t srclen = jerry_get_string_size(jsource);
+  char source[srclen + 1];
+  jerry_string_to_char_buffer(jsource, (jerry_char_t*)source, srclen);
+  source[srclen] = '\0';
+
+  return jerry_create_boolean(MultimediaPlayerPool::prefetch(tag, source));
+}
+
+JS_FUNCTION(ClearPool) {
+  MultimediaPlayerPool::clear();
+  return jerry_create_undefined();
+}
+
 void init(jerry_value_t exports) {
   jerry_value_t jconstructor = jerry_create_external_function(Player);
   iotjs_jval_set_property_jval(exports, "Player", jconstructor);
+  iotjs_jval_set_method(exports, "warmup", Warmup);
+  iotjs_jval_set_method(exports, "prefetch", Prefetch);
+  iotjs_jval_set_method(exports, "clearPool", ClearPool);
 
   jerry_value_t proto = jerry_create_object();
   iotjs_jval_set_method(proto, "prepare", Prepare);
@@ -377,6 +842,9 @@ void init(jerry_value_t exports) {
   iotjs_jval_set_method(proto, "seek", Seek);
   iotjs_jval_set_method(proto, "reset", Reset);
   iotjs_jval_set_method(proto, "setTempoDelta", SetTempoDelta);
+  iotjs_jval_set_method(proto, "setEventInterval", SetEventInterval);
+  iotjs_jval_set_method(proto, "watchPosition", WatchPosition);
+  iotjs_jval_set_method(proto, "unwatchPosition", UnwatchPosition);
 
   // the following methods are for getters and setters internally
   iotjs_jval_set_method(proto, "idGetter", IdGetter);
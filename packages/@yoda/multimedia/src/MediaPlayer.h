@@ -3,6 +3,9 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <deque>
+#include <map>
+#include <string>
 
 #ifdef __cplusplus
 extern "C" {
@@ -17,12 +20,19 @@ extern "C" {
 
 class MultimediaListener;
 
+class MultimediaPrefetchListener;
+
+#define MULTIMEDIA_TAG_SIZE 32
+
 typedef struct {
   iotjs_jobjectwrap_t jobjectwrap;
   MediaPlayer* handle;
   MultimediaListener* listener;
+  // the listener of the adopted prefetched handle, forwards to `listener`.
+  MultimediaPrefetchListener* prefetch_listener;
   uv_async_t close_handle;
   uint32_t id;
+  char tag[MULTIMEDIA_TAG_SIZE];
 } IOTJS_VALIDATED_STRUCT(iotjs_player_t);
 
 typedef struct {
@@ -33,19 +43,30 @@ typedef struct {
   int from;
 } iotjs_player_event_t;
 
+/**
+ * The indices of the events delivered to JavaScript, each one is mapped to the
+ * callback property `on${name}` of the native player object.
+ */
+enum MultimediaEventSlot {
+  MULTIMEDIA_EVENT_PREPARED = 0,
+  MULTIMEDIA_EVENT_PLAYBACK_COMPLETE,
+  MULTIMEDIA_EVENT_BUFFERING_UPDATE,
+  MULTIMEDIA_EVENT_SEEK_COMPLETE,
+  MULTIMEDIA_EVENT_PLAYING_STATUS,
+  MULTIMEDIA_EVENT_BLOCK_PAUSE_MODE,
+  MULTIMEDIA_EVENT_ERROR,
+  // emitted by the position watcher, not from the player
+  MULTIMEDIA_EVENT_POSITION_UPDATE,
+  MULTIMEDIA_EVENT_MAX,
+};
+
 /**
  * @class MultimediaListener
  */
 class MultimediaListener : public MediaPlayerListener {
  public:
-  explicit MultimediaListener(iotjs_player_t* player_) {
-    prepared = false;
-    player = player_;
-  };
-  ~MultimediaListener() {
-    prepared = false;
-    player = NULL;
-  };
+  explicit MultimediaListener(iotjs_player_t* player_);
+  ~MultimediaListener();
 
  public:
   /**
@@ -57,7 +78,9 @@ class MultimediaListener : public MediaPlayerListener {
    */
   void notify(int msg, int ext1, int ext2, int from);
   static void DoNotify(uv_async_t* handle);
-  static void AfterNotify(uv_handle_t* handle);
+  static void OnNotifyTimer(uv_timer_t* handle);
+  static void OnPositionTimer(uv_timer_t* handle);
+  static void AfterClose(uv_handle_t* handle);
   /**
    * @method isPrepared
    * @return {Boolean} if the player is prepared
@@ -68,10 +91,132 @@ class MultimediaListener : public MediaPlayerListener {
    * @return {iotjs_player_t*}
    */
   iotjs_player_t* getPlayer();
+  /**
+   * @method setEventInterval
+   * @param {String} name - the event name, like "bufferingupdate".
+   * @param {Integer} ms - the minimum interval between 2 deliveries.
+   * @return {Boolean} if the event name is valid, "positionupdate" is not.
+   */
+  bool setEventInterval(const char* name, int ms);
+  /**
+   * @method watchPosition
+   * @param {Integer} interval - the interval in ms to check the position.
+   * @param {Integer} threshold - only emits if the position is changed more
+   *                              than it in ms, or the duration is changed.
+   */
+  void watchPosition(int interval, int threshold);
+  /**
+   * @method unwatchPosition
+   */
+  void unwatchPosition();
+  /**
+   * @method close
+   * stops delivering events and closes the handles, it must be called from
+   * the main thread.
+   */
+  void close();
+
+ private:
+  static int getEventSlot(int type);
+  void flush();
+  void deliver(iotjs_player_event_t* event);
+  bool getCallback(int slot, jerry_value_t* fn);
 
  private:
   bool prepared;
+  bool closed;
   iotjs_player_t* player;
+  uv_mutex_t mutex;
+  uv_async_t notify_handle;
+  uv_timer_t notify_timer;
+  uv_timer_t position_timer;
+  int position_threshold;
+  int last_position;
+  int last_duration;
+  // the pending events, guarded by `mutex`
+  std::deque<iotjs_player_event_t> events;
+  // the following are only accessed from the main thread
+  uint64_t intervals[MULTIMEDIA_EVENT_MAX];
+  uint64_t delivered_at[MULTIMEDIA_EVENT_MAX];
+  jerry_value_t callbacks[MULTIMEDIA_EVENT_MAX];
+  bool callback_cached[MULTIMEDIA_EVENT_MAX];
+};
+
+/**
+ * @class MultimediaPrefetchListener
+ * The listener of a prefetched player which has no JavaScript owner yet, it
+ * records the state until adopted and forwards the events afterwards.
+ */
+class MultimediaPrefetchListener : public MediaPlayerListener {
+ public:
+  MultimediaPrefetchListener();
+  ~MultimediaPrefetchListener();
+
+ public:
+  void notify(int msg, int ext1, int ext2, int from);
+  /**
+   * @method adopt
+   * @param {MultimediaListener*} target - the listener to forward to.
+   * @return {Boolean} false if the prefetching has failed.
+   */
+  bool adopt(MultimediaListener* target);
+
+ private:
+  uv_mutex_t mutex;
+  MultimediaListener* target;
+  bool prepared;
+  bool failed;
+};
+
+/**
+ * @class MultimediaPlayerPool
+ * Keeps the idle players per stream tag and the prefetched players per url,
+ * it's only accessed from the main thread.
+ */
+class MultimediaPlayerPool {
+ public:
+  struct PrefetchEntry {
+    std::string tag;
+    MediaPlayer* handle;
+    MultimediaPrefetchListener* listener;
+  };
+
+ public:
+  /**
+   * @method acquire
+   * @param {String} tag - the stream tag.
+   * @return {MediaPlayer*} an idle player or a newly created one.
+   */
+  static MediaPlayer* acquire(const char* tag);
+  /**
+   * @method release
+   * puts back a detached player to the idle pool, a player which has been
+   * prepared must be reset by the caller first. The player is deleted if the
+   * pool of the tag is full.
+   */
+  static void release(const char* tag, MediaPlayer* handle);
+  /**
+   * @method warmup
+   * @param {String} tag - the stream tag.
+   * @param {Integer} count - the number of idle players to keep.
+   */
+  static int warmup(const char* tag, int count);
+  /**
+   * @method prefetch
+   * starts connecting and buffering the url with an idle player.
+   */
+  static bool prefetch(const char* tag, const char* url);
+  /**
+   * @method take
+   * @return {Boolean} if a prefetched player of the url is found.
+   */
+  static bool take(const char* tag, const char* url, PrefetchEntry* entry);
+  static void clear();
+
+ private:
+  static void evict(PrefetchEntry* entry);
+  static std::map<std::string, std::deque<MediaPlayer*> > idle;
+  static std::deque<std::pair<std::string, PrefetchEntry> > prefetched;
 };
 
 static iotjs_player_t* iotjs_player_create(jerry_value_t jplayer);
@@ -3,7 +3,9 @@
 #include <node_api.h>
 #include <common.h>
 #include <string.h>
+#include <uv.h>
 #include <librplayer/WavPlayer.h>
+#include <pthread.h>
 
 typedef struct {
   char** _filenames;
@@ -28,6 +30,36 @@ typedef struct {
   napi_async_work _request;
 } prepare_carrier;
 
+typedef struct {
+  char* _filename;
+  char* _tag;
+  bool _holdconnect;
+  int _result;
+  /**
+   * the stage timestamps in nanoseconds from `uv_hrtime()`:
+   * - queued: the work is created on the JS thread.
+   * - began: the work is picked up by a threadpool worker.
+   * - prepared: `prepareWavPlayer` returns.
+   * - started: `startWavPlayer` returns.
+   */
+  uint64_t _queued;
+  uint64_t _began;
+  uint64_t _prepared;
+  uint64_t _started;
+  napi_env _env;
+  napi_ref _callback;
+  napi_async_work _request;
+  /**
+   * the optional `prepared` function is called on the JS thread between the
+   * prepare and the start, the worker waits on `_cond` until it returns.
+   */
+  napi_ref _prepared_fn;
+  uv_async_t _async;
+  pthread_mutex_t _mutex;
+  pthread_cond_t _cond;
+  bool _prepared_done;
+} play_carrier;
+
 static void DoInitPlayer(napi_env env, void* data) {
   init_carrier* c = static_cast<init_carrier*>(data);
   if (c) {
@@ -188,7 +220,7 @@ static void AfterPreparePlayer(napi_env env, napi_status status, void* data) {
 
 static napi_value Prepare(napi_env env, napi_callback_info info) {
   size_t argc = 4;
-  napi_value argv[4];
+  napi_value argv[5];
   NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
 
   if (argc != 4) {
@@ -298,6 +330,180 @@ static napi_value Start(napi_env env, napi_callback_info info) {
   return NULL;
 }
 
+static void DoPlayPlayer(napi_env env, void* data) {
+  play_carrier* c = static_cast<play_carrier*>(data);
+  if (!c) {
+    return;
+  }
+  c->_began = uv_hrtime();
+  c->_result = prepareWavPlayer(c->_filename, c->_tag, c->_holdconnect);
+  c->_prepared = uv_hrtime();
+  if (c->_result != -1 && c->_prepared_fn != NULL) {
+    pthread_mutex_lock(&c->_mutex);
+    uv_async_send(&c->_async);
+    while (!c->_prepared_done) {
+      pthread_cond_wait(&c->_cond, &c->_mutex);
+    }
+    pthread_mutex_unlock(&c->_mutex);
+  }
+  if (c->_result != -1) {
+    c->_result = startWavPlayer();
+  }
+  c->_started = uv_hrtime();
+
+  if (c->_filename != NULL) {
+    free(c->_filename);
+    c->_filename = NULL;
+  }
+  if (c->_tag != NULL) {
+    free(c->_tag);
+    c->_tag = NULL;
+  }
+}
+
+static void OnPlayPrepared(uv_async_t* handle) {
+  play_carrier* c = static_cast<play_carrier*>(handle->data);
+  napi_env env = c->_env;
+  napi_handle_scope scope;
+  napi_value global;
+  napi_value fn;
+  napi_open_handle_scope(env, &scope);
+  napi_get_global(env, &global);
+  napi_get_reference_value(env, c->_prepared_fn, &fn);
+  napi_make_callback(env, nullptr, global, fn, 0, nullptr, nullptr);
+  napi_close_handle_scope(env, scope);
+
+  pthread_mutex_lock(&c->_mutex);
+  c->_prepared_done = true;
+  pthread_cond_signal(&c->_cond);
+  pthread_mutex_unlock(&c->_mutex);
+}
+
+static void OnPlayClosed(uv_handle_t* handle) {
+  play_carrier* c = static_cast<play_carrier*>(handle->data);
+  pthread_mutex_destroy(&c->_mutex);
+  pthread_cond_destroy(&c->_cond);
+  free(c);
+}
+
+static void SetStageDuration(napi_env env, napi_value stats, const char* name,
+                             uint64_t from, uint64_t to) {
+  napi_value val;
+  double ms = to > from ? (double)(to - from) / 1e6 : 0;
+  NAPI_CALL_RETURN_VOID(env, napi_create_double(env, ms, &val));
+  NAPI_CALL_RETURN_VOID(env, napi_set_named_property(env, stats, name, val));
+}
+
+static void AfterPlayPlayer(napi_env env, napi_status status, void* data) {
+  play_carrier* c = static_cast<play_carrier*>(data);
+
+  if (!c || status != napi_ok) {
+    napi_throw_type_error(env, nullptr, "Execute callback failed.");
+    return;
+  }
+
+  napi_value argv[2];
+  if (c->_result == -1) {
+    napi_value message;
+    NAPI_CALL_RETURN_VOID(env,
+                          napi_create_string_utf8(env, "Play WavPlayer Error",
+                                                  NAPI_AUTO_LENGTH, &message));
+    NAPI_CALL_RETURN_VOID(env, napi_create_error(env, NULL, message, &argv[0]));
+  } else {
+    NAPI_CALL_RETURN_VOID(env, napi_get_null(env, &argv[0]));
+  }
+
+  NAPI_CALL_RETURN_VOID(env, napi_create_object(env, &argv[1]));
+  SetStageDuration(env, argv[1], "queue", c->_queued, c->_began);
+  SetStageDuration(env, argv[1], "prepare", c->_began, c->_prepared);
+  SetStageDuration(env, argv[1], "start", c->_prepared, c->_started);
+  SetStageDuration(env, argv[1], "total", c->_queued, uv_hrtime());
+
+  napi_value callback;
+  NAPI_CALL_RETURN_VOID(env,
+                        napi_get_reference_value(env, c->_callback, &callback));
+  napi_value global;
+  NAPI_CALL_RETURN_VOID(env, napi_get_global(env, &global));
+
+  napi_value result;
+  NAPI_CALL_RETURN_VOID(env, napi_call_function(env, global, callback, 2, argv,
+                                                &result));
+
+  NAPI_CALL_RETURN_VOID(env, napi_delete_reference(env, c->_callback));
+  if (c->_prepared_fn != NULL) {
+    NAPI_CALL_RETURN_VOID(env, napi_delete_reference(env, c->_prepared_fn));
+  }
+  NAPI_CALL_RETURN_VOID(env, napi_delete_async_work(env, c->_request));
+
+  uv_close((uv_handle_t*)&c->_async, OnPlayClosed);
+}
+
+/**
+ * play(filename, tag, holdconnect, prepared, callback)
+ *
+ * Prepares and starts the wav player within a single threadpool work, the
+ * `prepared` function is called on the JS thread in between unless it's
+ * null. The callback is called with the error and the stage durations in ms.
+ */
+static napi_value Play(napi_env env, napi_callback_info info) {
+  size_t argc = 5;
+  napi_value argv[5];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+
+  if (argc != 5) {
+    napi_throw_error(env, nullptr, "The argument number is wrong.");
+    return NULL;
+  }
+
+  size_t size = 0;
+  NAPI_CALL(env, napi_get_value_string_utf8(env, argv[0], NULL, 0, &size));
+  char* filename = (char*)malloc(size + 1);
+  NAPI_CALL(env, napi_get_value_string_utf8(env, argv[0], filename, size + 1,
+                                            &size));
+  filename[size] = 0;
+
+  NAPI_CALL(env, napi_get_value_string_utf8(env, argv[1], NULL, 0, &size));
+  char* tag = (char*)malloc(size + 1);
+  NAPI_CALL(env,
+            napi_get_value_string_utf8(env, argv[1], tag, size + 1, &size));
+  tag[size] = 0;
+
+  bool holdconnect = false;
+  NAPI_CALL(env, napi_get_value_bool(env, argv[2], &holdconnect));
+  napi_valuetype prepared_type;
+  NAPI_CALL(env, napi_typeof(env, argv[3], &prepared_type));
+
+  play_carrier* the_carrier = (play_carrier*)malloc(sizeof(play_carrier));
+  memset(the_carrier, 0, sizeof(play_carrier));
+  the_carrier->_filename = filename;
+  the_carrier->_tag = tag;
+  the_carrier->_holdconnect = holdconnect;
+  the_carrier->_queued = uv_hrtime();
+  the_carrier->_env = env;
+  if (prepared_type == napi_function) {
+    NAPI_CALL(env, napi_create_reference(env, argv[3], 1,
+                                         &(the_carrier->_prepared_fn)));
+  }
+  uv_loop_t* loop;
+  NAPI_CALL(env, napi_get_uv_event_loop(env, &loop));
+  uv_async_init(loop, &the_carrier->_async, OnPlayPrepared);
+  the_carrier->_async.data = the_carrier;
+  pthread_mutex_init(&the_carrier->_mutex, NULL);
+  pthread_cond_init(&the_carrier->_cond, NULL);
+
+  napi_value resource_name;
+  NAPI_CALL(env, napi_create_string_utf8(env, "playPlayer", NAPI_AUTO_LENGTH,
+                                         &resource_name));
+  NAPI_CALL(env,
+            napi_create_reference(env, argv[4], 1, &(the_carrier->_callback)));
+  NAPI_CALL(env, napi_create_async_work(env, argv[4], resource_name,
+                                        DoPlayPlayer, AfterPlayPlayer,
+                                        the_carrier, &(the_carrier->_request)));
+  NAPI_CALL(env, napi_queue_async_work(env, the_carrier->_request));
+
+  return NULL;
+}
+
 static napi_value Stop(napi_env env, napi_callback_info info) {
   stopWavPlayer();
   return NULL;
@@ -308,7 +514,8 @@ static napi_value Init(napi_env env, napi_value exports) {
   napi_property_descriptor desc[] = {
     DECLARE_NAPI_PROPERTY("initPlayer", InitPlayer),
     DECLARE_NAPI_PROPERTY("prepare", Prepare),
-    DECLARE_NAPI_PROPERTY("start", Start), DECLARE_NAPI_PROPERTY("stop", Stop)
+    DECLARE_NAPI_PROPERTY("start", Start),
+    DECLARE_NAPI_PROPERTY("play", Play), DECLARE_NAPI_PROPERTY("stop", Stop)
   };
 
   NAPI_CALL(env, napi_define_properties(env, exports,
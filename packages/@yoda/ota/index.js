@@ -24,7 +24,6 @@
 
 var fs = require('fs')
 var path = require('path')
-var crypto = require('crypto')
 var childProcess = require('child_process')
 
 var yodaUtil = require('@yoda/util')
@@ -233,23 +232,18 @@ function cleanImages (callback) {
 }
 
 /**
- * calculate md5 hash of given file.
+ * calculate md5 hash of given file on the native thread of `@yoda/system`.
  *
  * @private
  * @param {string} file - file path
  * @param {Function} callback - a callback with hash string as second argument
  */
 function calculateFileHash (file, callback) {
-  var hash = crypto.createHash('md5')
-  var stream = fs.createReadStream(file)
-  stream.on('data', function onStreamData (data) {
-    hash.update(data)
-  })
-  stream.on('error', function onStreamError (err) {
-    callback(err)
-  })
-  stream.on('end', function onStreamEnd () {
-    callback(null, hash.digest('hex'))
+  system.verifyOtaImage(file, function onVerified (err, result) {
+    if (err) {
+      return callback(err)
+    }
+    callback(null, result.checksum)
   })
 }
 
@@ -272,25 +266,33 @@ function checkDiskAvailability (imageSize, destPath, callback) {
     } else {
       downloadedSize = stat.size
     }
-    var diskUsage = system.diskUsage(upgradeDir)
-    var left = diskUsage.available - imageSize + downloadedSize
-    if (left < 5 * 1024 * 1024) {
-      /**
-       * no space left for new image, try remove existed images
-       * TODO: monkey army, remove arbitrary low prioritized files
-       */
-      return fs.readdir(upgradeDir, (_, files) => {
-        if (files && files.length) {
-          files = files.filter(it => path.extname(it) === '.img')
-          if (files.length) {
-            return cleanImages(() => checkDiskAvailability(imageSize, destPath, callback))
+    system.diskUsageAsync(upgradeDir, function onDiskUsage (err, diskUsage) {
+      if (err) {
+        return callback(err)
+      }
+      var left = diskUsage.available - imageSize + downloadedSize
+      if (left < 5 * 1024 * 1024) {
+        /**
+         * no space left for new image, try remove existed images
+         * TODO: monkey army, remove arbitrary low prioritized files
+         */
+        return fs.readdir(upgradeDir, (_, files) => {
+          if (files && files.length) {
+            files = files.filter(it => path.extname(it) === '.img')
+            if (files.length) {
+              return cleanImages(() => {
+                /** the watcher of the disk usage might not have seen the deletions yet */
+                system.invalidateDiskUsage(upgradeDir)
+                checkDiskAvailability(imageSize, destPath, callback)
+              })
+            }
           }
-        }
-        callback(new Error(
-          `Disk space not available for new ota image, expect ${imageSize}, got ${diskUsage.available}`))
-      })
-    }
-    callback(null, true)
+          callback(new Error(
+            `Disk space not available for new ota image, expect ${imageSize}, got ${diskUsage.available}`))
+        })
+      }
+      callback(null, true)
+    }) /** system.diskUsageAsync */
   }) /** fs.stat */
 }
 
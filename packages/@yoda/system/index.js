@@ -49,12 +49,61 @@ exports.reboot = function reboot (reason) {
 }
 
 /**
- * Verify the OTA image, including hash(md5) check, section check and header check.
+ * @typedef OtaImageVerification
+ * @property {boolean} valid - if the checksum and all blocks match.
+ * @property {string} [checksum] - the md5 hex of the whole image, which is
+ *           computed unless only the blocks are verified.
+ * @property {number[]} badBlocks - the indexes of the mismatched blocks.
+ */
+
+/**
+ * Verify the OTA image off the main thread. The image is hashed through
+ * mmap windows, and with a per-block hash list the blocks are hashed on
+ * multiple threads.
+ *
  * @function verifyOtaImage
- * @returns {boolean}
+ * @param {string} path - the image path.
+ * @param {object} [options]
+ * @param {string} [options.checksum] - the expected md5 hex of the image.
+ * @param {number} [options.blockSize] - the size of the blocks of `blockHashes`.
+ * @param {string[]} [options.blockHashes] - the md5 hex of every block, the
+ *        whole image is only hashed as well if `checksum` is given.
+ * @param {Function} [options.onProgress] - called with `(done, total)` in bytes.
+ * @param {Function} callback - called with `(err, result)`, the result is
+ *        a {@link module:@yoda/system~OtaImageVerification}.
  * @private
  */
-exports.verifyOtaImage = native.verifyOtaImage
+exports.verifyOtaImage = function verifyOtaImage (path, options, callback) {
+  if (typeof options === 'function') {
+    callback = options
+    options = null
+  }
+  options = options || {}
+  if (typeof path !== 'string') {
+    throw new TypeError('Expect a string on first argument of verifyOtaImage')
+  }
+  if (typeof callback !== 'function') {
+    throw new TypeError('Expect a function on callback of verifyOtaImage')
+  }
+  var blockHashes = options.blockHashes || null
+  if (blockHashes && !(options.blockSize > 0)) {
+    throw new TypeError('Expect a positive blockSize with blockHashes')
+  }
+  var whole = !blockHashes || typeof options.checksum === 'string'
+  var started = native.verifyOtaImage(path, whole, options.blockSize || 0,
+    blockHashes, options.onProgress || null, (err, result) => {
+      if (err) {
+        return callback(err)
+      }
+      result.valid = result.badBlocks.length === 0 &&
+        (typeof options.checksum !== 'string' ||
+          result.checksum === options.checksum.toLowerCase())
+      callback(null, result)
+    })
+  if (!started) {
+    process.nextTick(() => callback(new Error('failed to start verifying the image')))
+  }
+}
 
 /**
  * Prepare the OTA procedure. It should be called before start upgrading.
@@ -118,6 +167,128 @@ exports.diskUsage = function diskUsage (path) {
   return native.diskUsage(path)
 }
 
+/**
+ * Get disk usage at the paths off the main thread, statvfs could be stalled
+ * by the garbage collection of the eMMC. The usages are cached for 2s, or
+ * until a file directly in one of the queried directories is written or
+ * deleted. The writes in their subdirectories are only seen after the 2s.
+ *
+ * @function diskUsageAsync
+ * @param {string|string[]} paths - the mount points to be analyzed
+ * @param {Function} callback - called with the error and the
+ * {@link module:@yoda/system~DiskUsage} of the path, or an array of the
+ * usages with `path` and `error` on failure if an array is given.
+ */
+exports.diskUsageAsync = function diskUsageAsync (paths, callback) {
+  var single = typeof paths === 'string'
+  if (!single && !Array.isArray(paths)) {
+    throw TypeError('Expect a string or an array on first argument of diskUsageAsync')
+  }
+  if (typeof callback !== 'function') {
+    throw TypeError('Expect a function on second argument of diskUsageAsync')
+  }
+  var list = single ? [ paths ] : paths
+  list.forEach(it => {
+    if (typeof it !== 'string') {
+      throw TypeError('Expect strings on first argument of diskUsageAsync')
+    }
+  })
+  native.diskUsageBatch(list, function onDiskUsage (err, usages) {
+    if (err || !single) {
+      return callback(err, usages)
+    }
+    var usage = usages[0]
+    if (usage.error) {
+      return callback(new Error(usage.error))
+    }
+    delete usage.path
+    callback(null, usage)
+  })
+}
+
+/**
+ * Drop the cached disk usage of the filesystem at the path, or all of them
+ * if no path is given.
+ *
+ * @function invalidateDiskUsage
+ * @param {string} [path]
+ */
+exports.invalidateDiskUsage = function invalidateDiskUsage (path) {
+  native.invalidateDiskUsage(path)
+}
+
+/**
+ * @typedef ResourceSample
+ * @property {number} time - the realtime in ms.
+ * @property {number} pid
+ * @property {number} threads
+ * @property {number} rss - the resident size in kB.
+ * @property {number} pss - the proportional size in kB, -1 without smaps_rollup.
+ * @property {number} privateDirty - in kB, -1 without smaps_rollup.
+ * @property {number} swap - in kB, -1 without smaps_rollup.
+ * @property {number} cpu - the percent of a core since the previous sample.
+ * @property {number} memFree - the free memory of the system in kB.
+ * @property {number} memAvailable - the available memory of the system in kB.
+ */
+
+/**
+ * Start sampling the memory and CPU of the processes on a native thread,
+ * the samples are kept in a fixed-size ring. The sampler is restarted with
+ * the new options if it's running.
+ *
+ * @function startSampler
+ * @param {object} [options]
+ * @param {number[]} [options.pids=[process.pid]] - the processes to sample.
+ * @param {number} [options.interval=1000] - the interval in ms, at least 100.
+ * @param {number} [options.capacity=1024] - the samples kept in the ring.
+ * @returns {boolean}
+ */
+exports.startSampler = function startSampler (options) {
+  options = options || {}
+  var pids = options.pids || [ process.pid ]
+  if (!Array.isArray(pids)) {
+    throw new TypeError('Expect an array on options.pids')
+  }
+  return native.startSampler(pids.map(Number), options.interval || 1000,
+    options.capacity || 0)
+}
+
+/**
+ * Stop the sampler, the history is kept until the next start.
+ * @function stopSampler
+ */
+exports.stopSampler = function stopSampler () {
+  native.stopSampler()
+}
+
+/**
+ * Get the samples in time order.
+ * @function getSamples
+ * @param {number} [since=0] - only the samples taken after the time in ms.
+ * @returns {module:@yoda/system~ResourceSample[]}
+ */
+exports.getSamples = function getSamples (since) {
+  return native.getSamples(since || 0)
+}
+
+/**
+ * Write the samples to a file.
+ * @function dumpSamples
+ * @param {string} path - the file path.
+ * @param {string} [format='csv'] - "csv" or "json".
+ * @throws {Error} the file could not be written.
+ */
+exports.dumpSamples = function dumpSamples (path, format) {
+  if (typeof path !== 'string') {
+    throw new TypeError('Expect a string on first argument of dumpSamples')
+  }
+  var r = native.dumpSamples(path, format === 'json'
+    ? native.SAMPLER_FORMAT_JSON : native.SAMPLER_FORMAT_CSV)
+  if (r < 0) {
+    throw new Error(`failed to dump the samples to ${path}(${r})`)
+  }
+}
+
 /**
  * convert  a  string  representation  of time to a time `tm` structure.
  * @function parseDateString
@@ -0,0 +1,197 @@
+#include "DiskUsage.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <sys/inotify.h>
+#include <sys/statvfs.h>
+#include <time.h>
+#include <unistd.h>
+
+#define NS_PER_MS 1000000ULL
+#define NS_PER_SEC 1000000000ULL
+// the writes which change the usage, the modifications are left to the ttl
+// as a growing file would invalidate the entries on every write.
+#define DISK_USAGE_EVENTS                                              \
+  (IN_CLOSE_WRITE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |          \
+   IN_DELETE_SELF | IN_MOVE_SELF)
+
+static uint64_t monotonic_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+DiskUsageCache::DiskUsageCache(uint32_t ttl_) : ttl(ttl_) {
+  pthread_mutex_init(&mutex, NULL);
+}
+
+DiskUsageCache::~DiskUsageCache() {
+  if (started) {
+    char c = 0;
+    if (write(wakeup_fds[1], &c, 1) == 1)
+      pthread_join(thread, NULL);
+  }
+  if (inotify_fd >= 0)
+    close(inotify_fd);
+  if (wakeup_fds[0] >= 0) {
+    close(wakeup_fds[0]);
+    close(wakeup_fds[1]);
+  }
+  pthread_mutex_destroy(&mutex);
+}
+
+int DiskUsageCache::query(const string& path, DiskUsageInfo& out) {
+  uint64_t now = monotonic_ns();
+  pthread_mutex_lock(&mutex);
+  auto it = entries.find(path);
+  if (it != entries.end() && now - it->second.at < ttl * NS_PER_MS) {
+    out = it->second.info;
+    pthread_mutex_unlock(&mutex);
+    return 0;
+  }
+  uint64_t gen = generation;
+  pthread_mutex_unlock(&mutex);
+
+  // the lock isn't held here so a stalled mount doesn't block the others
+  struct statvfs st = {};
+  if (statvfs(path.c_str(), &st) != 0)
+    return errno;
+  out.available = (uint64_t)st.f_bavail * st.f_frsize;
+  out.free = (uint64_t)st.f_bfree * st.f_frsize;
+  out.total = (uint64_t)st.f_blocks * st.f_frsize;
+  out.fsid = st.f_fsid;
+
+  pthread_mutex_lock(&mutex);
+  if (gen == generation) {
+    Entry& entry = entries[path];
+    entry.info = out;
+    entry.at = now;
+  }
+  pthread_mutex_unlock(&mutex);
+  watch(path, out.fsid);
+  return 0;
+}
+
+void DiskUsageCache::invalidate(const string& path) {
+  pthread_mutex_lock(&mutex);
+  generation++;
+  if (path.empty()) {
+    entries.clear();
+  } else {
+    auto it = entries.find(path);
+    if (it != entries.end())
+      dropFilesystem(it->second.info.fsid);
+  }
+  pthread_mutex_unlock(&mutex);
+}
+
+/**
+ * watches the path if it's not yet, the watcher is started on the first
+ * path. The lock must not be held.
+ */
+void DiskUsageCache::watch(const string& path, unsigned long fsid) {
+  pthread_mutex_lock(&mutex);
+  if (watched.find(path) != watched.end() ||
+      watched.size() >= DISK_USAGE_MAX_WATCHES || !startWatcher()) {
+    pthread_mutex_unlock(&mutex);
+    return;
+  }
+  int fd = inotify_fd;
+  pthread_mutex_unlock(&mutex);
+
+  // resolving the path could be stalled like the statvfs, so it's added
+  // without the lock. The same path added by the racing queries gets the
+  // same watch descriptor.
+  int wd = inotify_add_watch(fd, path.c_str(), DISK_USAGE_EVENTS);
+  if (wd < 0)
+    return;
+  pthread_mutex_lock(&mutex);
+  watched[path] = wd;
+  watches[wd] = fsid;
+  pthread_mutex_unlock(&mutex);
+}
+
+/**
+ * starts the watcher with the lock held, returns if it's running.
+ */
+bool DiskUsageCache::startWatcher() {
+  if (started)
+    return true;
+  // the ttl is the only expiry if the watcher couldn't be started
+  if (unwatchable)
+    return false;
+  unwatchable = true;
+  inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (inotify_fd < 0 || pipe2(wakeup_fds, O_CLOEXEC) != 0) {
+    fprintf(stderr, "system: failed to watch the disk usage(%d)\n", errno);
+    return false;
+  }
+  int r = pthread_create(&thread, NULL, DiskUsageCache::Run, this);
+  if (r != 0) {
+    fprintf(stderr, "system: failed to start the disk watcher(%d)\n", r);
+    return false;
+  }
+  started = true;
+  return true;
+}
+
+void DiskUsageCache::dropFilesystem(unsigned long fsid) {
+  for (auto it = entries.begin(); it != entries.end();) {
+    if (it->second.info.fsid == fsid)
+      it = entries.erase(it);
+    else
+      ++it;
+  }
+}
+
+void* DiskUsageCache::Run(void* data) {
+  DiskUsageCache* self = static_cast<DiskUsageCache*>(data);
+  self->loop();
+  return NULL;
+}
+
+void DiskUsageCache::loop() {
+  // aligned for the inotify_event
+  char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+  struct pollfd fds[2];
+  fds[0].fd = inotify_fd;
+  fds[0].events = POLLIN;
+  fds[1].fd = wakeup_fds[0];
+  fds[1].events = POLLIN;
+
+  for (;;) {
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+    if (fds[1].revents != 0)
+      break;
+    ssize_t len = read(inotify_fd, buf, sizeof(buf));
+    if (len <= 0)
+      continue;
+
+    pthread_mutex_lock(&mutex);
+    generation++;
+    for (char* p = buf; p < buf + len;) {
+      struct inotify_event* event = (struct inotify_event*)p;
+      p += sizeof(struct inotify_event) + event->len;
+      auto it = watches.find(event->wd);
+      if (it == watches.end())
+        continue;
+      dropFilesystem(it->second);
+      // the path is gone or unmounted, it's watched again on next query
+      if (event->mask & IN_IGNORED) {
+        watches.erase(it);
+        for (auto w = watched.begin(); w != watched.end();) {
+          if (w->second == event->wd)
+            w = watched.erase(w);
+          else
+            ++w;
+        }
+      }
+    }
+    pthread_mutex_unlock(&mutex);
+  }
+}
@@ -0,0 +1,79 @@
+#ifndef DISK_USAGE_H
+#define DISK_USAGE_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <map>
+#include <string>
+using namespace std;
+
+// the ms a statvfs result is reused for
+#define DISK_USAGE_TTL 2000
+// the maximum paths watched, the others are only expired by the ttl
+#define DISK_USAGE_MAX_WATCHES 32
+
+/**
+ * The usage of the filesystem mounted at a path in bytes.
+ */
+struct DiskUsageInfo {
+  uint64_t available;
+  uint64_t free;
+  uint64_t total;
+  unsigned long fsid;
+};
+
+/**
+ * @class DiskUsageCache
+ * Caches the statvfs of the paths for a short ttl, statvfs could be stalled
+ * by the garbage collection of the eMMC. The queried paths are watched with
+ * inotify on its own thread, and the entries of a filesystem are dropped
+ * once a file directly in a watched directory is written, moved or deleted.
+ * inotify is not recursive, so the writes in the subdirectories are only
+ * seen after the ttl unless the subdirectory is queried itself.
+ */
+class DiskUsageCache {
+ public:
+  explicit DiskUsageCache(uint32_t ttl);
+  ~DiskUsageCache();
+
+  /**
+   * @method query
+   * gets the usage from the cache or the statvfs, returns 0 or an errno.
+   * The errors are never cached.
+   */
+  int query(const string& path, DiskUsageInfo& out);
+  /**
+   * @method invalidate
+   * drops the entries of the filesystem at the path, or all of the entries
+   * if the path is empty.
+   */
+  void invalidate(const string& path);
+
+ private:
+  struct Entry {
+    DiskUsageInfo info;
+    uint64_t at;
+  };
+  static void* Run(void* data);
+  void loop();
+  void watch(const string& path, unsigned long fsid);
+  bool startWatcher();
+  void dropFilesystem(unsigned long fsid);
+
+ private:
+  uint32_t ttl;
+  map<string, Entry> entries;
+  // the inotify watches of the paths and the filesystems they're on
+  map<string, int> watched;
+  map<int, unsigned long> watches;
+  // bumped on every invalidation to drop the statvfs racing with it
+  uint64_t generation = 0;
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  bool started = false;
+  bool unwatchable = false;
+  int inotify_fd = -1;
+  int wakeup_fds[2] = { -1, -1 };
+};
+
+#endif // DISK_USAGE_H
@@ -0,0 +1,187 @@
+#include "ImageVerifier.h"
+#include "Md5.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct VerifyTask {
+  ImageVerifyJob* job;
+  image_verify_callback callback;
+  void* data;
+  int fd;
+  uint64_t size;
+  atomic<size_t> next_block;
+  pthread_mutex_t mutex;
+
+  VerifyTask() : next_block(0) {}
+};
+
+/**
+ * hashes [offset, offset + len) of the file through the mapped windows.
+ * Returns 0 or an errno.
+ */
+static int verify_hash_range(VerifyTask* task, uint64_t offset, uint64_t len,
+                             Md5Context* ctx) {
+  static const uint64_t page = (uint64_t)sysconf(_SC_PAGESIZE);
+  uint64_t end = offset + len;
+  for (uint64_t pos = offset; pos < end;) {
+    uint64_t aligned = pos & ~(page - 1);
+    uint64_t n = end - pos;
+    if (n > VERIFY_WINDOW_SIZE)
+      n = VERIFY_WINDOW_SIZE;
+    size_t maplen = (size_t)(pos - aligned + n);
+    void* addr =
+        mmap(NULL, maplen, PROT_READ, MAP_PRIVATE, task->fd, (off_t)aligned);
+    if (addr == MAP_FAILED)
+      return errno;
+    madvise(addr, maplen, MADV_SEQUENTIAL);
+    md5_update(ctx, (const uint8_t*)addr + (pos - aligned), (size_t)n);
+    munmap(addr, maplen);
+    pos += n;
+    task->job->done += n;
+    task->callback(task->data, false);
+  }
+  return 0;
+}
+
+static void* verify_blocks(void* data) {
+  VerifyTask* task = static_cast<VerifyTask*>(data);
+  ImageVerifyJob* job = task->job;
+  for (;;) {
+    size_t i = task->next_block++;
+    if (i >= job->blocks.size())
+      break;
+    uint64_t offset = (uint64_t)i * job->block_size;
+    uint64_t len = task->size - offset;
+    if (len > job->block_size)
+      len = job->block_size;
+    Md5Context ctx;
+    uint8_t digest[MD5_DIGEST_SIZE];
+    char hex[MD5_DIGEST_SIZE * 2 + 1];
+    md5_init(&ctx);
+    int err = verify_hash_range(task, offset, len, &ctx);
+    md5_final(&ctx, digest);
+    md5_hex(digest, hex);
+
+    pthread_mutex_lock(&task->mutex);
+    if (err != 0 && job->error == 0)
+      job->error = err;
+    if (err == 0 && strcasecmp(hex, job->blocks[i].c_str()) != 0)
+      job->bad_blocks.push_back((int)i);
+    pthread_mutex_unlock(&task->mutex);
+  }
+  return NULL;
+}
+
+static void verify_image(VerifyTask* task) {
+  ImageVerifyJob* job = task->job;
+  task->fd = open(job->path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (task->fd < 0) {
+    job->error = errno;
+    return;
+  }
+  struct stat st;
+  if (fstat(task->fd, &st) != 0) {
+    job->error = errno;
+    return;
+  }
+  task->size = (uint64_t)st.st_size;
+
+  bool blocks = !job->blocks.empty();
+  if (blocks) {
+    uint64_t count =
+        job->block_size > 0
+            ? (task->size + job->block_size - 1) / job->block_size
+            : 0;
+    // the block list doesn't describe this image
+    if (count != job->blocks.size()) {
+      job->error = EINVAL;
+      return;
+    }
+  }
+  job->total = (job->whole ? task->size : 0) + (blocks ? task->size : 0);
+
+  pthread_t workers[VERIFY_MAX_WORKERS];
+  int started = 0;
+  if (blocks) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t wanted = cpus > 0 ? (size_t)cpus : 1;
+    // a core is left for the whole digest if it's requested as well
+    if (job->whole && wanted > 1)
+      wanted--;
+    if (wanted > VERIFY_MAX_WORKERS)
+      wanted = VERIFY_MAX_WORKERS;
+    if (wanted > job->blocks.size())
+      wanted = job->blocks.size();
+    for (size_t i = 0; i < wanted; i++) {
+      if (pthread_create(&workers[started], NULL, verify_blocks, task) == 0)
+        started++;
+    }
+    // hashes the blocks on this thread if no worker could be started
+    if (started == 0)
+      verify_blocks(task);
+  }
+
+  if (job->whole) {
+    Md5Context ctx;
+    uint8_t digest[MD5_DIGEST_SIZE];
+    char hex[MD5_DIGEST_SIZE * 2 + 1];
+    md5_init(&ctx);
+    int err = verify_hash_range(task, 0, task->size, &ctx);
+    md5_final(&ctx, digest);
+    md5_hex(digest, hex);
+    pthread_mutex_lock(&task->mutex);
+    if (err != 0 && job->error == 0)
+      job->error = err;
+    job->digest = hex;
+    pthread_mutex_unlock(&task->mutex);
+  }
+
+  for (int i = 0; i < started; i++) {
+    pthread_join(workers[i], NULL);
+  }
+}
+
+static void* verify_run(void* data) {
+  VerifyTask* task = static_cast<VerifyTask*>(data);
+  verify_image(task);
+  if (task->fd >= 0)
+    close(task->fd);
+  image_verify_callback callback = task->callback;
+  void* callback_data = task->data;
+  pthread_mutex_destroy(&task->mutex);
+  delete task;
+  callback(callback_data, true);
+  return NULL;
+}
+
+bool image_verify_start(ImageVerifyJob* job, image_verify_callback callback,
+                        void* data) {
+  VerifyTask* task = new VerifyTask();
+  task->job = job;
+  task->callback = callback;
+  task->data = data;
+  task->fd = -1;
+  task->size = 0;
+  pthread_mutex_init(&task->mutex, NULL);
+
+  pthread_attr_t attr;
+  pthread_t thread;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  int r = pthread_create(&thread, &attr, verify_run, task);
+  pthread_attr_destroy(&attr);
+  if (r != 0) {
+    fprintf(stderr, "system: failed to start the image verifier(%d)\n", r);
+    pthread_mutex_destroy(&task->mutex);
+    delete task;
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,52 @@
+#ifndef IMAGE_VERIFIER_H
+#define IMAGE_VERIFIER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <string>
+#include <vector>
+using namespace std;
+
+// the bytes mapped at a time, which keeps the address space small on 32-bit
+#define VERIFY_WINDOW_SIZE (8 << 20)
+// the maximum threads hashing the blocks
+#define VERIFY_MAX_WORKERS 4
+
+/**
+ * A verification of an image. The whole MD5 is computed if `digest` is
+ * requested, the blocks of `block_size` are hashed on multiple threads and
+ * compared with `blocks` which are the MD5 hex strings.
+ */
+struct ImageVerifyJob {
+  string path;
+  bool whole = true;
+  size_t block_size = 0;
+  vector<string> blocks;
+
+  // the results, which are read once finished
+  int error = 0;
+  string digest;
+  vector<int> bad_blocks;
+  // the progress in bytes, the whole image and the blocks are counted once
+  // each
+  atomic<uint64_t> total;
+  atomic<uint64_t> done;
+
+  ImageVerifyJob() : total(0), done(0) {}
+};
+
+/**
+ * called on the verifying threads after every window and once finished,
+ * the job must not be touched by the verifier after the last call.
+ */
+typedef void (*image_verify_callback)(void* data, bool finished);
+
+/**
+ * verifies the image on a detached thread, returns false if the thread
+ * can't be started.
+ */
+bool image_verify_start(ImageVerifyJob* job, image_verify_callback callback,
+                        void* data);
+
+#endif // IMAGE_VERIFIER_H
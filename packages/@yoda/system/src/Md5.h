@@ -0,0 +1,28 @@
+#ifndef SYSTEM_MD5_H
+#define SYSTEM_MD5_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MD5_DIGEST_SIZE 16
+
+/**
+ * The streaming MD5 of RFC 1321, which is the checksum format of the OTA
+ * images.
+ */
+struct Md5Context {
+  uint32_t state[4];
+  uint64_t length;
+  uint8_t buffer[64];
+};
+
+void md5_init(Md5Context* ctx);
+void md5_update(Md5Context* ctx, const uint8_t* data, size_t len);
+void md5_final(Md5Context* ctx, uint8_t digest[MD5_DIGEST_SIZE]);
+/**
+ * writes the lowercase hex of the digest and the trailing '\0'.
+ */
+void md5_hex(const uint8_t digest[MD5_DIGEST_SIZE],
+             char hex[MD5_DIGEST_SIZE * 2 + 1]);
+
+#endif // SYSTEM_MD5_H
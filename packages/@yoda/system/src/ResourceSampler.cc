@@ -0,0 +1,302 @@
+#include "ResourceSampler.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define NS_PER_MS 1000000ULL
+#define NS_PER_SEC 1000000000ULL
+// large enough for /proc/meminfo and smaps_rollup
+#define SAMPLER_BUFFER_SIZE 4096
+
+static uint64_t clock_ns(clockid_t clock) {
+  struct timespec ts;
+  clock_gettime(clock, &ts);
+  return (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+static int open_proc(int pid, const char* name) {
+  char path[64];
+  snprintf(path, sizeof(path), "/proc/%d/%s", pid, name);
+  return open(path, O_RDONLY | O_CLOEXEC);
+}
+
+/**
+ * re-reads the proc file from the start, returns the length or -1.
+ */
+static ssize_t read_proc(int fd, char* buf, size_t size) {
+  if (fd < 0)
+    return -1;
+  ssize_t len = pread(fd, buf, size - 1, 0);
+  if (len < 0)
+    return -1;
+  buf[len] = '\0';
+  return len;
+}
+
+/**
+ * finds the line of `key`, like "Rss:", and parses its number in kB.
+ */
+static int64_t read_field(const char* buf, const char* key) {
+  size_t len = strlen(key);
+  for (const char* line = buf; line != NULL;) {
+    if (strncmp(line, key, len) == 0)
+      return strtoll(line + len, NULL, 10);
+    line = strchr(line, '\n');
+    if (line)
+      line++;
+  }
+  return -1;
+}
+
+ResourceSampler::ResourceSampler() {
+  pthread_mutex_init(&mutex, NULL);
+  pthread_condattr_t attr;
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&cond, &attr);
+  pthread_condattr_destroy(&attr);
+  long tck = sysconf(_SC_CLK_TCK);
+  if (tck > 0)
+    ticks_per_sec = tck;
+}
+
+ResourceSampler::~ResourceSampler() {
+  stop();
+  pthread_cond_destroy(&cond);
+  pthread_mutex_destroy(&mutex);
+}
+
+bool ResourceSampler::start(const vector<int>& pids, uint32_t interval_,
+                            size_t capacity) {
+  stop();
+  if (pids.empty())
+    return false;
+  for (size_t i = 0; i < pids.size(); i++) {
+    Target target;
+    target.pid = pids[i] > 0 ? pids[i] : getpid();
+    target.stat_fd = open_proc(target.pid, "stat");
+    target.smaps_fd = open_proc(target.pid, "smaps_rollup");
+    // the kernels before 4.14 have no smaps_rollup
+    target.statm_fd = target.smaps_fd < 0 ? open_proc(target.pid, "statm") : -1;
+    target.ticks = 0;
+    target.at = 0;
+    targets.push_back(target);
+  }
+  meminfo_fd = open("/proc/meminfo", O_RDONLY | O_CLOEXEC);
+
+  pthread_mutex_lock(&mutex);
+  ring.assign(capacity > 0 ? capacity : SAMPLER_DEFAULT_CAPACITY,
+              ResourceSample());
+  head = 0;
+  count = 0;
+  pthread_mutex_unlock(&mutex);
+
+  if (interval_ < SAMPLER_MIN_INTERVAL)
+    interval_ = SAMPLER_MIN_INTERVAL;
+  interval = interval_ * NS_PER_MS;
+  stopping = false;
+  if (pthread_create(&thread, NULL, ResourceSampler::Run, this) != 0) {
+    fprintf(stderr, "system: failed to start the sampler(%d)\n", errno);
+    closeTargets();
+    return false;
+  }
+  started = true;
+  return true;
+}
+
+void ResourceSampler::stop() {
+  if (!started)
+    return;
+  pthread_mutex_lock(&mutex);
+  stopping = true;
+  pthread_cond_signal(&cond);
+  pthread_mutex_unlock(&mutex);
+  pthread_join(thread, NULL);
+  started = false;
+  closeTargets();
+}
+
+bool ResourceSampler::running() {
+  return started;
+}
+
+void ResourceSampler::closeTargets() {
+  for (size_t i = 0; i < targets.size(); i++) {
+    if (targets[i].stat_fd >= 0)
+      close(targets[i].stat_fd);
+    if (targets[i].smaps_fd >= 0)
+      close(targets[i].smaps_fd);
+    if (targets[i].statm_fd >= 0)
+      close(targets[i].statm_fd);
+  }
+  targets.clear();
+  if (meminfo_fd >= 0)
+    close(meminfo_fd);
+  meminfo_fd = -1;
+}
+
+bool ResourceSampler::sampleTarget(Target& target, uint64_t now,
+                                   ResourceSample& out) {
+  char buf[SAMPLER_BUFFER_SIZE];
+  // the process has exited once its stat can't be read
+  if (read_proc(target.stat_fd, buf, sizeof(buf)) <= 0)
+    return false;
+  // the fields after the comm, which could contain spaces
+  char* p = strrchr(buf, ')');
+  if (p == NULL)
+    return false;
+  uint64_t ticks = 0;
+  out.threads = 0;
+  p += 2;
+  for (int field = 3; p != NULL && *p != '\0' && field <= 20; field++) {
+    if (field == 14 || field == 15)
+      ticks += strtoull(p, NULL, 10);
+    else if (field == 20)
+      out.threads = atoi(p);
+    p = strchr(p, ' ');
+    if (p)
+      p++;
+  }
+  out.cpu = 0;
+  if (target.at > 0 && now > target.at) {
+    double elapsed = (double)(now - target.at) / NS_PER_SEC;
+    out.cpu = (ticks - target.ticks) * 100.0 / (elapsed * ticks_per_sec);
+  }
+  target.ticks = ticks;
+  target.at = now;
+
+  out.pss = out.private_dirty = out.swap = -1;
+  if (read_proc(target.smaps_fd, buf, sizeof(buf)) > 0) {
+    out.rss = read_field(buf, "Rss:");
+    out.pss = read_field(buf, "Pss:");
+    out.private_dirty = read_field(buf, "Private_Dirty:");
+    out.swap = read_field(buf, "Swap:");
+  } else if (read_proc(target.statm_fd, buf, sizeof(buf)) > 0) {
+    long pages = 0;
+    sscanf(buf, "%*s %ld", &pages);
+    out.rss = (int64_t)pages * sysconf(_SC_PAGESIZE) / 1024;
+  } else {
+    out.rss = -1;
+  }
+  out.pid = target.pid;
+  return true;
+}
+
+void ResourceSampler::sample() {
+  char buf[SAMPLER_BUFFER_SIZE];
+  int64_t mem_free = -1;
+  int64_t mem_available = -1;
+  if (read_proc(meminfo_fd, buf, sizeof(buf)) > 0) {
+    mem_free = read_field(buf, "MemFree:");
+    mem_available = read_field(buf, "MemAvailable:");
+  }
+  uint64_t now = clock_ns(CLOCK_MONOTONIC);
+  uint64_t time = clock_ns(CLOCK_REALTIME) / NS_PER_MS;
+
+  // only allocated on the first round of the targets
+  pending.resize(targets.size());
+  size_t taken = 0;
+  for (size_t i = 0; i < targets.size(); i++) {
+    ResourceSample& s = pending[taken];
+    if (!sampleTarget(targets[i], now, s))
+      continue;
+    s.time = time;
+    s.mem_free = mem_free;
+    s.mem_available = mem_available;
+    taken++;
+  }
+
+  pthread_mutex_lock(&mutex);
+  for (size_t i = 0; i < taken; i++) {
+    ring[head] = pending[i];
+    head = (head + 1) % ring.size();
+    if (count < ring.size())
+      count++;
+  }
+  pthread_mutex_unlock(&mutex);
+}
+
+void ResourceSampler::history(vector<ResourceSample>& out, uint64_t since) {
+  out.clear();
+  pthread_mutex_lock(&mutex);
+  out.reserve(count);
+  size_t first = (head + ring.size() - count) % (ring.empty() ? 1 : ring.size());
+  for (size_t i = 0; i < count; i++) {
+    const ResourceSample& s = ring[(first + i) % ring.size()];
+    if (s.time > since)
+      out.push_back(s);
+  }
+  pthread_mutex_unlock(&mutex);
+}
+
+int ResourceSampler::dump(const char* path, int format) {
+  vector<ResourceSample> samples;
+  history(samples, 0);
+  FILE* fp = fopen(path, "w");
+  if (fp == NULL)
+    return -errno;
+  if (format == SAMPLER_FORMAT_CSV) {
+    fprintf(fp,
+            "time,pid,threads,rss,pss,private_dirty,swap,cpu,mem_free,"
+            "mem_available\n");
+  } else {
+    fputs("[", fp);
+  }
+  for (size_t i = 0; i < samples.size(); i++) {
+    const ResourceSample& s = samples[i];
+    if (format == SAMPLER_FORMAT_CSV) {
+      fprintf(fp,
+              "%" PRIu64 ",%d,%d,%" PRId64 ",%" PRId64 ",%" PRId64 ",%" PRId64
+              ",%.2f,%" PRId64 ",%" PRId64 "\n",
+              s.time, s.pid, s.threads, s.rss, s.pss, s.private_dirty, s.swap,
+              s.cpu, s.mem_free, s.mem_available);
+    } else {
+      fprintf(fp,
+              "%s\n{\"time\":%" PRIu64 ",\"pid\":%d,\"threads\":%d,"
+              "\"rss\":%" PRId64 ",\"pss\":%" PRId64
+              ",\"privateDirty\":%" PRId64 ",\"swap\":%" PRId64
+              ",\"cpu\":%.2f,\"memFree\":%" PRId64
+              ",\"memAvailable\":%" PRId64 "}",
+              i > 0 ? "," : "", s.time, s.pid, s.threads, s.rss, s.pss,
+              s.private_dirty, s.swap, s.cpu, s.mem_free, s.mem_available);
+    }
+  }
+  if (format != SAMPLER_FORMAT_CSV)
+    fputs("\n]\n", fp);
+  int r = ferror(fp) ? -EIO : 0;
+  if (fclose(fp) != 0 && r == 0)
+    r = -errno;
+  return r;
+}
+
+void* ResourceSampler::Run(void* data) {
+  static_cast<ResourceSampler*>(data)->loop();
+  return NULL;
+}
+
+void ResourceSampler::loop() {
+  uint64_t next = clock_ns(CLOCK_MONOTONIC);
+  pthread_mutex_lock(&mutex);
+  while (!stopping) {
+    pthread_mutex_unlock(&mutex);
+    sample();
+    pthread_mutex_lock(&mutex);
+    // keeps the cadence, the missed samples are skipped
+    uint64_t now = clock_ns(CLOCK_MONOTONIC);
+    do {
+      next += interval;
+    } while (next <= now);
+    struct timespec ts;
+    ts.tv_sec = next / NS_PER_SEC;
+    ts.tv_nsec = next % NS_PER_SEC;
+    while (!stopping &&
+           pthread_cond_timedwait(&cond, &mutex, &ts) != ETIMEDOUT) {
+    }
+  }
+  pthread_mutex_unlock(&mutex);
+}
@@ -0,0 +1,105 @@
+#ifndef RESOURCE_SAMPLER_H
+#define RESOURCE_SAMPLER_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+using namespace std;
+
+// the default number of the samples kept in the ring
+#define SAMPLER_DEFAULT_CAPACITY 1024
+// the minimal interval in ms
+#define SAMPLER_MIN_INTERVAL 100
+
+/**
+ * A sample of a process, the sizes are in kB. The pss, private dirty and
+ * swap are -1 when the kernel has no smaps_rollup.
+ */
+struct ResourceSample {
+  // the realtime in ms
+  uint64_t time;
+  int pid;
+  int threads;
+  int64_t rss;
+  int64_t pss;
+  int64_t private_dirty;
+  int64_t swap;
+  // the percent of a core since the previous sample
+  double cpu;
+  int64_t mem_free;
+  int64_t mem_available;
+};
+
+enum SamplerFormat {
+  SAMPLER_FORMAT_CSV = 0,
+  SAMPLER_FORMAT_JSON,
+};
+
+/**
+ * @class ResourceSampler
+ * Reads /proc/<pid>/smaps_rollup, /proc/<pid>/stat and /proc/meminfo on its
+ * own thread into a fixed-size ring, the files are kept open and re-read
+ * from the start to avoid the lookups on every sample.
+ */
+class ResourceSampler {
+ public:
+  ResourceSampler();
+  ~ResourceSampler();
+
+  /**
+   * @method start
+   * restarts the sampler with the processes, 0 is the current process. The
+   * history is cleared.
+   */
+  bool start(const vector<int>& pids, uint32_t interval, size_t capacity);
+  void stop();
+  bool running();
+  /**
+   * @method history
+   * copies the samples taken after `since` in ms in time order.
+   */
+  void history(vector<ResourceSample>& out, uint64_t since);
+  /**
+   * @method dump
+   * writes the history to the file, returns 0 or a negative errno.
+   */
+  int dump(const char* path, int format);
+
+ private:
+  struct Target {
+    int pid;
+    int stat_fd;
+    int smaps_fd;
+    int statm_fd;
+    uint64_t ticks;
+    uint64_t at;
+  };
+  static void* Run(void* data);
+  void loop();
+  void sample();
+  bool sampleTarget(Target& target, uint64_t now, ResourceSample& out);
+  void closeTargets();
+
+ private:
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  bool started = false;
+  bool stopping = false;
+  uint64_t interval = 0;
+  long ticks_per_sec = 100;
+
+  // owned by the sampler thread while running
+  vector<Target> targets;
+  int meminfo_fd = -1;
+  // the samples of a round before they're pushed into the ring
+  vector<ResourceSample> pending;
+
+  vector<ResourceSample> ring;
+  size_t head = 0;
+  size_t count = 0;
+};
+
+#endif // RESOURCE_SAMPLER_H
@@ -1,13 +1,39 @@
 #define _XOPEN_SOURCE
 #include <node_api.h>
 #include <recovery/recovery.h>
-#include <sys/statvfs.h>
 #include <time.h>
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <common.h>
 #include <errno.h>
+#include <pthread.h>
+#include <uv.h>
+#include "DiskUsage.h"
+#include "ImageVerifier.h"
+#include "ResourceSampler.h"
+
+static ResourceSampler sampler;
+static DiskUsageCache diskUsageCache(DISK_USAGE_TTL);
+
+typedef struct {
+  vector<string> _paths;
+  vector<DiskUsageInfo> _results;
+  vector<int> _errors;
+  napi_ref _callback;
+  napi_async_work _request;
+} disk_usage_carrier;
+
+typedef struct {
+  ImageVerifyJob _job;
+  napi_env _env;
+  napi_ref _progress;
+  napi_ref _callback;
+  uv_async_t _async;
+  // guards the final send against the close of the handle
+  pthread_mutex_t _mutex;
+  bool _finished;
+} verify_carrier;
 
 static napi_value PowerOff(napi_env env, napi_callback_info info) {
   napi_value returnVal;
@@ -27,9 +53,136 @@ static napi_value Reboot(napi_env env, napi_callback_info info) {
   return returnVal;
 }
 
+static void OnVerifyClosed(uv_handle_t* handle) {
+  verify_carrier* c = static_cast<verify_carrier*>(handle->data);
+  if (c->_progress) {
+    napi_delete_reference(c->_env, c->_progress);
+  }
+  napi_delete_reference(c->_env, c->_callback);
+  pthread_mutex_destroy(&c->_mutex);
+  delete c;
+}
+
+static void OnVerifyAsync(uv_async_t* handle) {
+  verify_carrier* c = static_cast<verify_carrier*>(handle->data);
+  napi_env env = c->_env;
+  napi_handle_scope scope;
+  napi_value global;
+  napi_value callback;
+  napi_value argv[2];
+  // the verifier never touches the carrier once the finished flag is seen
+  pthread_mutex_lock(&c->_mutex);
+  bool finished = c->_finished;
+  pthread_mutex_unlock(&c->_mutex);
+
+  napi_open_handle_scope(env, &scope);
+  napi_get_global(env, &global);
+  if (c->_progress) {
+    napi_get_reference_value(env, c->_progress, &callback);
+    napi_create_double(env, c->_job.done, &argv[0]);
+    napi_create_double(env, c->_job.total, &argv[1]);
+    napi_make_callback(env, nullptr, global, callback, 2, argv, nullptr);
+  }
+  if (!finished) {
+    napi_close_handle_scope(env, scope);
+    return;
+  }
+
+  ImageVerifyJob& job = c->_job;
+  if (job.error != 0) {
+    napi_value message;
+    napi_create_string_utf8(env, strerror(job.error), NAPI_AUTO_LENGTH,
+                            &message);
+    napi_create_error(env, nullptr, message, &argv[0]);
+    napi_get_undefined(env, &argv[1]);
+  } else {
+    napi_value value;
+    napi_get_null(env, &argv[0]);
+    napi_create_object(env, &argv[1]);
+    if (job.whole) {
+      napi_create_string_utf8(env, job.digest.c_str(), job.digest.size(),
+                              &value);
+      napi_set_named_property(env, argv[1], "checksum", value);
+    }
+    napi_create_array_with_length(env, job.bad_blocks.size(), &value);
+    for (size_t i = 0; i < job.bad_blocks.size(); i++) {
+      napi_value index;
+      napi_create_int32(env, job.bad_blocks[i], &index);
+      napi_set_element(env, value, i, index);
+    }
+    napi_set_named_property(env, argv[1], "badBlocks", value);
+  }
+  napi_get_reference_value(env, c->_callback, &callback);
+  napi_make_callback(env, nullptr, global, callback, 2, argv, nullptr);
+  napi_close_handle_scope(env, scope);
+  uv_close((uv_handle_t*)handle, OnVerifyClosed);
+}
+
+static void OnVerifyProgress(void* data, bool finished) {
+  verify_carrier* c = static_cast<verify_carrier*>(data);
+  if (!finished) {
+    uv_async_send(&c->_async);
+    return;
+  }
+  // a pending progress might close the handle once the flag is set, so the
+  // flag and the last send are done under the lock.
+  pthread_mutex_lock(&c->_mutex);
+  c->_finished = true;
+  uv_async_send(&c->_async);
+  pthread_mutex_unlock(&c->_mutex);
+}
+
+/**
+ * verifyOtaImage(path, whole, blockSize, blockHashes, progress, callback)
+ * hashes the image off the JS thread, the callback gets the whole checksum
+ * if `whole` and the indexes of the blocks not matching `blockHashes`.
+ */
 static napi_value VerifyOtaImage(napi_env env, napi_callback_info info) {
+  size_t argc = 6;
+  napi_value argv[6];
+  napi_valuetype type;
+  int blockSize;
+  uint32_t len = 0;
+  uv_loop_t* loop;
   napi_value returnVal;
-  napi_get_boolean(env, true, &returnVal);
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, 0, 0));
+  NAPI_ASSERT(env, argc >= 6, "expect 6 arguments");
+
+  verify_carrier* c = new verify_carrier();
+  c->_finished = false;
+  pthread_mutex_init(&c->_mutex, NULL);
+  NAPI_ASSIGN_STD_STRING(env, c->_job.path, argv[0]);
+  napi_get_value_bool(env, argv[1], &c->_job.whole);
+  napi_get_value_int32(env, argv[2], &blockSize);
+  c->_job.block_size = blockSize > 0 ? blockSize : 0;
+  napi_typeof(env, argv[3], &type);
+  if (type == napi_object) {
+    napi_get_array_length(env, argv[3], &len);
+  }
+  for (uint32_t i = 0; i < len; i++) {
+    napi_value item;
+    string hash;
+    napi_get_element(env, argv[3], i, &item);
+    NAPI_ASSIGN_STD_STRING(env, hash, item);
+    c->_job.blocks.push_back(hash);
+  }
+
+  c->_env = env;
+  c->_progress = nullptr;
+  napi_typeof(env, argv[4], &type);
+  if (type == napi_function) {
+    napi_create_reference(env, argv[4], 1, &c->_progress);
+  }
+  napi_create_reference(env, argv[5], 1, &c->_callback);
+  napi_get_uv_event_loop(env, &loop);
+  uv_async_init(loop, &c->_async, OnVerifyAsync);
+  c->_async.data = c;
+
+  bool started = image_verify_start(&c->_job, OnVerifyProgress, c);
+  if (!started) {
+    uv_close((uv_handle_t*)&c->_async, OnVerifyClosed);
+  }
+  napi_get_boolean(env, started, &returnVal);
   return returnVal;
 }
 
@@ -128,39 +281,134 @@ static napi_value SetRecoveryMode(napi_env env, napi_callback_info info) {
   return returnVal;
 }
 
-static napi_value DiskUsage(napi_env env, napi_callback_info backInfo) {
-  napi_value key;
+static napi_value CreateDiskUsage(napi_env env, const DiskUsageInfo& info) {
+  napi_value obj;
   napi_value value;
+  napi_create_object(env, &obj);
+  napi_create_double(env, info.available, &value);
+  napi_set_named_property(env, obj, "available", value);
+  napi_create_double(env, info.free, &value);
+  napi_set_named_property(env, obj, "free", value);
+  napi_create_double(env, info.total, &value);
+  napi_set_named_property(env, obj, "total", value);
+  return obj;
+}
+
+static napi_value DiskUsage(napi_env env, napi_callback_info backInfo) {
   size_t argc = 1;
   napi_value argv[1];
   napi_get_cb_info(env, backInfo, &argc, argv, 0, 0);
-  size_t vallen;
-  size_t valRes;
-  napi_get_value_string_utf8(env, argv[0], NULL, 0, &vallen);
-  char path[vallen + 1];
-  napi_get_value_string_utf8(env, argv[0], path, vallen + 1, &valRes);
-  struct statvfs info = {};
-  int ret = statvfs(path, &info);
-  if (ret) {
-    int errnum = errno;
+  string path;
+  NAPI_ASSIGN_STD_STRING(env, path, argv[0]);
+  DiskUsageInfo info;
+  int errnum = diskUsageCache.query(path, info);
+  if (errnum != 0) {
     napi_throw_error(env, NULL, strerror(errnum));
     return NULL;
   }
-  napi_value obj;
-  napi_create_object(env, &obj);
-  char availableChar[] = "available";
-  napi_create_string_utf8(env, availableChar, strlen(availableChar), &key);
-  napi_create_double(env, info.f_bavail * info.f_frsize, &value);
-  napi_set_property(env, obj, key, value);
-  char freeChar[] = "free";
-  napi_create_string_utf8(env, freeChar, strlen(freeChar), &key);
-  napi_create_double(env, info.f_bfree * info.f_frsize, &value);
-  napi_set_property(env, obj, key, value);
-  char totalChar[] = "total";
-  napi_create_string_utf8(env, totalChar, strlen(totalChar), &key);
-  napi_create_double(env, info.f_blocks * info.f_frsize, &value);
-  napi_set_property(env, obj, key, value);
-  return obj;
+  return CreateDiskUsage(env, info);
+}
+
+static void DoDiskUsageBatch(napi_env env, void* data) {
+  disk_usage_carrier* c = static_cast<disk_usage_carrier*>(data);
+  c->_errors.resize(c->_paths.size());
+  c->_results.resize(c->_paths.size());
+  for (size_t i = 0; i < c->_paths.size(); i++) {
+    c->_errors[i] = diskUsageCache.query(c->_paths[i], c->_results[i]);
+  }
+}
+
+static void AfterDiskUsageBatch(napi_env env, napi_status status, void* data) {
+  disk_usage_carrier* c = static_cast<disk_usage_carrier*>(data);
+  napi_handle_scope scope;
+  napi_value global;
+  napi_value callback;
+  napi_value argv[2];
+
+  napi_open_handle_scope(env, &scope);
+  napi_get_global(env, &global);
+  napi_get_null(env, &argv[0]);
+  napi_create_array_with_length(env, c->_paths.size(), &argv[1]);
+  for (size_t i = 0; status == napi_ok && i < c->_paths.size(); i++) {
+    napi_value item;
+    napi_value value;
+    if (c->_errors[i] != 0) {
+      napi_create_object(env, &item);
+      napi_create_string_utf8(env, strerror(c->_errors[i]), NAPI_AUTO_LENGTH,
+                              &value);
+      napi_set_named_property(env, item, "error", value);
+    } else {
+      item = CreateDiskUsage(env, c->_results[i]);
+    }
+    napi_create_string_utf8(env, c->_paths[i].c_str(), c->_paths[i].size(),
+                            &value);
+    napi_set_named_property(env, item, "path", value);
+    napi_set_element(env, argv[1], i, item);
+  }
+  if (status != napi_ok) {
+    napi_value message;
+    napi_create_string_utf8(env, "failed to get the disk usage",
+                            NAPI_AUTO_LENGTH, &message);
+    napi_create_error(env, nullptr, message, &argv[0]);
+  }
+  napi_get_reference_value(env, c->_callback, &callback);
+  napi_make_callback(env, nullptr, global, callback, 2, argv, nullptr);
+  napi_close_handle_scope(env, scope);
+
+  napi_delete_reference(env, c->_callback);
+  napi_delete_async_work(env, c->_request);
+  delete c;
+}
+
+/**
+ * diskUsageBatch(paths, callback) gets the usages of the mount points on the
+ * thread pool, the callback gets an array of the usages or `{ error }` in
+ * the order of the paths.
+ */
+static napi_value DiskUsageBatch(napi_env env, napi_callback_info info) {
+  size_t argc = 2;
+  napi_value argv[2];
+  uint32_t len = 0;
+  napi_value resource_name;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, 0, 0));
+  NAPI_ASSERT(env, argc >= 2, "expect 2 arguments");
+
+  disk_usage_carrier* c = new disk_usage_carrier();
+  napi_get_array_length(env, argv[0], &len);
+  for (uint32_t i = 0; i < len; i++) {
+    napi_value item;
+    string path;
+    napi_get_element(env, argv[0], i, &item);
+    NAPI_ASSIGN_STD_STRING(env, path, item);
+    c->_paths.push_back(path);
+  }
+  napi_create_string_utf8(env, "diskUsageBatch", NAPI_AUTO_LENGTH,
+                          &resource_name);
+  napi_create_reference(env, argv[1], 1, &c->_callback);
+  napi_create_async_work(env, argv[1], resource_name, DoDiskUsageBatch,
+                         AfterDiskUsageBatch, c, &c->_request);
+  napi_queue_async_work(env, c->_request);
+  return NULL;
+}
+
+/**
+ * invalidateDiskUsage(path) drops the cached usages of the filesystem at the
+ * path, or all of them without a path.
+ */
+static napi_value InvalidateDiskUsage(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value argv[1];
+  napi_valuetype type = napi_undefined;
+  string path;
+  napi_get_cb_info(env, info, &argc, argv, 0, 0);
+  if (argc >= 1) {
+    napi_typeof(env, argv[0], &type);
+  }
+  if (type == napi_string) {
+    NAPI_ASSIGN_STD_STRING(env, path, argv[0]);
+  }
+  diskUsageCache.invalidate(path);
+  return NULL;
 }
 
 static napi_value Strptime(napi_env env, napi_callback_info info) {
@@ -214,6 +462,101 @@ static napi_value Strptime(napi_env env, napi_callback_info info) {
   return obj;
 }
 
+/**
+ * startSampler(pids, interval, capacity)
+ * samples the processes, 0 for the current one, every `interval` ms.
+ */
+static napi_value StartSampler(napi_env env, napi_callback_info info) {
+  size_t argc = 3;
+  napi_value argv[3];
+  uint32_t len = 0;
+  int interval;
+  int capacity;
+  vector<int> pids;
+  napi_value returnVal;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, 0, 0));
+  NAPI_CALL(env, napi_get_array_length(env, argv[0], &len));
+  for (uint32_t i = 0; i < len; i++) {
+    napi_value item;
+    int pid;
+    NAPI_CALL(env, napi_get_element(env, argv[0], i, &item));
+    NAPI_CALL(env, napi_get_value_int32(env, item, &pid));
+    pids.push_back(pid);
+  }
+  NAPI_CALL(env, napi_get_value_int32(env, argv[1], &interval));
+  NAPI_CALL(env, napi_get_value_int32(env, argv[2], &capacity));
+  bool started = sampler.start(pids, interval > 0 ? interval : 0,
+                               capacity > 0 ? capacity : 0);
+  napi_get_boolean(env, started, &returnVal);
+  return returnVal;
+}
+
+static napi_value StopSampler(napi_env env, napi_callback_info info) {
+  napi_value returnVal;
+  sampler.stop();
+  napi_get_undefined(env, &returnVal);
+  return returnVal;
+}
+
+static napi_value GetSamples(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value argv[1];
+  double since = 0;
+  vector<ResourceSample> samples;
+  napi_value returnVal;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, 0, 0));
+  if (argc > 0) {
+    napi_get_value_double(env, argv[0], &since);
+  }
+  sampler.history(samples, since > 0 ? (uint64_t)since : 0);
+  NAPI_CALL(env, napi_create_array_with_length(env, samples.size(),
+                                               &returnVal));
+  for (size_t i = 0; i < samples.size(); i++) {
+    const ResourceSample& s = samples[i];
+    napi_value obj;
+    napi_value value;
+    napi_create_object(env, &obj);
+    napi_create_double(env, s.time, &value);
+    napi_set_named_property(env, obj, "time", value);
+    napi_create_int32(env, s.pid, &value);
+    napi_set_named_property(env, obj, "pid", value);
+    napi_create_int32(env, s.threads, &value);
+    napi_set_named_property(env, obj, "threads", value);
+    napi_create_double(env, s.rss, &value);
+    napi_set_named_property(env, obj, "rss", value);
+    napi_create_double(env, s.pss, &value);
+    napi_set_named_property(env, obj, "pss", value);
+    napi_create_double(env, s.private_dirty, &value);
+    napi_set_named_property(env, obj, "privateDirty", value);
+    napi_create_double(env, s.swap, &value);
+    napi_set_named_property(env, obj, "swap", value);
+    napi_create_double(env, s.cpu, &value);
+    napi_set_named_property(env, obj, "cpu", value);
+    napi_create_double(env, s.mem_free, &value);
+    napi_set_named_property(env, obj, "memFree", value);
+    napi_create_double(env, s.mem_available, &value);
+    napi_set_named_property(env, obj, "memAvailable", value);
+    napi_set_element(env, returnVal, i, obj);
+  }
+  return returnVal;
+}
+
+static napi_value DumpSamples(napi_env env, napi_callback_info info) {
+  size_t argc = 2;
+  napi_value argv[2];
+  int format;
+  size_t vallen;
+  size_t valRes;
+  napi_value returnVal;
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, 0, 0));
+  napi_get_value_string_utf8(env, argv[0], NULL, 0, &vallen);
+  char path[vallen + 1];
+  napi_get_value_string_utf8(env, argv[0], path, vallen + 1, &valRes);
+  NAPI_CALL(env, napi_get_value_int32(env, argv[1], &format));
+  napi_create_int32(env, sampler.dump(path, format), &returnVal);
+  return returnVal;
+}
+
 static napi_value Init(napi_env env, napi_value exports) {
   napi_property_descriptor desc[] = {
     DECLARE_NAPI_PROPERTY("powerOff", PowerOff),
@@ -225,9 +568,17 @@ static napi_value Init(napi_env env, napi_value exports) {
     DECLARE_NAPI_PROPERTY("setRecoveryMode", SetRecoveryMode),
     DECLARE_NAPI_PROPERTY("setRecoveryOk", SetRecoveryOk),
     DECLARE_NAPI_PROPERTY("diskUsage", DiskUsage),
+    DECLARE_NAPI_PROPERTY("diskUsageBatch", DiskUsageBatch),
+    DECLARE_NAPI_PROPERTY("invalidateDiskUsage", InvalidateDiskUsage),
     DECLARE_NAPI_PROPERTY("strptime", Strptime),
+    DECLARE_NAPI_PROPERTY("startSampler", StartSampler),
+    DECLARE_NAPI_PROPERTY("stopSampler", StopSampler),
+    DECLARE_NAPI_PROPERTY("getSamples", GetSamples),
+    DECLARE_NAPI_PROPERTY("dumpSamples", DumpSamples),
   };
   napi_define_properties(env, exports, sizeof(desc) / sizeof(*desc), desc);
+  NAPI_SET_CONSTANT(exports, SAMPLER_FORMAT_CSV);
+  NAPI_SET_CONSTANT(exports, SAMPLER_FORMAT_JSON);
   return exports;
 }
 
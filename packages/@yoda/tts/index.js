@@ -39,19 +39,30 @@ var TTSEvents = [
    */
   'error' // 4: error
 ]
+/**
+ * tts trace event, fired after the request is drained if the trace is enabled.
+ * @event module:@yoda/tts~TtsProxy#trace
+ * @type {number} id - the task id.
+ * @type {module:@yoda/tts~PlaybackStats} stats - the stats of the task.
+ */
 
 // reference to handle
 var refs = {}
+// the phrase cache, the ids of the cached phrases and the queued utterances
+// start from 0x40000000.
+var DEFAULT_CACHE_DIR = '/data/cache/tts'
+var DEFAULT_CACHE_SIZE = 8 * 1024 * 1024
 
 /**
  * @constructor
  * @param {Object} handle
  * @param {String} text - the text to speak
  * @param {Function} callback
+ * @param {Boolean} [queued] - if the text is queued after the others.
  */
-function TtsRequest (handle, text, callback) {
+function TtsRequest (handle, text, callback, queued) {
   // this handleId for manager handle
-  this._handleId = handle.speak(text)
+  this._handleId = queued ? handle.enqueue(text) : handle.speak(text)
   // this id for userspace
   this.id = this._handleId
   this.handle = handle
@@ -72,6 +83,14 @@ TtsRequest.prototype.stop = function () {
   return this.handle.cancel(this._handleId)
 }
 
+/**
+ * get the playback stats of this request.
+ * @returns {module:@yoda/tts~PlaybackStats}
+ */
+TtsRequest.prototype.getStats = function () {
+  return this.handle.getStats(this._handleId)
+}
+
 /**
  * onstart
  * @private
@@ -119,9 +138,10 @@ function TtsProxy (handle) {
   EventEmitter.call(this)
   if (!handle) { throw new TypeError('handle must be specified') }
 
-  this._requests = []
+  this._requests = {}
   this._handle = handle
   this._handle.onevent = this.onevent.bind(this)
+  this._handle.ontrace = this.ontrace.bind(this)
 }
 inherits(TtsProxy, EventEmitter)
 
@@ -145,6 +165,23 @@ TtsProxy.prototype.onevent = function (name, handleId, errno) {
   }
 }
 
+/**
+ * @private
+ */
+TtsProxy.prototype.ontrace = function (handleId, stats) {
+  this.emit('trace', handleId, stats)
+}
+
+/**
+ * enable or disable the trace event, which reports the stats of each request
+ * once it's drained.
+ * @param {Boolean} enabled
+ * @fires module:@yoda/tts~TtsProxy#trace
+ */
+TtsProxy.prototype.setTrace = function (enabled) {
+  this._handle.setTrace(!!enabled)
+}
+
 /**
  * @param {String} text
  * @param {Function} cb - fired when tts is done
@@ -156,20 +193,72 @@ TtsProxy.prototype.speak = function (text, cb) {
   return req
 }
 
+/**
+ * Queues the text after the queued ones, it's synthesized while the previous
+ * one is still playing, so there is no gap between the utterances.
+ * @param {String} text
+ * @param {Function} cb - fired when this utterance is done
+ * @returns {module:@yoda/tts~TtsRequest}
+ */
+TtsProxy.prototype.enqueue = function (text, cb) {
+  var req = new TtsRequest(this._handle, text, cb, true)
+  this._requests[req._handleId] = req
+  return req
+}
+
+/**
+ * cancel the queued utterances including the playing one.
+ * @fires module:@yoda/tts~TtsProxy#cancel
+ */
+TtsProxy.prototype.cancelQueue = function () {
+  return this._handle.cancelQueue()
+}
+
+/**
+ * @typedef PlaybackStats
+ * @property {Number} frames - the received voice frames.
+ * @property {Number} underruns - how many times the playback ran out of frames
+ *   before the end.
+ * @property {Number} depth - the queued voice frames.
+ * @property {Number} maxDepth - the maximum of the queued voice frames.
+ * @property {Number} targetDepth - the depth the jitter buffer waited for, it's
+ *   sized from the inter-arrival jitter.
+ * @property {Number} jitter - the estimated inter-arrival jitter in ms.
+ * @property {Number} timeToFirstAudio - the ms from the start event to the
+ *   first frame being played, -1 if not played yet.
+ * @property {Object} latency - the ms of each stage since the speak is issued,
+ *   -1 if the stage is not reached yet.
+ * @property {Number} latency.start - the start event is received.
+ * @property {Number} latency.firstVoice - the first voice frame is received.
+ * @property {Number} latency.firstAudio - the first frame is handed to the
+ *   player.
+ * @property {Number} latency.drained - the playback is drained.
+ */
+
+/**
+ * get the playback stats of the given request id, the stats are kept for the
+ * latest 32 requests.
+ * @param {Number} id - the request id.
+ * @returns {module:@yoda/tts~PlaybackStats|undefined}
+ */
+TtsProxy.prototype.getStats = function (id) {
+  return this._handle.getStats(id)
+}
+
 /**
  * stop all task
  */
 TtsProxy.prototype.stopAll = function () {
-  for (var i = 0; i < this._requests.length; i++) {
-    this._requests[i].stop()
-  }
+  Object.keys(this._requests).forEach((id) => {
+    this._requests[id].stop()
+  })
 }
 
 /**
  * disconnect
  */
 TtsProxy.prototype.disconnect = function () {
-  this._requests.length = 0
+  this._requests = {}
   this.removeAllListeners()
   this._handle.disconnect()
 }
@@ -186,6 +275,9 @@ function createHandle (options) {
   if (!options.key) { throw new TypeError('options.key is required') }
 
   var handle = refs.handle = new TtsWrap()
+  handle.setCache(
+    options.cacheDir || DEFAULT_CACHE_DIR,
+    options.cacheSize == null ? DEFAULT_CACHE_SIZE : options.cacheSize)
   handle.prepare(
     options.host || 'apigwws.open.rokid.com', 443, '/api',
     options.key,
@@ -205,6 +297,10 @@ function createHandle (options) {
  * @param {String} options.secret - the secret
  * @param {String} options.deviceId - the device id
  * @param {String} options.deviceTypeId - the device type id
+ * @param {String} [options.cacheDir=/data/cache/tts] - the directory of the
+ *   phrase cache, the completed phrases are replayed from here.
+ * @param {Number} [options.cacheSize=8388608] - the maximum bytes of the phrase
+ *   cache, 0 to disable it.
  * @returns {module:@yoda/tts~TtsProxy}
  * @fires module:@yoda/tts~TtsProxy#voice
  * @fires module:@yoda/tts~TtsProxy#start
@@ -0,0 +1,354 @@
+#include "TtsCache.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <algorithm>
+
+TtsCacheEntry::~TtsCacheEntry() {
+  if (base != NULL && base != MAP_FAILED) {
+    munmap(base, length);
+  }
+}
+
+TtsCache::TtsCache() {
+  pthread_mutex_init(&mutex, NULL);
+  pthread_cond_init(&cond, NULL);
+}
+
+TtsCache::~TtsCache() {
+  pthread_mutex_lock(&mutex);
+  stopping = true;
+  pthread_cond_signal(&cond);
+  pthread_mutex_unlock(&mutex);
+  if (started)
+    pthread_join(writer, NULL);
+  pthread_cond_destroy(&cond);
+  pthread_mutex_destroy(&mutex);
+}
+
+void TtsCache::configure(const char* dir_, size_t max_size_) {
+  pthread_mutex_lock(&mutex);
+  dir.assign(dir_);
+  max_size = max_size_;
+  recordings.clear();
+  finished.clear();
+  pending = false;
+  pending_id = -1;
+  if (max_size_ > 0 && !started) {
+    int r = pthread_create(&writer, NULL, TtsCache::Run, this);
+    if (r != 0) {
+      fprintf(stderr, "tts cache: cannot start the writer(%d)\n", r);
+      max_size = 0;
+    } else {
+      started = true;
+    }
+  }
+  pthread_mutex_unlock(&mutex);
+
+  if (max_size_ > 0 && mkdir(dir_, 0755) != 0 && errno != EEXIST) {
+    fprintf(stderr, "tts cache: cannot create %s(%d)\n", dir_, errno);
+  }
+}
+
+bool TtsCache::enabled() {
+  pthread_mutex_lock(&mutex);
+  bool ret = max_size > 0 && !dir.empty();
+  pthread_mutex_unlock(&mutex);
+  return ret;
+}
+
+string TtsCache::makeKey(const char* text, const string& declaimer,
+                         const char* codec) {
+  string key(codec);
+  key.push_back('\0');
+  key.append(declaimer);
+  key.push_back('\0');
+  key.append(text);
+  return key;
+}
+
+string TtsCache::pathOf(const string& key) {
+  // FNV-1a, the full key is stored in the file to detect the collisions.
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < key.size(); i++) {
+    hash ^= (unsigned char)key[i];
+    hash *= 1099511628211ULL;
+  }
+  char name[32];
+  snprintf(name, sizeof(name), "/%016llx.opu", (unsigned long long)hash);
+  return dir + name;
+}
+
+shared_ptr<TtsCacheEntry> TtsCache::lookup(const string& key) {
+  if (!enabled())
+    return NULL;
+
+  pthread_mutex_lock(&mutex);
+  string path = pathOf(key);
+  pthread_mutex_unlock(&mutex);
+
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return NULL;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    close(fd);
+    return NULL;
+  }
+  size_t length = (size_t)st.st_size;
+  void* base = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED)
+    return NULL;
+
+  shared_ptr<TtsCacheEntry> entry(new TtsCacheEntry(base, length));
+  const char* data = static_cast<const char*>(base);
+  size_t pos = 4 + sizeof(uint32_t);
+  uint32_t size;
+  if (length < pos || memcmp(data, TTS_CACHE_MAGIC, 4) != 0)
+    goto invalid;
+  memcpy(&size, data + 4, sizeof(size));
+  if (size != key.size() || length - pos < size ||
+      memcmp(data + pos, key.data(), size) != 0) {
+    // a collision, keep the file since it's valid for another key.
+    return NULL;
+  }
+  pos += size;
+  while (pos < length) {
+    if (length - pos < sizeof(size))
+      goto invalid;
+    memcpy(&size, data + pos, sizeof(size));
+    pos += sizeof(size);
+    if (size == 0 || length - pos < size)
+      goto invalid;
+    entry->offsets.push_back(pos);
+    entry->sizes.push_back(size);
+    pos += size;
+  }
+  if (entry->count() == 0)
+    goto invalid;
+  // refresh the mtime for the LRU eviction
+  utimes(path.c_str(), NULL);
+  return entry;
+
+invalid:
+  fprintf(stderr, "tts cache: drop the corrupted %s\n", path.c_str());
+  unlink(path.c_str());
+  return NULL;
+}
+
+void TtsCache::expect(const string& key) {
+  pthread_mutex_lock(&mutex);
+  if (max_size > 0) {
+    pending_key = key;
+    pending = true;
+    pending_id = -1;
+  }
+  pthread_mutex_unlock(&mutex);
+}
+
+void TtsCache::bind(int id) {
+  pthread_mutex_lock(&mutex);
+  if (!pending) {
+    pthread_mutex_unlock(&mutex);
+    return;
+  }
+  pending = false;
+  if (pending_id != -1 && pending_id != id) {
+    // a start event of another request claimed the key
+    recordings.erase(pending_id);
+  }
+  if (id >= 0 && pending_id != id) {
+    Recording& rec = recordings[id];
+    rec.key.swap(pending_key);
+    rec.started = false;
+    rec.done = false;
+    rec.frames.clear();
+  } else if (id >= 0) {
+    map<int, Recording>::iterator it = recordings.find(id);
+    if (it != recordings.end() && it->second.done)
+      complete(it);
+  }
+  pending_key.clear();
+  pending_id = -1;
+  pthread_mutex_unlock(&mutex);
+}
+
+void TtsCache::start(int id) {
+  pthread_mutex_lock(&mutex);
+  map<int, Recording>::iterator it = recordings.find(id);
+  if (it != recordings.end()) {
+    it->second.started = true;
+  } else if (pending && pending_id == -1) {
+    // the request is not returned yet, see `expect`
+    Recording& rec = recordings[id];
+    rec.key = pending_key;
+    rec.started = true;
+    rec.done = false;
+    rec.frames.clear();
+    pending_id = id;
+  }
+  pthread_mutex_unlock(&mutex);
+}
+
+void TtsCache::append(int id, const char* data, size_t size) {
+  pthread_mutex_lock(&mutex);
+  map<int, Recording>::iterator it = recordings.find(id);
+  if (it != recordings.end() && it->second.started) {
+    Recording& rec = it->second;
+    if (rec.frames.size() + size > max_size) {
+      // never fits into the store
+      recordings.erase(it);
+    } else {
+      uint32_t len = (uint32_t)size;
+      rec.frames.append(reinterpret_cast<const char*>(&len), sizeof(len));
+      rec.frames.append(data, size);
+    }
+  }
+  pthread_mutex_unlock(&mutex);
+}
+
+void TtsCache::finish(int id) {
+  pthread_mutex_lock(&mutex);
+  map<int, Recording>::iterator it = recordings.find(id);
+  if (it != recordings.end()) {
+    if (pending && pending_id == id) {
+      // completed by `bind` once the key is confirmed
+      it->second.done = true;
+    } else {
+      complete(it);
+    }
+  }
+  pthread_mutex_unlock(&mutex);
+}
+
+// moves the recording to the ones to be written, the mutex must be held.
+void TtsCache::complete(map<int, Recording>::iterator it) {
+  if (it->second.started && !it->second.frames.empty()) {
+    finished.push_back(Recording());
+    Recording& rec = finished.back();
+    rec.key.swap(it->second.key);
+    rec.frames.swap(it->second.frames);
+    rec.started = true;
+    rec.done = true;
+  }
+  recordings.erase(it);
+}
+
+void TtsCache::flush() {
+  pthread_mutex_lock(&mutex);
+  if (!finished.empty()) {
+    for (size_t i = 0; i < finished.size(); i++) {
+      writing.push_back(Recording());
+      writing.back().key.swap(finished[i].key);
+      writing.back().frames.swap(finished[i].frames);
+    }
+    finished.clear();
+    pthread_cond_signal(&cond);
+  }
+  pthread_mutex_unlock(&mutex);
+}
+
+void* TtsCache::Run(void* data) {
+  TtsCache* self = static_cast<TtsCache*>(data);
+  self->loop();
+  return NULL;
+}
+
+void TtsCache::loop() {
+  vector<Recording> recs;
+  pthread_mutex_lock(&mutex);
+  for (;;) {
+    while (!stopping && writing.empty()) {
+      pthread_cond_wait(&cond, &mutex);
+    }
+    if (stopping)
+      break;
+    recs.swap(writing);
+    pthread_mutex_unlock(&mutex);
+
+    for (size_t i = 0; i < recs.size(); i++) {
+      write(recs[i]);
+    }
+    recs.clear();
+    evict();
+    pthread_mutex_lock(&mutex);
+  }
+  pthread_mutex_unlock(&mutex);
+}
+
+void TtsCache::write(const Recording& rec) {
+  pthread_mutex_lock(&mutex);
+  string path = pathOf(rec.key);
+  pthread_mutex_unlock(&mutex);
+
+  string tmp = path + ".tmp";
+  FILE* fp = fopen(tmp.c_str(), "wb");
+  if (fp == NULL) {
+    fprintf(stderr, "tts cache: cannot write %s(%d)\n", tmp.c_str(), errno);
+    return;
+  }
+  uint32_t len = (uint32_t)rec.key.size();
+  bool ok = fwrite(TTS_CACHE_MAGIC, 1, 4, fp) == 4 &&
+            fwrite(&len, sizeof(len), 1, fp) == 1 &&
+            fwrite(rec.key.data(), 1, len, fp) == len &&
+            fwrite(rec.frames.data(), 1, rec.frames.size(), fp) ==
+                rec.frames.size();
+  if (fclose(fp) != 0 || !ok || rename(tmp.c_str(), path.c_str()) != 0) {
+    unlink(tmp.c_str());
+  }
+}
+
+void TtsCache::abort(int id) {
+  pthread_mutex_lock(&mutex);
+  recordings.erase(id);
+  pthread_mutex_unlock(&mutex);
+}
+
+static bool compare_mtime(const pair<time_t, string>& a,
+                          const pair<time_t, string>& b) {
+  return a.first < b.first;
+}
+
+void TtsCache::evict() {
+  pthread_mutex_lock(&mutex);
+  string root = dir;
+  size_t limit = max_size;
+  pthread_mutex_unlock(&mutex);
+
+  DIR* dp = opendir(root.c_str());
+  if (dp == NULL)
+    return;
+  vector<pair<time_t, string> > files;
+  map<string, size_t> sizes;
+  size_t total = 0;
+  struct dirent* ent;
+  while ((ent = readdir(dp)) != NULL) {
+    size_t namelen = strlen(ent->d_name);
+    if (namelen < 4 || strcmp(ent->d_name + namelen - 4, ".opu") != 0)
+      continue;
+    string path = root + "/" + ent->d_name;
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+      continue;
+    files.push_back(make_pair(st.st_mtime, path));
+    sizes[path] = (size_t)st.st_size;
+    total += (size_t)st.st_size;
+  }
+  closedir(dp);
+  if (total <= limit)
+    return;
+
+  sort(files.begin(), files.end(), compare_mtime);
+  for (size_t i = 0; i < files.size() && total > limit; i++) {
+    if (unlink(files[i].second.c_str()) == 0) {
+      total -= sizes[files[i].second];
+    }
+  }
+}
@@ -0,0 +1,133 @@
+#ifndef TTS_CACHE_H
+#define TTS_CACHE_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+using namespace std;
+
+#define TTS_CACHE_DEFAULT_DIR "/data/cache/tts"
+#define TTS_CACHE_DEFAULT_SIZE (8 * 1024 * 1024)
+#define TTS_CACHE_MAGIC "YTC1"
+
+/**
+ * @class TtsCacheEntry
+ * A read-only mapping of a cached phrase, the voice frames point into the
+ * mapped file and stay valid as long as the entry is referenced.
+ */
+class TtsCacheEntry {
+ public:
+  TtsCacheEntry(void* base_, size_t length_) {
+    base = base_;
+    length = length_;
+  };
+  ~TtsCacheEntry();
+
+  size_t count() const {
+    return offsets.size();
+  };
+  const char* data(size_t index) const {
+    return static_cast<const char*>(base) + offsets[index];
+  };
+  size_t size(size_t index) const {
+    return sizes[index];
+  };
+
+ private:
+  friend class TtsCache;
+  void* base;
+  size_t length;
+  vector<size_t> offsets;
+  vector<size_t> sizes;
+};
+
+/**
+ * @class TtsCache
+ * The on-device store of the synthesized voice frames, keyed by the text, the
+ * declaimer and the codec. A phrase is recorded while it's received from the
+ * cloud and is only persisted once it has been completed, the least recently
+ * used phrases are evicted when the store exceeds its size. The files are
+ * written and evicted on the writer thread of the cache.
+ */
+class TtsCache {
+ public:
+  TtsCache();
+  ~TtsCache();
+
+  /**
+   * @method configure
+   * @param {const char*} dir - the directory of the store.
+   * @param {size_t} max_size - the maximum bytes of the store, 0 to disable.
+   */
+  void configure(const char* dir, size_t max_size);
+  bool enabled();
+  static string makeKey(const char* text, const string& declaimer,
+                        const char* codec);
+  /**
+   * @method lookup
+   * @return {shared_ptr<TtsCacheEntry>} the mapped phrase or NULL if missed.
+   */
+  shared_ptr<TtsCacheEntry> lookup(const string& key);
+
+  /**
+   * records the frames of the next request, it's called before the request is
+   * issued so that its start event is never missed. The first start event of
+   * an unknown id claims the key until `bind` tells the actual id, a key
+   * claimed by another id is dropped.
+   */
+  void expect(const string& key);
+  /**
+   * binds the expected key to the id returned by the request, or drops it if
+   * the id is negative.
+   */
+  void bind(int id);
+  void start(int id);
+  void append(int id, const char* data, size_t size);
+  /**
+   * completes the recording of the id, it's written by the next `flush`.
+   */
+  void finish(int id);
+  /**
+   * hands the completed recordings to the writer thread, it never blocks on
+   * the file I/O.
+   */
+  void flush();
+  void abort(int id);
+
+ private:
+  struct Recording {
+    string key;
+    bool started;
+    // the end event is observed before the key is bound
+    bool done;
+    string frames;
+  };
+  string pathOf(const string& key);
+  void complete(map<int, Recording>::iterator it);
+  static void* Run(void* data);
+  void loop();
+  void write(const Recording& rec);
+  void evict();
+
+ private:
+  pthread_mutex_t mutex;
+  string dir;
+  size_t max_size = 0;
+  map<int, Recording> recordings;
+  // the recordings waiting for `flush`, and the ones handed to the writer
+  vector<Recording> finished;
+  vector<Recording> writing;
+  pthread_t writer;
+  pthread_cond_t cond;
+  bool started = false;
+  bool stopping = false;
+  // the key of the request being issued and the id which claimed it
+  string pending_key;
+  bool pending = false;
+  int pending_id = -1;
+};
+
+#endif
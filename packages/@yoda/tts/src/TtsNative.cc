@@ -40,6 +40,77 @@ void TtsNative::AfterEvent(uv_handle_t* handle) {
   delete handle;
 }
 
+static double iotjs_tts_elapsed(uint64_t from, uint64_t to) {
+  if (from == 0 || to == 0 || to < from)
+    return -1;
+  return (to - from) / 1e6;
+}
+
+static jerry_value_t iotjs_tts_create_stats(const TtsPlaybackStats& stats) {
+  jerry_value_t jstats = jerry_create_object();
+  iotjs_jval_set_property_number(jstats, "frames", stats.frames);
+  iotjs_jval_set_property_number(jstats, "underruns", stats.underruns);
+  iotjs_jval_set_property_number(jstats, "depth", stats.depth);
+  iotjs_jval_set_property_number(jstats, "maxDepth", stats.max_depth);
+  iotjs_jval_set_property_number(jstats, "targetDepth", stats.target_depth);
+  iotjs_jval_set_property_number(jstats, "jitter", stats.jitter);
+  iotjs_jval_set_property_number(jstats, "timeToFirstAudio",
+                                 stats.time_to_first_audio);
+
+  // the elapsed ms of each stage since the utterance is issued
+  jerry_value_t jlatency = jerry_create_object();
+  uint64_t issued = stats.issued_at;
+  iotjs_jval_set_property_number(jlatency, "start",
+                                 iotjs_tts_elapsed(issued, stats.started_at));
+  iotjs_jval_set_property_number(jlatency, "firstVoice",
+                                 iotjs_tts_elapsed(issued,
+                                                   stats.first_voice_at));
+  iotjs_jval_set_property_number(jlatency, "firstAudio",
+                                 iotjs_tts_elapsed(issued,
+                                                   stats.first_audio_at));
+  iotjs_jval_set_property_number(jlatency, "drained",
+                                 iotjs_tts_elapsed(issued, stats.drained_at));
+  iotjs_jval_set_property_jval(jstats, "latency", jlatency);
+  jerry_release_value(jlatency);
+  return jstats;
+}
+
+void TtsNative::SendTrace(void* self, int id, const TtsPlaybackStats& stats) {
+  TtsNative* native = static_cast<TtsNative*>(self);
+  uv_async_t* async_handle = new uv_async_t;
+  iotjs_tts_trace_t* trace = new iotjs_tts_trace_t;
+
+  trace->ttswrap = native->ttswrap;
+  trace->id = id;
+  trace->stats = stats;
+  async_handle->data = (void*)trace;
+
+  uv_async_init(uv_default_loop(), async_handle, TtsNative::OnTrace);
+  uv_async_send(async_handle);
+}
+
+void TtsNative::OnTrace(uv_async_t* handle) {
+  iotjs_tts_trace_t* trace = (iotjs_tts_trace_t*)handle->data;
+  iotjs_tts_t* ttswrap = trace->ttswrap;
+  IOTJS_VALIDATED_STRUCT_METHOD(iotjs_tts_t, ttswrap);
+
+  jerry_value_t jthis = iotjs_jobjectwrap_jobject(&_this->jobjectwrap);
+  jerry_value_t ontrace = iotjs_jval_get_property(jthis, "ontrace");
+  if (jerry_value_is_function(ontrace)) {
+    jerry_value_t jstats = iotjs_tts_create_stats(trace->stats);
+    iotjs_jargs_t jargs = iotjs_jargs_create(2);
+    iotjs_jargs_append_number(&jargs, (double)trace->id);
+    iotjs_jargs_append_jval(&jargs, jstats);
+    iotjs_make_callback(ontrace, jerry_create_undefined(), &jargs);
+    iotjs_jargs_destroy(&jargs);
+    jerry_release_value(jstats);
+  }
+  jerry_release_value(ontrace);
+
+  delete trace;
+  uv_close((uv_handle_t*)handle, TtsNative::AfterEvent);
+}
+
 static void iotjs_tts_destroy(iotjs_tts_t* tts) {
   IOTJS_VALIDATED_STRUCT_DESTRUCTOR(iotjs_tts_t, tts);
   if (_this->handle) {
@@ -184,6 +255,26 @@ JS_FUNCTION(Speak) {
   return jerry_create_number(id);
 }
 
+JS_FUNCTION(Enqueue) {
+  JS_DECLARE_THIS_PTR(tts, tts);
+  IOTJS_VALIDATED_STRUCT_METHOD(iotjs_tts_t, tts);
+
+  if (_this->handle == NULL) {
+    return JS_CREATE_ERROR(COMMON, "tts is not initialized");
+  }
+  if (jargc == 0) {
+    return JS_CREATE_ERROR(COMMON, "first argument should be a string");
+  }
+
+  jerry_size_t size = jerry_get_utf8_string_size(jargv[0]);
+  jerry_char_t text_buf[size + 1];
+  jerry_string_to_utf8_char_buffer(jargv[0], text_buf, size);
+  text_buf[size] = '\0';
+
+  int32_t id = _this->handle->enqueue((char*)&text_buf);
+  return jerry_create_number(id);
+}
+
 JS_FUNCTION(Cancel) {
   JS_DECLARE_THIS_PTR(tts, tts);
   IOTJS_VALIDATED_STRUCT_METHOD(iotjs_tts_t, tts);
@@ -196,6 +287,17 @@ JS_FUNCTION(Cancel) {
   return jerry_create_boolean(true);
 }
 
+JS_FUNCTION(CancelQueue) {
+  JS_DECLARE_THIS_PTR(tts, tts);
+  IOTJS_VALIDATED_STRUCT_METHOD(iotjs_tts_t, tts);
+
+  if (_this->handle == NULL) {
+    return JS_CREATE_ERROR(COMMON, "tts is not initialized");
+  }
+  _this->handle->cancelQueue();
+  return jerry_create_boolean(true);
+}
+
 JS_FUNCTION(Disconnect) {
   JS_DECLARE_THIS_PTR(tts, tts);
   IOTJS_VALIDATED_STRUCT_METHOD(iotjs_tts_t, tts);
@@ -219,6 +321,53 @@ JS_FUNCTION(Reconnect) {
   return jerry_create_undefined();
 }
 
+JS_FUNCTION(SetCache) {
+  JS_DECLARE_THIS_PTR(tts, tts);
+  IOTJS_VALIDATED_STRUCT_METHOD(iotjs_tts_t, tts);
+
+  if (_this->handle == NULL) {
+    return JS_CREATE_ERROR(COMMON, "tts is not initialized");
+  }
+  if (jargc < 2 || !jerry_value_is_string(jargv[0])) {
+    return JS_CREATE_ERROR(COMMON, "dir and size are required");
+  }
+  jerry_size_t size = jerry_get_utf8_string_size(jargv[0]);
+  jerry_char_t dir_buf[size + 1];
+  jerry_string_to_utf8_char_buffer(jargv[0], dir_buf, size);
+  dir_buf[size] = '\0';
+
+  double max_size = JS_GET_ARG(1, number);
+  _this->handle->setCache((char*)&dir_buf,
+                          max_size > 0 ? (size_t)max_size : 0);
+  return jerry_create_undefined();
+}
+
+JS_FUNCTION(GetStats) {
+  JS_DECLARE_THIS_PTR(tts, tts);
+  IOTJS_VALIDATED_STRUCT_METHOD(iotjs_tts_t, tts);
+
+  if (_this->handle == NULL) {
+    return JS_CREATE_ERROR(COMMON, "tts is not initialized");
+  }
+  int id = JS_GET_ARG(0, number);
+  TtsPlaybackStats stats;
+  if (!_this->handle->getStats(id, &stats)) {
+    return jerry_create_undefined();
+  }
+  return iotjs_tts_create_stats(stats);
+}
+
+JS_FUNCTION(SetTrace) {
+  JS_DECLARE_THIS_PTR(tts, tts);
+  IOTJS_VALIDATED_STRUCT_METHOD(iotjs_tts_t, tts);
+
+  if (_this->handle == NULL) {
+    return JS_CREATE_ERROR(COMMON, "tts is not initialized");
+  }
+  _this->handle->setTrace(JS_GET_ARG(0, boolean));
+  return jerry_create_undefined();
+}
+
 void init(jerry_value_t exports) {
   jerry_value_t jconstructor = jerry_create_external_function(TTS);
   iotjs_jval_set_property_jval(exports, "TtsWrap", jconstructor);
@@ -226,9 +375,14 @@ void init(jerry_value_t exports) {
   jerry_value_t proto = jerry_create_object();
   iotjs_jval_set_method(proto, "prepare", Prepare);
   iotjs_jval_set_method(proto, "speak", Speak);
+  iotjs_jval_set_method(proto, "enqueue", Enqueue);
   iotjs_jval_set_method(proto, "cancel", Cancel);
+  iotjs_jval_set_method(proto, "cancelQueue", CancelQueue);
   iotjs_jval_set_method(proto, "disconnect", Disconnect);
   iotjs_jval_set_method(proto, "reconnect", Reconnect);
+  iotjs_jval_set_method(proto, "setCache", SetCache);
+  iotjs_jval_set_method(proto, "getStats", GetStats);
+  iotjs_jval_set_method(proto, "setTrace", SetTrace);
   iotjs_jval_set_property_jval(jconstructor, "prototype", proto);
 
   jerry_release_value(proto);
@@ -36,6 +36,14 @@ typedef struct {
   int id;
 } iotjs_tts_event_t;
 
+typedef struct {
+  // cppcheck-suppress unusedStructMember
+  iotjs_tts_t* ttswrap;
+  // cppcheck-suppress unusedStructMember
+  int id;
+  TtsPlaybackStats stats;
+} iotjs_tts_trace_t;
+
 /**
  * @class TtsNative
  * @extends TtsService
@@ -46,6 +54,7 @@ class TtsNative : public TtsService {
   explicit TtsNative(iotjs_tts_t* ttswrap_) {
     ttswrap = ttswrap_;
     send_event = &TtsNative::SendEvent;
+    send_trace = &TtsNative::SendTrace;
   };
   ~TtsNative(){};
 
@@ -53,6 +62,8 @@ class TtsNative : public TtsService {
   static void SendEvent(void* self, TtsResultType type, int id, int code);
   static void OnEvent(uv_async_t* handle);
   static void AfterEvent(uv_handle_t* handle);
+  static void SendTrace(void* self, int id, const TtsPlaybackStats& stats);
+  static void OnTrace(uv_async_t* handle);
 
  protected:
   iotjs_tts_t* ttswrap;
@@ -0,0 +1,432 @@
+#include "TtsPlayback.h"
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+
+uint64_t TtsPlayback::now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+TtsPlayback::TtsPlayback(size_t capacity_) {
+  capacity = capacity_;
+  pthread_mutex_init(&mutex, NULL);
+  // the jitter buffer waits on the monotonic clock
+  pthread_condattr_t attr;
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&not_empty, &attr);
+  pthread_condattr_destroy(&attr);
+  pthread_cond_init(&not_full, NULL);
+}
+
+TtsPlayback::~TtsPlayback() {
+  stop();
+  pthread_cond_destroy(&not_full);
+  pthread_cond_destroy(&not_empty);
+  pthread_mutex_destroy(&mutex);
+}
+
+bool TtsPlayback::start(playback_event_callback cb, void* data,
+                        bool holdconnect) {
+  pthread_mutex_lock(&mutex);
+  if (running) {
+    pthread_mutex_unlock(&mutex);
+    return true;
+  }
+  callback = cb;
+  callback_data = data;
+  hold = holdconnect;
+  running = true;
+  pthread_mutex_unlock(&mutex);
+
+  if (pthread_create(&thread, NULL, TtsPlayback::Run, this)) {
+    running = false;
+    return false;
+  }
+  return true;
+}
+
+void TtsPlayback::stop() {
+  pthread_mutex_lock(&mutex);
+  if (!running) {
+    pthread_mutex_unlock(&mutex);
+    return;
+  }
+  running = false;
+  frames.clear();
+  order.clear();
+  held.clear();
+  playing_id = -1;
+  buffering_id = -1;
+  pthread_cond_broadcast(&not_empty);
+  pthread_cond_broadcast(&not_full);
+  pthread_mutex_unlock(&mutex);
+
+  if (!pthread_equal(thread, pthread_self())) {
+    pthread_join(thread, NULL);
+  } else {
+    pthread_detach(thread);
+  }
+  player.resetOpusPlayer();
+}
+
+bool TtsPlayback::push(const TtsFrame& frame, bool wait) {
+  pthread_mutex_lock(&mutex);
+  while (wait && running && frames.size() >= capacity) {
+    pthread_cond_wait(&not_full, &mutex);
+  }
+  if (!running) {
+    pthread_mutex_unlock(&mutex);
+    return false;
+  }
+  onArrival(frame);
+  if (isHeld(frame.id)) {
+    held[frame.id].push_back(frame);
+    pthread_mutex_unlock(&mutex);
+    return true;
+  }
+  frames.push_back(frame);
+  pthread_cond_signal(&not_empty);
+  pthread_mutex_unlock(&mutex);
+  return true;
+}
+
+static void flush_frames(deque<TtsFrame>& frames, int id) {
+  deque<TtsFrame>::iterator it = frames.begin();
+  while (it != frames.end()) {
+    if (it->id == id && it->type == TTS_RES_VOICE) {
+      it = frames.erase(it);
+      continue;
+    }
+    if (it->id == id && it->type == TTS_RES_END) {
+      it->type = TTS_RES_CANCELLED;
+    }
+    ++it;
+  }
+}
+
+void TtsPlayback::flush(int id) {
+  pthread_mutex_lock(&mutex);
+  flush_frames(frames, id);
+  map<int, deque<TtsFrame> >::iterator it = held.find(id);
+  if (it != held.end()) {
+    flush_frames(it->second, id);
+  }
+  // the player is only touched by the playback thread, let it reset unless the
+  // id is still waiting for its turn.
+  if (!isHeld(id)) {
+    reset_pending = true;
+    flushed_id = id;
+  }
+  pthread_cond_signal(&not_empty);
+  pthread_cond_broadcast(&not_full);
+  pthread_mutex_unlock(&mutex);
+}
+
+void TtsPlayback::expect(int id) {
+  pthread_mutex_lock(&mutex);
+  if (running) {
+    order.push_back(id);
+  }
+  pthread_mutex_unlock(&mutex);
+}
+
+// must be called with the mutex held
+bool TtsPlayback::isHeld(int id) {
+  if (order.empty() || order.front() == id)
+    return false;
+  return find(order.begin(), order.end(), id) != order.end();
+}
+
+// must be called with the mutex held
+void TtsPlayback::advance(int id) {
+  deque<int>::iterator it = find(order.begin(), order.end(), id);
+  if (it == order.end())
+    return;
+  bool was_front = it == order.begin();
+  order.erase(it);
+  if (!was_front || order.empty())
+    return;
+  // releases the frames held for the next one
+  map<int, deque<TtsFrame> >::iterator hit = held.find(order.front());
+  if (hit != held.end()) {
+    frames.insert(frames.end(), hit->second.begin(), hit->second.end());
+    held.erase(hit);
+    pthread_cond_signal(&not_empty);
+  }
+}
+
+void* TtsPlayback::Run(void* params) {
+  TtsPlayback* self = static_cast<TtsPlayback*>(params);
+  while (true) {
+    pthread_mutex_lock(&self->mutex);
+    while (self->running && self->frames.empty() && !self->reset_pending) {
+      self->onStarved();
+      pthread_cond_wait(&self->not_empty, &self->mutex);
+    }
+    if (!self->running) {
+      pthread_mutex_unlock(&self->mutex);
+      break;
+    }
+    struct timespec deadline;
+    if (!self->reset_pending && self->shouldBuffer(&deadline)) {
+      pthread_cond_timedwait(&self->not_empty, &self->mutex, &deadline);
+      pthread_mutex_unlock(&self->mutex);
+      continue;
+    }
+    bool reset = self->reset_pending;
+    self->reset_pending = false;
+    bool has_frame = !self->frames.empty();
+    TtsFrame frame;
+    if (has_frame) {
+      frame = self->frames.front();
+      self->frames.pop_front();
+      self->onDequeue(frame);
+      pthread_cond_signal(&self->not_full);
+    }
+    pthread_mutex_unlock(&self->mutex);
+
+    if (reset) {
+      self->player.resetOpusPlayer();
+    }
+    if (has_frame) {
+      self->play(frame);
+    }
+  }
+  return NULL;
+}
+
+void TtsPlayback::play(const TtsFrame& frame) {
+  switch (frame.type) {
+    case TTS_RES_VOICE: {
+      if (frame.cached) {
+        playCached(frame);
+        return;
+      }
+      size_t size = frame.voice ? frame.voice->size() : 0;
+      if (size > 0) {
+        player.startOpusPlayer(frame.voice->data(), size);
+      } else {
+        fprintf(stderr, "voice size=0\n");
+      }
+      return;
+    }
+    case TTS_RES_START: {
+      player.resetOpusPlayer();
+      break;
+    }
+    case TTS_RES_END:
+    case TTS_RES_CANCELLED:
+    case TTS_RES_ERROR: {
+      player.drain(hold);
+      pthread_mutex_lock(&mutex);
+      TtsPlaybackStats* item = statsOf(frame.id, false);
+      if (item) {
+        item->drained_at = now();
+      }
+      advance(frame.id);
+      pthread_mutex_unlock(&mutex);
+      break;
+    }
+    default:
+      return;
+  }
+  if (callback) {
+    callback(callback_data, frame.type, frame.id, frame.code);
+  }
+}
+
+void TtsPlayback::playCached(const TtsFrame& frame) {
+  const TtsCacheEntry* entry = frame.cached.get();
+  if (frame.index >= entry->count())
+    return;
+  player.startOpusPlayer(entry->data(frame.index), entry->size(frame.index));
+  if (frame.index + 1 >= entry->count())
+    return;
+
+  // requeues the rest at the front, so a flush in between still drops it.
+  pthread_mutex_lock(&mutex);
+  if (running && !(reset_pending && flushed_id == frame.id)) {
+    TtsFrame next = frame;
+    next.index += 1;
+    frames.push_front(next);
+  }
+  pthread_mutex_unlock(&mutex);
+}
+
+void TtsPlayback::markIssued(int id, uint64_t at) {
+  pthread_mutex_lock(&mutex);
+  statsOf(id, true)->issued_at = at;
+  pthread_mutex_unlock(&mutex);
+}
+
+bool TtsPlayback::getStats(int id, TtsPlaybackStats* out) {
+  pthread_mutex_lock(&mutex);
+  TtsPlaybackStats* found = statsOf(id, false);
+  if (found) {
+    *out = *found;
+  }
+  pthread_mutex_unlock(&mutex);
+  return found != NULL;
+}
+
+// must be called with the mutex held
+TtsPlaybackStats* TtsPlayback::statsOf(int id, bool create) {
+  map<int, TtsPlaybackStats>::iterator it = stats.find(id);
+  if (it != stats.end())
+    return &it->second;
+  if (!create)
+    return NULL;
+  if (stats_order.size() >= TTS_STATS_CAPACITY) {
+    stats.erase(stats_order.front());
+    stats_order.pop_front();
+  }
+  stats_order.push_back(id);
+  TtsPlaybackStats& item = stats[id];
+  item.frames = 0;
+  item.underruns = 0;
+  item.depth = 0;
+  item.max_depth = 0;
+  item.target_depth = 0;
+  item.jitter = 0;
+  item.time_to_first_audio = -1;
+  item.issued_at = 0;
+  item.started_at = 0;
+  item.first_voice_at = 0;
+  item.first_audio_at = 0;
+  item.drained_at = 0;
+  return &item;
+}
+
+// must be called with the mutex held
+void TtsPlayback::onArrival(const TtsFrame& frame) {
+  uint64_t now = TtsPlayback::now();
+  if (frame.type == TTS_RES_START) {
+    statsOf(frame.id, true)->started_at = now;
+    return;
+  }
+  if (frame.type != TTS_RES_VOICE)
+    return;
+  TtsPlaybackStats* item = statsOf(frame.id, true);
+  if (item->first_voice_at == 0) {
+    item->first_voice_at = now;
+  }
+  if (frame.cached)
+    return;
+
+  if (last_arrival_id == frame.id) {
+    // the smoothed mean and deviation of the inter-arrival time, see RFC 3550
+    double interval = (now - last_arrival) / 1e6;
+    if (mean_interval <= 0) {
+      mean_interval = interval;
+    } else {
+      mean_interval += (interval - mean_interval) / 8;
+    }
+    jitter += (fabs(interval - mean_interval) - jitter) / 16;
+  }
+  last_arrival = now;
+  last_arrival_id = frame.id;
+
+  item->frames += 1;
+  item->depth += 1;
+  item->max_depth = max(item->max_depth, item->depth);
+  item->jitter = jitter;
+}
+
+// must be called with the mutex held
+void TtsPlayback::onDequeue(const TtsFrame& frame) {
+  starved = false;
+  if (frame.type == TTS_RES_VOICE) {
+    TtsPlaybackStats* item = statsOf(frame.id, false);
+    if (!frame.cached && item && item->depth > 0) {
+      item->depth -= 1;
+    }
+    if (playing_id != frame.id) {
+      playing_id = frame.id;
+      if (item && item->first_audio_at == 0) {
+        item->first_audio_at = now();
+        if (item->started_at > 0) {
+          item->time_to_first_audio =
+              (item->first_audio_at - item->started_at) / 1e6;
+        }
+      }
+    }
+  } else if (frame.type != TTS_RES_START && frame.id == playing_id) {
+    playing_id = -1;
+  }
+}
+
+// must be called with the mutex held
+void TtsPlayback::onStarved() {
+  if (playing_id == -1 || starved)
+    return;
+  // ran out of frames in the middle of an utterance
+  starved = true;
+  rebuffer = true;
+  TtsPlaybackStats* item = statsOf(playing_id, false);
+  if (item) {
+    item->underruns += 1;
+  }
+}
+
+// must be called with the mutex held
+uint32_t TtsPlayback::targetDepth(double* target_ms) {
+  double ms = max((double)TTS_JITTER_MIN_MS, 4 * jitter);
+  ms = min(ms, (double)TTS_JITTER_MAX_MS);
+  *target_ms = ms;
+  if (mean_interval <= 0)
+    return 1;
+  uint32_t depth = (uint32_t)ceil(ms / mean_interval);
+  return max(1u, min(depth, (uint32_t)TTS_JITTER_MAX_DEPTH));
+}
+
+/**
+ * Decides if the front frame should wait for more frames, it's the case for
+ * the first voice frame from the network of an utterance and the one after an
+ * underrun, until the adaptive depth is reached, the utterance is completed or
+ * the deadline is passed. Must be called with the mutex held.
+ */
+bool TtsPlayback::shouldBuffer(struct timespec* deadline) {
+  if (frames.empty())
+    return false;
+  const TtsFrame& front = frames.front();
+  if (front.type != TTS_RES_VOICE || front.cached)
+    return false;
+  if (front.id == playing_id && !rebuffer)
+    return false;
+
+  uint64_t now = TtsPlayback::now();
+  if (buffering_id != front.id) {
+    double target_ms;
+    buffering_id = front.id;
+    buffering_depth = targetDepth(&target_ms);
+    buffering_until = now + (uint64_t)(target_ms * 1e6);
+  }
+  uint32_t depth = 0;
+  bool completed = false;
+  deque<TtsFrame>::iterator it = frames.begin();
+  for (; it != frames.end() && depth < buffering_depth; ++it) {
+    if (it->id != front.id)
+      continue;
+    if (it->type == TTS_RES_VOICE) {
+      depth += 1;
+    } else {
+      completed = true;
+      break;
+    }
+  }
+  if (depth >= buffering_depth || completed || now >= buffering_until) {
+    TtsPlaybackStats* item = statsOf(front.id, false);
+    if (item) {
+      item->target_depth = buffering_depth;
+    }
+    buffering_id = -1;
+    rebuffer = false;
+    return false;
+  }
+  deadline->tv_sec = buffering_until / 1000000000ULL;
+  deadline->tv_nsec = buffering_until % 1000000000ULL;
+  return true;
+}
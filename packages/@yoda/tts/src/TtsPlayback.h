@@ -0,0 +1,169 @@
+#ifndef TTS_PLAYBACK_H
+#define TTS_PLAYBACK_H
+
+#include <speech/tts.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <librplayer/OpusPlayer.h>
+#include "TtsCache.h"
+using namespace std;
+using namespace rokid;
+using namespace speech;
+
+// the maximum number of the queued frames before the poller is blocked
+#define TTS_FRAME_QUEUE_CAPACITY 256
+// the bounds of the jitter buffer, it's sized from the inter-arrival jitter.
+#define TTS_JITTER_MIN_MS 40
+#define TTS_JITTER_MAX_MS 400
+#define TTS_JITTER_MAX_DEPTH 32
+// how many utterances the stats are kept for
+#define TTS_STATS_CAPACITY 32
+
+/**
+ * The item passed from the network poller to the playback thread, it's either
+ * a voice frame or a control event. A voice frame from the cache refers to the
+ * mapped phrase, and is played from `index` to its end.
+ */
+struct TtsFrame {
+  TtsResultType type;
+  int id;
+  int code;
+  shared_ptr<string> voice;
+  shared_ptr<TtsCacheEntry> cached;
+  size_t index;
+};
+
+/**
+ * The playback counters of an utterance.
+ */
+struct TtsPlaybackStats {
+  // the received voice frames
+  uint32_t frames;
+  // how many times the playback ran out of frames before the end
+  uint32_t underruns;
+  // the queued voice frames now, and the maximum of it
+  uint32_t depth;
+  uint32_t max_depth;
+  // the depth the jitter buffer waited for before playing
+  uint32_t target_depth;
+  // the estimated inter-arrival jitter in ms
+  double jitter;
+  // from the start event to the first frame handed to the player in ms, -1
+  // if not played yet
+  double time_to_first_audio;
+  // the monotonic timestamps in ns of the utterance, 0 if not reached yet
+  uint64_t issued_at;
+  uint64_t started_at;
+  uint64_t first_voice_at;
+  uint64_t first_audio_at;
+  uint64_t drained_at;
+};
+
+typedef void (*playback_event_callback)(void*, TtsResultType, int, int);
+
+/**
+ * @class TtsPlayback
+ * Owns the opus decoder and player of a TTS instance, and plays the frames
+ * from a bounded queue on its own thread, so that the network polling is not
+ * stalled by a slow audio sink.
+ */
+class TtsPlayback {
+ public:
+  explicit TtsPlayback(size_t capacity_ = TTS_FRAME_QUEUE_CAPACITY);
+  ~TtsPlayback();
+
+  /**
+   * @method start
+   * @param {playback_event_callback} cb - called from the playback thread
+   *        when a control event is played.
+   * @param {void*} data - the data of the callback.
+   * @param {bool} holdconnect - if holds the connection on draining.
+   */
+  bool start(playback_event_callback cb, void* data, bool holdconnect);
+  /**
+   * @method stop
+   * stops and joins the playback thread, the pending frames are dropped.
+   */
+  void stop();
+  /**
+   * @method push
+   * queues the frame, it blocks the caller while the queue is full unless
+   * `wait` is false.
+   * @return {bool} false if the playback is stopped.
+   */
+  bool push(const TtsFrame& frame, bool wait = true);
+  /**
+   * @method flush
+   * drops the queued voice frames of the given id and resets the player, the
+   * queued end event of the id is turned into a cancelled one.
+   */
+  void flush(int id);
+  /**
+   * @method expect
+   * appends the id to the playing order, the frames of an expected id are held
+   * until the ones before it have been played to the end.
+   */
+  void expect(int id);
+  /**
+   * @method getStats
+   * @return {bool} false if the id is unknown or the stats have been dropped.
+   */
+  bool getStats(int id, TtsPlaybackStats* stats);
+  /**
+   * @method markIssued
+   * records the time the utterance is requested at.
+   */
+  void markIssued(int id, uint64_t at);
+  static uint64_t now();
+
+ private:
+  static void* Run(void* params);
+  void play(const TtsFrame& frame);
+  void playCached(const TtsFrame& frame);
+  bool isHeld(int id);
+  void advance(int id);
+  TtsPlaybackStats* statsOf(int id, bool create);
+  void onArrival(const TtsFrame& frame);
+  void onDequeue(const TtsFrame& frame);
+  void onStarved();
+  bool shouldBuffer(struct timespec* deadline);
+  uint32_t targetDepth(double* target_ms);
+
+ private:
+  OpusPlayer player;
+  size_t capacity;
+  deque<TtsFrame> frames;
+  deque<int> order;
+  map<int, deque<TtsFrame> > held;
+  pthread_mutex_t mutex;
+  pthread_cond_t not_empty;
+  pthread_cond_t not_full;
+  pthread_t thread;
+  bool running = false;
+  bool hold = true;
+  bool reset_pending = false;
+  int flushed_id = -1;
+
+  // the jitter buffer, see shouldBuffer()
+  double mean_interval = 0;
+  double jitter = 0;
+  uint64_t last_arrival = 0;
+  int last_arrival_id = -1;
+  int playing_id = -1;
+  int buffering_id = -1;
+  uint64_t buffering_until = 0;
+  uint32_t buffering_depth = 0;
+  bool starved = false;
+  bool rebuffer = false;
+  map<int, TtsPlaybackStats> stats;
+  deque<int> stats_order;
+  playback_event_callback callback = NULL;
+  void* callback_data = NULL;
+};
+
+#endif
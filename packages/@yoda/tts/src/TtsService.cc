@@ -8,29 +8,216 @@
 using namespace std;
 using namespace rokid;
 
-static OpusPlayer _player;
-
 int TtsService::speak(const char* content) {
   if (!prepared) {
     return TTS_NOT_PREPARED;
   }
-  int id = tts_handle->speak(content);
+  pthread_mutex_lock(&queue_mutex);
+  int id = request(content, -1);
+  pthread_mutex_unlock(&queue_mutex);
+  return id;
+}
+
+int TtsService::enqueue(const char* content) {
+  if (!prepared) {
+    return TTS_NOT_PREPARED;
+  }
+  pthread_mutex_lock(&queue_mutex);
+  Utterance utterance;
+  utterance.id = allocLocalId();
+  utterance.text.assign(content);
+  utterance.issued = false;
+  utterances.push_back(utterance);
+  playback.expect(utterance.id);
+  pumpQueue();
+  pthread_mutex_unlock(&queue_mutex);
+  return utterance.id;
+}
+
+int TtsService::allocLocalId() {
+  int id = local_id;
+  local_id = local_id == INT32_MAX ? TTS_LOCAL_ID_BASE : local_id + 1;
+  return id;
+}
+
+// issues the content from the cache or the cloud, the cloud id is mapped to
+// the given id unless it's -1. Must be called with the queue mutex held.
+int TtsService::request(const char* content, int id) {
+  string key;
+  if (cache.enabled()) {
+    key = TtsCache::makeKey(content, declaimer_, TTS_CACHE_CODEC);
+    shared_ptr<TtsCacheEntry> entry = cache.lookup(key);
+    if (entry) {
+      if (id == -1)
+        id = allocLocalId();
+      playback.markIssued(id, TtsPlayback::now());
+      speakCached(id, entry);
+      return id;
+    }
+  }
+  uint64_t issued_at = TtsPlayback::now();
+  // the frames could be polled before speak() returns
+  if (!key.empty()) {
+    cache.expect(key);
+  }
+  int cloud_id = tts_handle->speak(content);
+  if (!key.empty()) {
+    cache.bind(cloud_id);
+  }
+  if (cloud_id < 0)
+    return cloud_id;
+  playback.markIssued(id == -1 ? cloud_id : id, issued_at);
+  if (id == -1)
+    return cloud_id;
+  cloud_ids[cloud_id] = id;
+  return id;
+}
+
+void TtsService::speakCached(int id, shared_ptr<TtsCacheEntry> entry) {
+  // the cached phrase is played like a received one, with the synthetic
+  // start and end events around it.
+  TtsFrame frame;
+  frame.id = id;
+  frame.code = 0;
+  frame.index = 0;
+  frame.type = TTS_RES_START;
+  playback.push(frame, false);
+  frame.type = TTS_RES_VOICE;
+  frame.cached = entry;
+  playback.push(frame, false);
+  frame.type = TTS_RES_END;
+  frame.cached.reset();
+  playback.push(frame, false);
+}
+
+void TtsService::pushEvent(TtsResultType type, int id) {
+  TtsFrame frame;
+  frame.type = type;
+  frame.id = id;
+  frame.code = type == TTS_RES_ERROR ? TTS_ERROR : 0;
+  frame.index = 0;
+  playback.push(frame, false);
+}
+
+// issues the playing utterance and the look-ahead ones, must be called with
+// the queue mutex held.
+void TtsService::pumpQueue() {
+  deque<Utterance>::iterator it = utterances.begin();
+  for (int n = 0; it != utterances.end() && n <= TTS_QUEUE_LOOKAHEAD;
+       ++it, ++n) {
+    if (it->issued)
+      continue;
+    it->issued = true;
+    if (request(it->text.c_str(), it->id) < 0) {
+      pushEvent(TTS_RES_ERROR, it->id);
+    }
+  }
+}
+
+int TtsService::toLocalId(int cloud_id, bool done) {
+  pthread_mutex_lock(&queue_mutex);
+  int id = cloud_id;
+  map<int, int>::iterator it = cloud_ids.find(cloud_id);
+  if (it != cloud_ids.end()) {
+    id = it->second;
+    if (done)
+      cloud_ids.erase(it);
+  }
+  pthread_mutex_unlock(&queue_mutex);
   return id;
 }
 
+void TtsService::onUtteranceDone(int id) {
+  pthread_mutex_lock(&queue_mutex);
+  deque<Utterance>::iterator it = utterances.begin();
+  for (; it != utterances.end(); ++it) {
+    if (it->id == id) {
+      utterances.erase(it);
+      break;
+    }
+  }
+  pumpQueue();
+  pthread_mutex_unlock(&queue_mutex);
+}
+
+bool TtsService::getStats(int id, TtsPlaybackStats* stats) {
+  return playback.getStats(id, stats);
+}
+
+void TtsService::setTrace(bool enabled) {
+  tracing = enabled;
+}
+
+void TtsService::setCache(const char* dir, size_t max_size) {
+  cache.configure(dir, max_size);
+}
+
 int TtsService::cancel(int id) {
   if (!prepared) {
     return TTS_NOT_PREPARED;
   }
-  tts_handle->cancel(id);
-  _player.resetOpusPlayer();
+  bool pending = false;
+  pthread_mutex_lock(&queue_mutex);
+  if (id >= TTS_LOCAL_ID_BASE) {
+    deque<Utterance>::iterator it = utterances.begin();
+    for (; it != utterances.end(); ++it) {
+      if (it->id == id && !it->issued) {
+        utterances.erase(it);
+        pending = true;
+        break;
+      }
+    }
+    map<int, int>::iterator cit = cloud_ids.begin();
+    for (; cit != cloud_ids.end(); ++cit) {
+      if (cit->second == id)
+        tts_handle->cancel(cit->first);
+    }
+  } else {
+    tts_handle->cancel(id);
+  }
+  if (pending) {
+    // never issued, there is no cloud event to wait for.
+    pushEvent(TTS_RES_CANCELLED, id);
+  }
+  pthread_mutex_unlock(&queue_mutex);
+  playback.flush(id);
+  return TTS_OK;
+}
+
+int TtsService::cancelQueue() {
+  if (!prepared) {
+    return TTS_NOT_PREPARED;
+  }
+  vector<int> ids;
+  pthread_mutex_lock(&queue_mutex);
+  deque<Utterance>::iterator it = utterances.begin();
+  for (; it != utterances.end(); ++it) {
+    ids.push_back(it->id);
+    if (!it->issued)
+      pushEvent(TTS_RES_CANCELLED, it->id);
+  }
+  utterances.clear();
+  map<int, int>::iterator cit = cloud_ids.begin();
+  for (; cit != cloud_ids.end(); ++cit) {
+    tts_handle->cancel(cit->first);
+  }
+  pthread_mutex_unlock(&queue_mutex);
+  for (size_t i = 0; i < ids.size(); i++) {
+    playback.flush(ids[i]);
+  }
+  return TTS_OK;
 }
+
 // cppcheck-suppress unusedFunction
 int TtsService::disconnect() {
   if (!prepared) {
     return 0;
   }
-  _player.resetOpusPlayer();
+  playback.stop();
+  pthread_mutex_lock(&queue_mutex);
+  utterances.clear();
+  cloud_ids.clear();
+  pthread_mutex_unlock(&queue_mutex);
   prepared = false;
   need_destroy_ = true;
   return 0;
@@ -47,36 +234,36 @@ void* TtsService::PollEvent(void* params) {
       fprintf(stderr, "tts poll failed\n");
       break;
     }
+    if (res.type == TTS_RES_VOICE && res.voice.get()->size() == 0) {
+      fprintf(stderr, "voice size=0\n");
+      continue;
+    }
     switch (res.type) {
-      case TTS_RES_VOICE: {
-        size_t size = res.voice.get()->size();
-        if (size > 0) {
-          _player.startOpusPlayer(res.voice.get()->data(), size);
-        } else {
-          fprintf(stderr, "voice size=0\n");
-        }
+      case TTS_RES_START:
+        self->cache.start(res.id);
         break;
-      }
-      case TTS_RES_START: {
-        _player.resetOpusPlayer();
-        self->send_event(self, TTS_RES_START, res.id, 0);
+      case TTS_RES_VOICE:
+        self->cache.append(res.id, res.voice.get()->data(),
+                           res.voice.get()->size());
         break;
-      }
-      case TTS_RES_END: {
-        _player.drain(self->holdconnect);
-        self->send_event(self, TTS_RES_END, res.id, 0);
+      case TTS_RES_END:
+        // written on the playback thread, see OnPlaybackEvent
+        self->cache.finish(res.id);
         break;
-      }
-      case TTS_RES_CANCELLED: {
-        _player.drain(self->holdconnect);
-        self->send_event(self, TTS_RES_CANCELLED, res.id, 0);
+      default:
+        self->cache.abort(res.id);
         break;
-      }
-      case TTS_RES_ERROR: {
-        _player.drain(self->holdconnect);
-        self->send_event(self, TTS_RES_ERROR, res.id, res.err);
-        break;
-      }
+    }
+    TtsFrame frame;
+    frame.type = res.type;
+    frame.id = self->toLocalId(res.id, res.type != TTS_RES_START &&
+                                           res.type != TTS_RES_VOICE);
+    frame.code = res.type == TTS_RES_ERROR ? res.err : 0;
+    frame.voice = res.voice;
+    frame.index = 0;
+    // decoding and playing are done on the playback thread
+    if (!self->playback.push(frame)) {
+      break;
     }
   }
   if (self->tts_handle)
@@ -84,6 +271,24 @@ void* TtsService::PollEvent(void* params) {
   return NULL;
 }
 
+void TtsService::OnPlaybackEvent(void* data, TtsResultType type, int id,
+                                 int code) {
+  TtsService* self = static_cast<TtsService*>(data);
+  if (id >= TTS_LOCAL_ID_BASE && type != TTS_RES_START) {
+    self->onUtteranceDone(id);
+  }
+  self->send_event(self, type, id, code);
+  if (type != TTS_RES_START) {
+    self->cache.flush();
+  }
+
+  TtsPlaybackStats stats;
+  if (type != TTS_RES_START && self->tracing && self->send_trace &&
+      self->playback.getStats(id, &stats)) {
+    self->send_trace(self, id, stats);
+  }
+}
+
 bool TtsService::prepare(const char* host, int port, const char* branch,
                          const char* auth_key, const char* device_type,
                          const char* device_id, const char* secret,
@@ -107,6 +312,7 @@ bool TtsService::prepare(const char* host, int port, const char* branch,
   tts_options = TtsOptions::new_instance();
   if (declaimer) {
     tts_options->set_declaimer(std::string(declaimer));
+    declaimer_.assign(declaimer);
   }
 
   if (!tts_options || !tts_handle || !tts_handle->prepare(options)) {
@@ -115,7 +321,11 @@ bool TtsService::prepare(const char* host, int port, const char* branch,
   tts_options->set_codec(Codec::OPU2);
   tts_handle->config(tts_options);
 
+  if (!playback.start(TtsService::OnPlaybackEvent, this, holdconnect)) {
+    goto terminate;
+  }
   if (pthread_create(&polling, NULL, TtsService::PollEvent, this)) {
+    playback.stop();
     goto terminate;
   }
   pthread_detach(polling);
@@ -3,8 +3,11 @@
 
 #include <speech/tts.h>
 #include <stdlib.h>
+#include <deque>
+#include <map>
 #include <string>
-#include <librplayer/OpusPlayer.h>
+#include "TtsCache.h"
+#include "TtsPlayback.h"
 using namespace std;
 using namespace rokid;
 using namespace speech;
@@ -15,16 +18,28 @@ enum TtsStatusCode {
   TTS_ERROR,
 };
 
+// the ids of the cached phrases and the queued utterances are allocated from
+// here, to not conflict with the ones of the cloud.
+#define TTS_LOCAL_ID_BASE 0x40000000
+#define TTS_CACHE_CODEC "opu2"
+// how many queued utterances are synthesized ahead of the playing one
+#define TTS_QUEUE_LOOKAHEAD 1
+
 typedef void (*send_event_callback)(void*, TtsResultType, int, int);
+typedef void (*send_trace_callback)(void*, int, const TtsPlaybackStats&);
 
 class TtsService {
  public:
-  TtsService(){};
+  TtsService() {
+    pthread_mutex_init(&queue_mutex, NULL);
+  };
   explicit TtsService(send_event_callback send_event_) {
     send_event = send_event_;
+    pthread_mutex_init(&queue_mutex, NULL);
   };
   ~TtsService() {
     tts_handle->release();
+    pthread_mutex_destroy(&queue_mutex);
   }
 
   bool prepare(const char* host, int port, const char* branch,
@@ -32,14 +47,45 @@ class TtsService {
                const char* device_id, const char* secret, const char* declaimer,
                bool holdcon = true);
   int speak(const char*);
+  /**
+   * @method enqueue
+   * queues the utterance after the queued ones, it's synthesized while the
+   * previous one is playing, and played right after it.
+   * @return {int} the id of the utterance.
+   */
+  int enqueue(const char*);
   int cancel(int id);
+  /**
+   * @method cancelQueue
+   * cancels the queued utterances including the playing one.
+   */
+  int cancelQueue();
   int disconnect();
   void reconnect();
+  /**
+   * @method setCache
+   * @param {const char*} dir - the directory of the phrase cache.
+   * @param {size_t} max_size - the maximum bytes, 0 to disable the cache.
+   */
+  void setCache(const char* dir, size_t max_size);
+  /**
+   * @method getStats
+   * @return {bool} false if the stats of the id is not found.
+   */
+  bool getStats(int id, TtsPlaybackStats* stats);
+  /**
+   * @method setTrace
+   * if sends the stats of each utterance once it's drained.
+   */
+  void setTrace(bool enabled);
 
   static void* PollEvent(void*);
+  static void OnPlaybackEvent(void*, TtsResultType, int, int);
 
  protected:
   send_event_callback send_event;
+  send_trace_callback send_trace = NULL;
+  bool tracing = false;
   bool prepared = false;
   bool need_destroy_ = false;
   bool holdconnect = true;
@@ -49,6 +95,29 @@ class TtsService {
   shared_ptr<TtsOptions> tts_options;
   shared_ptr<Tts> tts_handle;
   pthread_t polling;
+  TtsPlayback playback;
+  TtsCache cache;
+  string declaimer_;
+  int local_id = TTS_LOCAL_ID_BASE;
+
+  struct Utterance {
+    int id;
+    string text;
+    bool issued;
+  };
+  // the queued utterances, the front one is playing.
+  deque<Utterance> utterances;
+  // maps the cloud ids of the issued utterances to their ids
+  map<int, int> cloud_ids;
+  pthread_mutex_t queue_mutex;
+
+  int allocLocalId();
+  int request(const char* content, int id);
+  void speakCached(int id, shared_ptr<TtsCacheEntry> entry);
+  void pushEvent(TtsResultType type, int id);
+  void pumpQueue();
+  int toLocalId(int cloud_id, bool done);
+  void onUtteranceDone(int id);
 };
 
 #endif
@@ -13,10 +13,10 @@ module.exports = function awake (light, data, callback) {
       stop: () => light.stop(false)
     }
   } else {
-    light.transition(from, to, 100, 15, (r, g, b, last) => {
-      light.fill(r, g, b)
-      light.render()
-    })
+    light.animate([
+      { time: 0, frame: from },
+      { time: 100, frame: to }
+    ])
     return {
       stop: () => light.stop(true)
     }
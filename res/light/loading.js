@@ -6,16 +6,19 @@ module.exports = function loading (light, data, callback) {
   if (data.degree) {
     pos = Math.floor((data.degree / 360) * leds)
   }
-  var render = function () {
-    light.fill(30, 30, 150)
-    pos = pos === (leds - 1) ? 0 : pos + 1
-    light.pixel(pos, 255, 255, 255)
-    light.render()
-    light.requestAnimationFrame(() => {
-      render()
-    }, 60)
+  var keyframes = []
+  for (var i = 0; i <= leds; i++) {
+    var frame = Buffer.alloc(leds * light.ledsConfig.format)
+    for (var j = 0; j < frame.length; j += light.ledsConfig.format) {
+      frame[j] = 30
+      frame[j + 1] = 30
+      frame[j + 2] = 150
+    }
+    var white = ((pos + i + 1) % leds) * light.ledsConfig.format
+    frame[white] = frame[white + 1] = frame[white + 2] = 255
+    keyframes.push({ time: i * 60, frame: frame, easing: 'step' })
   }
-  render()
+  light.animate(keyframes, { repeat: -1 })
   light.requestAnimationFrame(() => {
     callback()
     light.stop()
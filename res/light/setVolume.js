@@ -8,9 +8,8 @@ module.exports = function (light, data, callback) {
   var to = { r: 0, g: 0, b: 0 }
 
   function render (r, g, b) {
-    for (var i = 0; i < pos; i++) {
-      light.pixel(i, r, g, b)
-    }
+    var color = { r: r, g: g, b: b }
+    light.gradient(0, pos - 1, color, color)
     light.render()
   }
 
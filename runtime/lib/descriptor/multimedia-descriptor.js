@@ -115,6 +115,17 @@ Object.assign(MultimediaDescriptor.prototype,
     bufferingupdate: {
       type: 'event'
     },
+    /**
+     * When the position is changed, only if the player is started with the
+     * option `positionInterval`.
+     * @event yodaRT.activity.Activity.MediaClient#positionupdate
+     * @param {string} id - multimedia player id
+     * @param {number} duration -
+     * @param {number} position -
+     */
+    positionupdate: {
+      type: 'event'
+    },
     /**
      * When the `seek()` operation is complete.
      * @event yodaRT.activity.Activity.MediaClient#seekcomplete
@@ -156,6 +167,8 @@ Object.assign(MultimediaDescriptor.prototype,
      * @param {string} uri
      * @param {object} [options]
      * @param {'alarm' | 'playback'} [options.streamType='playback']
+     * @param {number} [options.positionInterval] - emits `positionupdate` in the interval(ms).
+     * @param {number} [options.positionThreshold] - the minimum position change(ms) to emit.
      * @returns {Promise<string>} multimedia player id
      */
     prepare: {
@@ -209,6 +222,8 @@ Object.assign(MultimediaDescriptor.prototype,
      * @param {object} [options]
      * @param {boolean} [options.impatient=true]
      * @param {'alarm' | 'playback'} [options.streamType='playback']
+     * @param {number} [options.positionInterval] - emits `positionupdate` in the interval(ms).
+     * @param {number} [options.positionThreshold] - the minimum position change(ms) to emit.
      * @returns {Promise<string>} multimedia player id
      */
     start: {
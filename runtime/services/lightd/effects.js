@@ -52,6 +52,8 @@ var EventEmitter = require('events')
 var helper = require('./helper')
 
 var SYSTEM_MEDIA_SOURCE = '/opt/media/'
+// the context which owns the native animation
+var animatingContext = null
 
 var holdSoundConnect = true
 if (property.get('player.sound.holdcon', 'persist') === '0') {
@@ -62,97 +64,6 @@ if (property.get('player.lightd.holdcon', 'persist') === '0') {
   holdAwakeConnect = false
 }
 
-/**
- * common for context
- */
-class Common {
-  /**
-   * apply alpha factor
-   * @param {number} alpha - alpha input
-   * @returns {number} - alpha output
-   */
-  static ApplyAlphaFactor (alpha) {
-    if (typeof alpha === 'number' && alpha >= 0 && alpha <= 1) {
-      return Common.alphaFactor * alpha
-    } else {
-      return Common.alphaFactor
-    }
-  }
-
-  /**
-   * set alpha factor
-   * @param {number} alpha - alpha factor
-   */
-  static setAlphaFactor (alpha) {
-    Common.alphaFactor = alpha
-  }
-
-  /**
-   * save the pixel result
-   * @param {number} pos - index of led
-   * @param {number} r - color.r
-   * @param {number} g - color.g
-   * @param {number} b - color.b
-   * @param {number} a - color.a
-   */
-  static setPixel (pos, r, g, b, a) {
-    if (pos < Common.ledStatus.length - 1) {
-      Common.ledStatus[pos].setRGBA(r, g, b, a)
-    }
-  }
-
-  /**
-   * save the fill result
-   * @param {number} r - color.r
-   * @param {number} g - color.g
-   * @param {number} b - color.b
-   * @param {number} a - color.a
-   */
-  static setFill (r, g, b, a) {
-    for (var i = 0; i < Common.ledStatus.length; ++i) {
-      Common.ledStatus[i].setRGBA(r, g, b, a)
-    }
-  }
-
-  /**
-   * init the led config
-   * @param config
-   */
-  static initLedStatus (config) {
-    Common.ledStatus = []
-    for (var i = 0; i < config.leds; ++i) {
-      Common.ledStatus.push(new Color(0, 0, 0, 1))
-    }
-  }
-}
-Common.alphaFactor = 1
-Common.ledStatus = []
-
-/**
- * Color class for light
- */
-class Color {
-  constructor (colorObj) {
-    if (typeof colorObj.r === 'number') {
-      this.setRGBA(colorObj.r, colorObj.g, colorObj.b, colorObj.a)
-    }
-  }
-
-  /**
-   * set rgba
-   * @param {number} r
-   * @param {number} g
-   * @param {number} b
-   * @param {number} a
-   */
-  setRGBA (r, g, b, a) {
-    this.r = r
-    this.g = g
-    this.b = b
-    this.a = a
-  }
-}
-
 module.exports = LightRenderingContextManager
 
 /**
@@ -172,7 +83,6 @@ module.exports = LightRenderingContextManager
 function LightRenderingContextManager () {
   this.id = 0
   this.ledsConfig = light.getProfile()
-  Common.initLedStatus(this.ledsConfig)
 }
 
 /**
@@ -196,12 +106,13 @@ LightRenderingContextManager.prototype.getContext = function getContext () {
  */
 LightRenderingContextManager.prototype.setGlobalAlphaFactor = function (alphaFactor) {
   logger.info(`global alpha factor has been set ${alphaFactor}`)
-  Common.setAlphaFactor(alphaFactor)
-  var context = new LightRenderingContext()
-  for (var i = 0; i < Common.ledStatus.length; ++i) {
-    context.pixel(i, Common.ledStatus[i].r, Common.ledStatus[i].g, Common.ledStatus[i].b, Common.ledStatus[i].a)
+  if (typeof alphaFactor !== 'number' || alphaFactor < 0 || alphaFactor > 1) {
+    alphaFactor = 1
   }
-  context.render()
+  // the factor is applied natively on rendering, so the current frame is
+  // re-rendered as is.
+  light.setBrightness(alphaFactor)
+  light.write()
 }
 
 /**
@@ -215,6 +126,7 @@ function LightRenderingContext () {
   this._handleId = 0
   this._handle = {}
   this._soundPlayer = null
+  this._layers = {}
   this.ledsConfig = light.getProfile()
 }
 
@@ -243,10 +155,13 @@ LightRenderingContext.prototype.playAwake = function playAwake () {
     return
   }
   var absPath = `/opt/media/awake_0${Math.floor(Math.random() * 5) + 1}.wav`
-  Sounder.play(absPath, AudioManager.STREAM_ALARM, holdAwakeConnect, (err) => {
+  Sounder.play(absPath, AudioManager.STREAM_ALARM, holdAwakeConnect, (err, stats) => {
     if (err) {
       logger.error(`playing ${absPath} occurs error ${err && err.stack}`)
+      return
     }
+    logger.info(`awake sound started in ${stats.total}ms, ` +
+      `queue(${stats.queue}ms) prepare(${stats.prepare}ms) start(${stats.start}ms)`)
   })
 }
 
@@ -332,6 +247,18 @@ LightRenderingContext.prototype.stop = function () {
   for (var i in this._handle) {
     clearTimeout(this._handle[i])
   }
+  if (animatingContext === this) {
+    animatingContext = null
+    light.stopAnimation()
+  }
+  var removed = false
+  for (var name in this._layers) {
+    removed = light.removeLayer(name) || removed
+  }
+  this._layers = {}
+  if (removed) {
+    light.write()
+  }
   if (this._soundPlayer) {
     this._soundPlayer.stop()
     this._soundPlayer = null
@@ -382,8 +309,7 @@ LightRenderingContext.prototype.pixel = function (pos, r, g, b, a) {
   if (this._getCurrentId() !== this._id) {
     return
   }
-  Common.setPixel(pos, r, g, b, a)
-  return light.pixel(pos, r, g, b, Common.ApplyAlphaFactor(a))
+  return light.pixel(pos, r, g, b, a)
 }
 
 /**
@@ -401,8 +327,102 @@ LightRenderingContext.prototype.fill = function (r, g, b, a) {
   if (this._getCurrentId() !== this._id) {
     return
   }
-  Common.setFill(r, g, b, a)
-  return light.fill(r, g, b, Common.ApplyAlphaFactor(a))
+  return light.fill(r, g, b, a)
+}
+
+/**
+ * Copy the per-LED colors.
+ *
+ * @method colors
+ * @instance
+ * @memberof yodaRT.light.LightRenderingContext
+ * @param {Buffer} colors - the rgb colors of the LEDs.
+ * @param {number} [start=0] - the position of the first LED to be written.
+ */
+LightRenderingContext.prototype.colors = function (colors, start) {
+  if (this._getCurrentId() !== this._id) {
+    return
+  }
+  return light.colors(colors, start)
+}
+
+/**
+ * Fill the pixels in a range with the linear gradient of 2 colors.
+ *
+ * @method gradient
+ * @instance
+ * @memberof yodaRT.light.LightRenderingContext
+ * @param {number} from - the position of the first pixel.
+ * @param {number} to - the position of the last pixel.
+ * @param {yodaRT.light.Color} start - the color of the first pixel.
+ * @param {yodaRT.light.Color} end - the color of the last pixel.
+ */
+LightRenderingContext.prototype.gradient = function (from, to, start, end) {
+  if (this._getCurrentId() !== this._id) {
+    return
+  }
+  return light.gradient(from, to, start, end)
+}
+
+/**
+ * Scale all pixels.
+ *
+ * @method scale
+ * @instance
+ * @memberof yodaRT.light.LightRenderingContext
+ * @param {number} alpha - the factor. from 0 to 1
+ */
+LightRenderingContext.prototype.scale = function (alpha) {
+  if (this._getCurrentId() !== this._id) {
+    return
+  }
+  return light.scale(alpha)
+}
+
+/**
+ * Blend a frame over all pixels.
+ *
+ * @method blend
+ * @instance
+ * @memberof yodaRT.light.LightRenderingContext
+ * @param {Buffer} frame - the rgb colors of all the LEDs.
+ * @param {number} alpha - Transparency value of the frame. from 0 to 1
+ */
+LightRenderingContext.prototype.blend = function (frame, alpha) {
+  if (this._getCurrentId() !== this._id) {
+    return
+  }
+  return light.blend(frame, alpha)
+}
+
+/**
+ * Rotate the pixels on the ring.
+ *
+ * @method rotate
+ * @instance
+ * @memberof yodaRT.light.LightRenderingContext
+ * @param {number} steps - the pixels to move, positive is clockwise.
+ */
+LightRenderingContext.prototype.rotate = function (steps) {
+  if (this._getCurrentId() !== this._id) {
+    return
+  }
+  return light.rotate(steps)
+}
+
+/**
+ * Shift the pixels like `rotate`, the vacated pixels are cleared.
+ *
+ * @method shift
+ * @instance
+ * @memberof yodaRT.light.LightRenderingContext
+ * @param {number} steps - the pixels to move, positive is clockwise.
+ */
+LightRenderingContext.prototype.shift = function (steps) {
+  if (this._getCurrentId() !== this._id) {
+    return
+  }
+  return light.shift(steps)
 }
 
 /**
@@ -426,6 +446,109 @@ LightRenderingContext.prototype.requestAnimationFrame = function (cb, interval)
   }, interval)
 }
 
+/**
+ * Play the keyframes natively at the maximum fps of the device, the frames
+ * are interpolated and rendered off the JS thread. It's stopped by `stop()`.
+ *
+ * @method animate
+ * @instance
+ * @memberof yodaRT.light.LightRenderingContext
+ * @param {object[]} keyframes - the keyframes `{ time, frame, easing }`, the
+ *        frame is either a buffer of all pixels or a `yodaRT.light.Color`.
+ * @param {object} [options] - the `repeat` and `fps` of the animation.
+ * @return {Promise<boolean>} resolves with `cancelled` when the animation ends.
+ */
+LightRenderingContext.prototype.animate = function (keyframes, options) {
+  if (this._getCurrentId() !== this._id) {
+    return Promise.resolve(true)
+  }
+  return new Promise((resolve, reject) => {
+    animatingContext = this
+    light.animate(keyframes, options, (cancelled) => {
+      if (animatingContext === this && !cancelled) {
+        animatingContext = null
+      }
+      resolve(cancelled)
+    })
+  })
+}
+
+/**
+ * Play a sequence precompiled by `tools/light-compile` natively, it's stopped
+ * by `stop()` like `animate`.
+ *
+ * @method playSequence
+ * @instance
+ * @memberof yodaRT.light.LightRenderingContext
+ * @param {string} file - the path of the `.lseq` file.
+ * @param {object} [options] - the `repeat` and `layer` of the play.
+ * @param {function} [callback] - called with `cancelled` when the play ends.
+ * @returns {object} the `frames`, `duration`, `loop` and `finishes` of the
+ *          sequence.
+ */
+LightRenderingContext.prototype.playSequence = function (file, options, callback) {
+  if (this._getCurrentId() !== this._id) {
+    return
+  }
+  animatingContext = this
+  return light.playSequence(file, options, (cancelled) => {
+    if (animatingContext === this && !cancelled) {
+      animatingContext = null
+    }
+    callback && callback(cancelled)
+  })
+}
+
+/**
+ * Create or update a layer which is stacked over the pixels by its z-order,
+ * it's removed when the context is stopped. The layer could be drawn by
+ * `drawLayer` or animated by `animate` with the `layer` option, so that an
+ * overlay doesn't re-render the effect below it.
+ *
+ * @method layer
+ * @instance
+ * @memberof yodaRT.light.LightRenderingContext
+ * @param {string} name - the layer name.
+ * @param {object} [options] - the `z`, `alpha` and `keyed` of the layer.
+ */
+LightRenderingContext.prototype.layer = function (name, options) {
+  if (this._getCurrentId() !== this._id) {
+    return
+  }
+  this._layers[name] = true
+  return light.setLayer(name, options)
+}
+
+/**
+ * Draw a layer created by `layer`.
+ *
+ * @method drawLayer
+ * @instance
+ * @memberof yodaRT.light.LightRenderingContext
+ * @param {string} name - the layer name.
+ * @param {Buffer|yodaRT.light.Color} frame - the pixels or the color to fill.
+ * @param {Buffer} [mask] - the opacity of every pixel from 0 to 255.
+ */
+LightRenderingContext.prototype.drawLayer = function (name, frame, mask) {
+  if (this._getCurrentId() !== this._id) {
+    return
+  }
+  return light.drawLayer(name, frame, mask)
+}
+
+/**
+ * Remove a layer created by `layer`.
+ *
+ * @method removeLayer
+ * @instance
+ * @memberof yodaRT.light.LightRenderingContext
+ * @param {string} name - the layer name.
+ */
+LightRenderingContext.prototype.removeLayer = function (name) {
+  delete this._layers[name]
+  return light.removeLayer(name)
+}
+
 /**
  * @callback yodaRT.light.LightRenderingContext~renderCallback
  * @param {number} r - the REG color.
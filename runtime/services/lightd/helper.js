@@ -30,3 +30,29 @@ function getMaxLayer (LayerDefine, maxSystemspaceLayers) {
   }
   return layers
 }
+
+module.exports.getSequenceName = getSequenceName
+/**
+ * Get the name of the precompiled sequence of a light script with the given
+ * data, it's shared with `tools/light-compile`.
+ * @param {string} uri - the path of the light script.
+ * @param {object} [data] - the data passed to the script.
+ * @returns {string|null} null if the data can't be a part of the name.
+ */
+function getSequenceName (uri, data) {
+  var name = uri.replace(/^.*\//, '').replace(/\.js$/, '')
+  var keys = Object.keys(data || {}).sort()
+  var params = []
+  for (var i = 0; i < keys.length; i++) {
+    var value = data[keys[i]]
+    var type = typeof value
+    if (type !== 'number' && type !== 'string' && type !== 'boolean') {
+      return null
+    }
+    params.push(`${keys[i]}=${encodeURIComponent(String(value))}`)
+  }
+  if (params.length > 0) {
+    name += '@' + params.join(',')
+  }
+  return name + '.lseq'
+}
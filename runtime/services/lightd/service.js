@@ -6,6 +6,8 @@ var AudioManager = require('@yoda/audio').AudioManager
 var MediaPlayer = require('@yoda/multimedia').MediaPlayer
 var helper = require('./helper')
 var light = require('@yoda/light')
+var fs = require('fs')
+var path = require('path')
 
 var LIGHT_SOURCE = '/opt/light/'
 var maxUserspaceLayers = 3
@@ -34,6 +36,8 @@ function Light () {
   this.nextResumeTimer = null
   this.degree = 0
   this.uriHandlers = {}
+  // the existence of the precompiled sequences by path
+  this.sequences = {}
   this.init()
 }
 
@@ -182,11 +186,15 @@ Light.prototype.loadfile = function (appId, uri, data, option, callback) {
     if (option.shouldResume === true) {
       this.setResume(appId, isSystemUri, zIndex, uri, data, context)
     }
-    this.prev = handle(context, data || {}, () => {
+    var done = () => {
       setTimeout(() => {
         this.prevCallback && this.prevCallback()
       }, 0)
-    })
+    }
+    var sequence = this.getSequence(uri, data)
+    if (sequence === null || !this.playSequence(context, sequence, done)) {
+      this.prev = handle(context, data || {}, done)
+    }
     this.prevUri = uri
     this.prevZIndex = zIndex
     this.prevAppId = appId
@@ -200,6 +208,52 @@ Light.prototype.loadfile = function (appId, uri, data, option, callback) {
   }
 }
 
+/**
+ * Get the precompiled sequence of the light script with the data.
+ * @param {string} uri light uri
+ * @param {object} data the data passed to the light
+ * @returns {string|null} the path of the sequence if it exists
+ */
+Light.prototype.getSequence = function (uri, data) {
+  var name = helper.getSequenceName(uri, data)
+  if (name === null) {
+    return null
+  }
+  var file = path.join(path.dirname(uri), name)
+  if (this.sequences[file] === undefined) {
+    this.sequences[file] = fs.existsSync(file)
+  }
+  return this.sequences[file] ? file : null
+}
+
+/**
+ * Play the precompiled sequence instead of running the light script.
+ * @param {object} context the light context
+ * @param {string} file the path of the sequence
+ * @param {function} callback called if the script would call back at the end
+ * @returns {boolean} false if the sequence can't be played
+ */
+Light.prototype.playSequence = function (context, file, callback) {
+  var info
+  try {
+    info = context.playSequence(file, null, (cancelled) => {
+      if (!cancelled && info.finishes) {
+        callback()
+      }
+    })
+  } catch (error) {
+    logger.error(`play sequence ${file} error, fallback to the script`, error)
+    this.sequences[file] = false
+    return false
+  }
+  if (!info) {
+    return false
+  }
+  logger.info(`play sequence ${file} of ${info.frames} frames in ${info.duration}ms`)
+  this.prev = null
+  return true
+}
+
 Light.prototype.setResume = function (appId, isSystemUri, zIndex, uri, data, context) {
   var handle = null
   try {
@@ -84,6 +84,15 @@ service.on('bufferingupdate', function (id, dur, pos) {
     [id, 'bufferingupdate', dur, pos]
   )
 })
+service.on('positionupdate', function (id, dur, pos) {
+  dbusService._dbus.emitSignal(
+    '/multimedia/service',
+    'multimedia.service',
+    'multimediadevent',
+    'ssdd',
+    [id, 'positionupdate', dur, pos]
+  )
+})
 service.on('seekcomplete', function (id, dur, pos) {
   logger.log('multimediad-event seek complete', id, dur, pos)
   dbusService._dbus.emitSignal(
@@ -140,6 +149,23 @@ dbusApis.addMethod('prepare', {
   }
 })
 
+dbusApis.addMethod('prefetch', {
+  in: ['s', 's'],
+  out: ['b']
+}, function (url, streamType, cb) {
+  logger.log('multimedia prefetch', url, streamType)
+  if (!url) {
+    logger.log('prefetch: url is required')
+    return cb(null, false)
+  }
+  try {
+    cb(null, service.prefetch(url, streamType))
+  } catch (err) {
+    logger.error(`Unexpected error on prefetch multimedia ${url}`, err.stack)
+    cb(null, false)
+  }
+})
+
 dbusApis.addMethod('start', {
   in: ['s', 's', 's', 's'],
   out: ['s']
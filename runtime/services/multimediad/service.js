@@ -8,6 +8,8 @@ var logger = require('logger')('multimediaService')
 var Manager = require('./manager')
 
 var audioModuleName = 'multimedia'
+// the minimum interval of `bufferingupdate` events forwarded to apps
+var BUFFERING_UPDATE_INTERVAL = 500
 AudioManager.setPlayingState(audioModuleName, false)
 
 function MultiMedia (lightd) {
@@ -41,10 +43,29 @@ MultiMedia.prototype.prepare = function prepare (appId, url, streamType, options
   }
   this.listenEvent(player, appId)
   this.playerManager.appendByAppId(appId, player)
+  if (options && options.positionInterval > 0) {
+    player.watchPosition(options.positionInterval, options.positionThreshold)
+  }
   player.prepare(url)
+  // refill the idle player taken by this one for the next item.
+  setImmediate(() => MediaPlayer.warmup(player._stream, 1))
   return player
 }
 
+/**
+ * Start connecting and buffering the next item of a playlist, the following
+ * `prepare` or `start` with the same url and stream type takes it.
+ * @param {string} url
+ * @param {string} streamType
+ * @returns {boolean}
+ */
+MultiMedia.prototype.prefetch = function prefetch (url, streamType) {
+  var stream = streamType === 'alarm'
+    ? AudioManager.STREAM_ALARM
+    : AudioManager.STREAM_PLAYBACK
+  return MediaPlayer.prefetch(url, stream)
+}
+
 MultiMedia.prototype.start = function (appId, url, streamType, options) {
   var player = this.prepare(appId, url, streamType, options)
   player.once('prepared', () => player.start())
@@ -283,6 +304,7 @@ MultiMedia.prototype.setSpeed = function (appId, speed, playerId) {
 }
 
 MultiMedia.prototype.listenEvent = function (player, appId) {
+  player.setEventInterval('bufferingupdate', BUFFERING_UPDATE_INTERVAL)
   player.on('prepared', () => {
     this.emit('prepared', '' + player.id, player.duration, player.position)
     AudioManager.setPlayingState(audioModuleName, true)
@@ -301,6 +323,9 @@ MultiMedia.prototype.listenEvent = function (player, appId) {
   player.on('bufferingupdate', () => {
     this.emit('bufferingupdate', '' + player.id, player.duration, player.position)
   })
+  player.on('positionupdate', (position, duration) => {
+    this.emit('positionupdate', '' + player.id, duration, position)
+  })
   player.on('seekcomplete', () => {
     this.emit('seekcomplete', '' + player.id, player.duration, player.position)
     AudioManager.setPlayingState(audioModuleName, true)
@@ -387,6 +412,7 @@ MultiMedia.prototype.getState = function (appId, playerId) {
 MultiMedia.prototype.reset = function () {
   try {
     this.playerManager.reset()
+    MediaPlayer.clearPool()
     AudioManager.setPlayingState(audioModuleName, false)
   } catch (error) {
     logger.error('error when try to stop all player', error.stack)
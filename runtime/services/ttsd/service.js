@@ -251,6 +251,10 @@ Tts.prototype.connect = function connect (CONFIG) {
   this.nativeWrap.on('end', this.onTtsTermination.bind(this, 'end'))
   this.nativeWrap.on('cancel', this.onTtsTermination.bind(this, 'cancel'))
   this.nativeWrap.on('error', this.onTtsTermination.bind(this, 'error'))
+  this.nativeWrap.setTrace(true)
+  this.nativeWrap.on('trace', (id, stats) => {
+    logger.info(`tts(${id}) latency: ${JSON.stringify(stats.latency)}, underruns: ${stats.underruns}`)
+  })
 }
 
 module.exports = Tts
@@ -0,0 +1,81 @@
+'use strict'
+
+var test = require('tape')
+var AudioManager = require('@yoda/audio').AudioManager
+
+test('define the curve of 101 values', (t) => {
+  var values = new Int32Array(101)
+  for (var i = 0; i <= 100; i++) {
+    values[i] = i * 2
+  }
+  AudioManager.defineVolumeCurve('test-table', values)
+  var curve = AudioManager.getVolumeCurve('test-table')
+  t.equal(curve.length, 101)
+  t.equal(curve[0], 0)
+  t.equal(curve[50], 100)
+  t.equal(curve[100], 200)
+  t.ok(AudioManager.removeVolumeCurve('test-table'))
+  t.end()
+})
+
+test('interpolate the control points', (t) => {
+  var points = [ [0, 0], [50, 10], [100, 1000] ]
+  AudioManager.defineVolumeCurve('test-linear', points)
+  AudioManager.defineVolumeCurve('test-db', points, {
+    interpolation: AudioManager.INTERPOLATION_DB
+  })
+  AudioManager.defineVolumeCurve('test-log', points, {
+    interpolation: AudioManager.INTERPOLATION_LOG
+  })
+  var linear = AudioManager.getVolumeCurve('test-linear')
+  var db = AudioManager.getVolumeCurve('test-db')
+  var log = AudioManager.getVolumeCurve('test-log')
+  t.equal(linear[25], 5)
+  t.equal(linear[75], 505)
+  t.equal(db[75], 100)
+  t.equal(log[75], 743)
+  ;[linear, db, log].forEach((curve) => {
+    t.equal(curve[50], 10)
+    t.equal(curve[100], 1000)
+  })
+  t.end()
+})
+
+test('switch the named curves', (t) => {
+  AudioManager.defineVolumeCurve('test-a', [ [0, 0], [100, 100] ])
+  AudioManager.defineVolumeCurve('test-b', [ 0, 50, 100 ], {
+    interpolation: AudioManager.INTERPOLATION_LOG
+  })
+  AudioManager.useVolumeCurve('test-b')
+  AudioManager.useVolumeCurve('test-a')
+  t.throws(() => {
+    AudioManager.useVolumeCurve('test-unknown')
+  }, /unknown volume curve/)
+  // the curve of the driver is global and can't be read back, so restore the
+  // shaper of this process or the linear one applied by the simple tests.
+  if (AudioManager.getVolumeCurve('shaper')) {
+    AudioManager.useVolumeCurve('shaper')
+  } else {
+    AudioManager.setVolumeShaper(AudioManager.LINEAR_RAMP)
+  }
+  t.ok(AudioManager.removeVolumeCurve('test-a'))
+  t.ok(AudioManager.removeVolumeCurve('test-b'))
+  t.end()
+})
+
+test('reject the invalid curves', (t) => {
+  t.throws(() => {
+    AudioManager.defineVolumeCurve('test-invalid', [ 1 ])
+  }, RangeError)
+  t.throws(() => {
+    AudioManager.defineVolumeCurve('test-invalid', [ [0, 0], [90, 100] ])
+  }, RangeError)
+  t.throws(() => {
+    AudioManager.defineVolumeCurve('test-invalid', [ [0, 0], [60, 10], [50, 20], [100, 30] ])
+  }, RangeError)
+  t.throws(() => {
+    AudioManager.defineVolumeCurve('test-invalid', [ 0, -1, 100 ])
+  }, RangeError)
+  t.equal(AudioManager.getVolumeCurve('test-invalid'), undefined)
+  t.end()
+})
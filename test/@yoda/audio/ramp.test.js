@@ -0,0 +1,68 @@
+'use strict'
+
+var test = require('tape')
+var AudioManager = require('@yoda/audio').AudioManager
+
+test('ramp the volume to the target', (t) => {
+  t.plan(3)
+  AudioManager.setVolume(AudioManager.STREAM_TTS, 10)
+  AudioManager.rampVolume(AudioManager.STREAM_TTS, 60, 100, (cancelled, volume) => {
+    t.equal(cancelled, false)
+    t.equal(volume, 60)
+    t.equal(AudioManager.getVolume(AudioManager.STREAM_TTS), 60)
+  })
+})
+
+test('ramp the volume without persisting', (t) => {
+  t.plan(2)
+  AudioManager.setVolume(AudioManager.STREAM_TTS, 30)
+  AudioManager.rampVolume(AudioManager.STREAM_TTS, 0, 50, {
+    curve: AudioManager.FADE_EASE_OUT,
+    persist: false
+  }, (cancelled, volume) => {
+    t.equal(volume, 0)
+    t.equal(AudioManager.getVolume(AudioManager.STREAM_TTS), 30)
+  })
+})
+
+test('cancel the ramp', (t) => {
+  t.plan(3)
+  AudioManager.setVolume(AudioManager.STREAM_TTS, 0)
+  AudioManager.rampVolume(AudioManager.STREAM_TTS, 100, 5000, (cancelled, volume) => {
+    t.equal(cancelled, true)
+    t.ok(volume < 100)
+  })
+  t.equal(AudioManager.cancelRamp(AudioManager.STREAM_TTS), true)
+})
+
+test('the new ramp cancels the running one', (t) => {
+  t.plan(3)
+  AudioManager.setVolume(AudioManager.STREAM_TTS, 0)
+  AudioManager.rampVolume(AudioManager.STREAM_TTS, 100, 5000, (cancelled) => {
+    t.equal(cancelled, true)
+  })
+  AudioManager.rampVolume(AudioManager.STREAM_TTS, 20, 50, (cancelled, volume) => {
+    t.equal(cancelled, false)
+    t.equal(volume, 20)
+  })
+})
+
+test('ramp the invalid stream', (t) => {
+  t.throws(() => {
+    AudioManager.rampVolume(undefined, 10, 100)
+  }, /invalid stream type/)
+  t.throws(() => {
+    AudioManager.rampVolume(AudioManager.STREAM_TTS, 'a', 100)
+  }, /vol must be a number/)
+  t.end()
+})
+
+test('refreshing the volume keeps the running ramp', (t) => {
+  t.plan(2)
+  AudioManager.setVolume(AudioManager.STREAM_TTS, 0)
+  AudioManager.rampVolume(AudioManager.STREAM_TTS, 40, 100, (cancelled, volume) => {
+    t.equal(cancelled, false)
+    t.equal(volume, 40)
+  })
+  AudioManager.refreshVolume(AudioManager.STREAM_TTS)
+})
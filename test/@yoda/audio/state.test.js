@@ -0,0 +1,55 @@
+'use strict'
+
+var test = require('tape')
+var AudioManager = require('@yoda/audio').AudioManager
+
+test('get the state of all streams', (t) => {
+  AudioManager.setVolume(AudioManager.STREAM_TTS, 40)
+  var state = AudioManager.getState()
+  t.equal(typeof state.muted, 'boolean')
+  t.equal(typeof state.volume, 'number')
+  t.equal(state.muted, AudioManager.isMuted())
+  ;['audio', 'tts', 'ring', 'voiceCall', 'playback', 'alarm', 'system'].forEach((name) => {
+    t.equal(typeof state.streams[name].volume, 'number', `${name} volume`)
+    t.equal(typeof state.streams[name].playing, 'boolean', `${name} playing`)
+  })
+  t.equal(state.streams.tts.volume, 40)
+  t.end()
+})
+
+test('refresh the state from the driver', (t) => {
+  AudioManager.setVolume(AudioManager.STREAM_TTS, 45)
+  t.equal(AudioManager.getState(true).streams.tts.volume, 45)
+  t.end()
+})
+
+test('subscribe the volume changes', (t) => {
+  t.plan(3)
+  AudioManager.setVolume(AudioManager.STREAM_TTS, 20)
+  function listener (change) {
+    if (change.type !== 'stream-volume' || change.stream !== 'tts') {
+      return
+    }
+    AudioManager.unsubscribe(listener)
+    t.equal(change.value, 21)
+    t.equal(AudioManager.getState().streams.tts.volume, 21)
+  }
+  AudioManager.subscribe(listener)
+  AudioManager.setVolume(AudioManager.STREAM_TTS, 21)
+  t.pass('subscribed')
+})
+
+test('subscribe the mute changes', (t) => {
+  t.plan(1)
+  var muted = AudioManager.isMuted()
+  function listener (change) {
+    if (change.type !== 'mute') {
+      return
+    }
+    AudioManager.unsubscribe(listener)
+    AudioManager.setMute(muted)
+    t.equal(change.value, !muted)
+  }
+  AudioManager.subscribe(listener)
+  AudioManager.setMute(!muted)
+})
@@ -0,0 +1,73 @@
+'use strict'
+
+var test = require('tape')
+var fs = require('fs')
+var InputEvent = require('@yoda/input').InputEvent
+
+var recordPath = '/tmp/input-replay.test.record'
+
+test('replay the recorded events', (t) => {
+  fs.writeFileSync(recordPath, [
+    '# yoda input record v1',
+    'K 1000000 1 0 113',
+    'K 1050000 0 0 113',
+    'G 1060000 1 113 0 1 0',
+    ''
+  ].join('\n'))
+
+  var input = new InputEvent()
+  var events = []
+  input.on('keydown', (event) => events.push('keydown:' + event.keyCode))
+  input.on('keyup', (event) => events.push('keyup:' + event.keyCode))
+  input.on('click', (event) => events.push('click:' + event.keyCode))
+  var r = input.replay(recordPath, { speed: 0 }, (err, stats) => {
+    t.error(err)
+    t.deepEqual(events, [ 'keydown:113', 'keyup:113', 'click:113' ])
+    t.equal(stats.count, 3, 'all events are measured')
+    t.ok(stats.p99 >= stats.p50, 'p99 is not less than p50')
+    fs.unlinkSync(recordPath)
+    t.end()
+  })
+  t.equal(r, 0, 'replay is started')
+})
+
+test('recognize the gestures from the replayed events', (t) => {
+  fs.writeFileSync(recordPath, [
+    '# yoda input record v1',
+    // double click
+    'K 1000000 1 0 113',
+    'K 1050000 0 0 113',
+    'K 1100000 1 0 113',
+    'K 1150000 0 0 113',
+    // long press with one repeat
+    'K 2000000 1 0 115',
+    'K 2350000 0 0 115',
+    // combo
+    'K 3000000 1 0 113',
+    'K 3050000 1 0 114',
+    'K 3100000 0 0 113',
+    'K 3100000 0 0 114',
+    ''
+  ].join('\n'))
+
+  var input = new InputEvent()
+  var raw = 0
+  var gestures = []
+  input.on('keydown', () => raw++)
+  input.on('gesture', (event) => gestures.push(`${event.name}:${event.value}`))
+  input.setGestures({
+    gestures: [
+      { name: 'mute', type: 'click', keyCode: 113, window: 200 },
+      { name: 'volume-up', type: 'longpress', keyCode: 115, threshold: 200, repeat: 100 },
+      { name: 'reset', type: 'combo', keys: [ 113, 114 ], window: 100 }
+    ]
+  })
+  input.replay(recordPath, { speed: 1 }, (err) => {
+    t.error(err)
+    t.equal(raw, 0, 'no raw events are emitted')
+    t.deepEqual(gestures, [ 'mute:2', 'volume-up:0', 'volume-up:1', 'reset:2' ])
+    input.setGestures({ gestures: [] })
+    fs.unlinkSync(recordPath)
+    t.end()
+  })
+})
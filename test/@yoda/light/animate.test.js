@@ -0,0 +1,68 @@
+'use strict'
+
+var test = require('tape')
+var light = require('@yoda/light')
+
+test('animate should call back when completed', t => {
+  var start = Date.now()
+  light.animate([
+    { time: 0, frame: { r: 0, g: 0, b: 0 }, easing: 'easeInOut' },
+    { time: 300, frame: { r: 0, g: 0, b: 150 } }
+  ], (cancelled) => {
+    t.strictEqual(cancelled, false)
+    t.ok(Date.now() - start >= 300)
+    t.end()
+  })
+})
+
+test('animate should be cancelled by stopAnimation', t => {
+  var profile = light.getProfile()
+  var frame = Buffer.alloc(profile.leds * profile.format)
+  frame.fill(255)
+  light.animate([
+    { time: 0, frame: frame },
+    { time: 100, frame: { r: 0, g: 0, b: 0 }, easing: 'step' },
+    { time: 200, frame: frame }
+  ], { repeat: -1 }, (cancelled) => {
+    t.strictEqual(cancelled, true)
+    t.end()
+  })
+  setTimeout(() => light.stopAnimation(), 500)
+})
+
+test('animate should be cancelled by the next one', t => {
+  t.plan(2)
+  var keyframes = [
+    { time: 0, frame: { r: 255, g: 0, b: 0 } },
+    { time: 1000, frame: { r: 0, g: 255, b: 0 } }
+  ]
+  light.animate(keyframes, (cancelled) => t.strictEqual(cancelled, true))
+  light.animate(keyframes, { fps: 10 }, (cancelled) => t.strictEqual(cancelled, false))
+})
+
+test('animate with invalid keyframes', t => {
+  t.throws(() => light.animate([]), /empty/)
+  t.throws(() => light.animate([
+    { time: 0, frame: { r: 0, g: 0, b: 0 }, easing: 'bounce' }
+  ]), TypeError)
+  t.throws(() => light.animate([
+    { time: 100, frame: { r: 0, g: 0, b: 0 } },
+    { time: 0, frame: { r: 0, g: 0, b: 0 } }
+  ]), /time order/)
+  t.end()
+})
+
+test('the last frame of animate should be kept by the next write', {
+  skip: light.getDriverRecords() === null
+}, t => {
+  light.fill(255, 0, 0)
+  light.animate([
+    { time: 0, frame: { r: 0, g: 0, b: 0 } },
+    { time: 100, frame: { r: 0, g: 0, b: 150 } }
+  ], (cancelled) => {
+    t.strictEqual(cancelled, false)
+    t.ok(light.write())
+    t.deepEqual(light.getDriverRecords().lastFrame.slice(0, 3), [0, 0, 150])
+    t.end()
+  })
+})
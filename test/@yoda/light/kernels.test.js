@@ -0,0 +1,124 @@
+'use strict'
+
+var test = require('tape')
+var light = require('@yoda/light')
+var profile = light.getProfile()
+var leds = profile.leds
+
+test('colors and gradient should be ok', t => {
+  var buf = Buffer.alloc(leds * profile.format)
+  buf.fill(100)
+  light.colors(buf)
+  t.ok(light.write())
+  light.colors(Buffer.from([255, 0, 0]), leds - 1)
+  t.ok(light.write())
+  light.gradient(0, leds - 1, { r: 255, g: 0, b: 0 }, { r: 0, g: 0, b: 255, a: 0.5 })
+  t.ok(light.write())
+  t.throws(() => light.colors(buf, leds), /out of range/)
+  t.end()
+})
+
+test('scale and blend should be ok', t => {
+  var buf = Buffer.alloc(leds * profile.format)
+  buf.fill(255)
+  light.fill(255, 0, 0).scale(0.5)
+  t.ok(light.write())
+  light.blend(buf, 0.3)
+  t.ok(light.write())
+  t.throws(() => light.blend(Buffer.alloc(1), 0.5), /smaller than the frame/)
+  t.end()
+})
+
+test('rotate and shift should be ok', t => {
+  light.clear().pixel(0, 0, 255, 0, 1, true)
+  for (var i = 0; i < leds; i++) {
+    light.rotate(1)
+    t.ok(light.write())
+  }
+  light.shift(-leds)
+  t.ok(light.write())
+  t.end()
+})
+
+test('brightness should be applied on render', t => {
+  light.fill(255, 255, 255)
+  light.setBrightness(0.2)
+  t.ok(light.write())
+  light.setBrightness(1)
+  t.ok(light.write())
+  t.end()
+})
+
+// the values are checked on the frames drawn by the fake driver only
+var fake = { skip: light.getDriverRecords() === null }
+
+function drawnPixel (index) {
+  var frame = light.getDriverRecords().lastFrame
+  var offset = index * profile.format
+  return frame.slice(offset, offset + 3)
+}
+
+test('gradient should be drawn', fake, t => {
+  light.clear()
+  light.gradient(0, leds - 1, { r: 255, g: 0, b: 0 }, { r: 0, g: 0, b: 255 })
+  t.ok(light.write())
+  t.deepEqual(drawnPixel(0), [255, 0, 0])
+  t.deepEqual(drawnPixel(leds - 1), [0, 0, 255])
+  for (var i = 1; i < leds; i++) {
+    var prev = drawnPixel(i - 1)
+    var pixel = drawnPixel(i)
+    t.ok(pixel[0] <= prev[0] && pixel[2] >= prev[2], `LED ${i} is between`)
+    t.ok(pixel[0] + pixel[2] >= 254, `LED ${i} is interpolated linearly`)
+  }
+  t.end()
+})
+
+test('scale and blend should be drawn', fake, t => {
+  var buf = Buffer.alloc(leds * profile.format)
+  buf.fill(255)
+  light.fill(255, 0, 0).scale(0.5)
+  t.ok(light.write())
+  t.deepEqual(drawnPixel(0), [127, 0, 0])
+  t.deepEqual(drawnPixel(leds - 1), [127, 0, 0])
+  // the alpha 0.3 is 76/256
+  light.blend(buf, 0.3)
+  t.ok(light.write())
+  t.deepEqual(drawnPixel(0), [165, 75, 75])
+  t.deepEqual(drawnPixel(leds - 1), [165, 75, 75])
+  t.end()
+})
+
+test('rotate and shift should be drawn', fake, t => {
+  light.clear().pixel(0, 0, 255, 0)
+  light.rotate(1)
+  t.ok(light.write())
+  t.deepEqual(drawnPixel(0), [0, 0, 0])
+  t.deepEqual(drawnPixel(1), [0, 255, 0])
+  light.rotate(-2)
+  t.ok(light.write())
+  t.deepEqual(drawnPixel(leds - 1), [0, 255, 0])
+  light.shift(1)
+  t.ok(light.write())
+  t.deepEqual(drawnPixel(0), [0, 0, 0])
+  t.deepEqual(drawnPixel(leds - 1), [0, 0, 0])
+  light.pixel(0, 0, 255, 0).shift(2)
+  t.ok(light.write())
+  t.deepEqual(drawnPixel(0), [0, 0, 0])
+  t.deepEqual(drawnPixel(2), [0, 255, 0])
+  light.shift(-3)
+  t.ok(light.write())
+  t.deepEqual(drawnPixel(leds - 1), [0, 0, 0])
+  t.end()
+})
+
+test('brightness should be drawn', fake, t => {
+  light.fill(255, 255, 255)
+  light.setBrightness(0.2)
+  t.ok(light.write())
+  // the brightness 0.2 is 51/256
+  t.deepEqual(drawnPixel(0), [50, 50, 50])
+  light.setBrightness(1)
+  t.ok(light.write())
+  t.deepEqual(drawnPixel(0), [255, 255, 255])
+  t.end()
+})
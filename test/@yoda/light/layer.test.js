@@ -0,0 +1,58 @@
+'use strict'
+
+var test = require('tape')
+var light = require('@yoda/light')
+var profile = light.getProfile()
+
+test('layers should be stacked over the buffer', t => {
+  light.fill(0, 0, 150).write()
+  light.setLayer('overlay', { z: 1, keyed: true })
+  var frame = Buffer.alloc(profile.leds * profile.format)
+  frame.fill(255, 0, profile.format)
+  light.drawLayer('overlay', frame)
+  t.ok(light.write())
+  light.setLayer('dim', { z: 2, alpha: 0.5 })
+  light.drawLayer('dim', { r: 0, g: 0, b: 0 })
+  t.ok(light.write())
+  t.ok(light.removeLayer('dim'))
+  t.ok(light.removeLayer('overlay'))
+  t.notOk(light.removeLayer('overlay'))
+  t.ok(light.write())
+  t.end()
+})
+
+test('drawing a missing layer should throw', t => {
+  t.throws(() => light.drawLayer('missing', { r: 0, g: 0, b: 0 }), /not found/)
+  t.end()
+})
+
+test('animate should update the layer only', t => {
+  light.setLayer('ring', { z: 1 })
+  light.animate([
+    { time: 0, frame: { r: 0, g: 0, b: 0 } },
+    { time: 200, frame: { r: 255, g: 255, b: 255 } }
+  ], { layer: 'ring' }, (cancelled) => {
+    t.strictEqual(cancelled, false)
+    t.ok(light.removeLayer('ring'))
+    light.write()
+    t.end()
+  })
+})
+
+test('animate a layer over the rendered buffer', {
+  skip: light.getDriverRecords() === null
+}, t => {
+  light.fill(0, 0, 150).write()
+  light.setLayer('halo', { z: 1, alpha: 0.5 })
+  light.animate([
+    { time: 0, frame: { r: 200, g: 0, b: 0 } },
+    { time: 100, frame: { r: 200, g: 0, b: 0 } }
+  ], { layer: 'halo' }, (cancelled) => {
+    t.strictEqual(cancelled, false)
+    // the halo is blended by 128/256 over the buffer instead of the black
+    t.deepEqual(light.getDriverRecords().lastFrame.slice(0, 3), [100, 0, 75])
+    t.ok(light.removeLayer('halo'))
+    light.write()
+    t.end()
+  })
+})
@@ -0,0 +1,87 @@
+'use strict'
+
+var test = require('tape')
+var fs = require('fs')
+var light = require('@yoda/light')
+var profile = light.getProfile()
+
+function writeSequence (file, leds, frames, duration, flags) {
+  var size = leds * profile.format
+  var header = Buffer.alloc(16)
+  header.write('YLS1', 0)
+  header.writeUInt16LE(leds, 4)
+  header.writeUInt8(profile.format, 6)
+  header.writeUInt8(flags, 7)
+  header.writeUInt32LE(frames.length, 8)
+  header.writeUInt32LE(duration, 12)
+  var body = Buffer.alloc(frames.length * (4 + size))
+  frames.forEach((value, index) => {
+    body.writeUInt32LE(index * 100, index * (4 + size))
+    body.fill(value, index * (4 + size) + 4, (index + 1) * (4 + size))
+  })
+  fs.writeFileSync(file, Buffer.concat([header, body]))
+}
+
+test('play a sequence with its timings', t => {
+  var file = '/tmp/light-test.lseq'
+  writeSequence(file, profile.leds, [0, 80, 160], 300, 2)
+  var start = Date.now()
+  var info = light.playSequence(file, (cancelled) => {
+    t.strictEqual(cancelled, false)
+    t.ok(Date.now() - start >= 300)
+    fs.unlinkSync(file)
+    t.end()
+  })
+  t.strictEqual(info.frames, 3)
+  t.strictEqual(info.duration, 300)
+  t.strictEqual(info.loop, false)
+  t.strictEqual(info.finishes, true)
+})
+
+test('a looping sequence is stopped by stopAnimation', t => {
+  var file = '/tmp/light-loop.lseq'
+  writeSequence(file, profile.leds, [0, 255], 200, 1)
+  var info = light.playSequence(file, (cancelled) => {
+    t.strictEqual(cancelled, true)
+    fs.unlinkSync(file)
+    t.end()
+  })
+  t.strictEqual(info.loop, true)
+  setTimeout(() => light.stopAnimation(), 500)
+})
+
+test('a sequence of another profile is rejected', t => {
+  var file = '/tmp/light-other.lseq'
+  writeSequence(file, profile.leds + 1, [0], 0, 0)
+  t.throws(() => light.playSequence(file), /Failed to load/)
+  t.throws(() => light.playSequence('/tmp/not-exists.lseq'), /Failed to load/)
+  fs.unlinkSync(file)
+  t.end()
+})
+
+test('a truncated sequence is rejected', t => {
+  var file = '/tmp/light-truncated.lseq'
+  writeSequence(file, profile.leds, [0, 255], 200, 0)
+  var data = fs.readFileSync(file)
+  // claims more frames than the file holds
+  data.writeUInt32LE(0x10000000, 8)
+  fs.writeFileSync(file, data)
+  t.throws(() => light.playSequence(file), /Failed to load/)
+  fs.unlinkSync(file)
+  t.end()
+})
+
+test('the last frame of a sequence should be kept by the next write', {
+  skip: light.getDriverRecords() === null
+}, t => {
+  var file = '/tmp/light-last.lseq'
+  writeSequence(file, profile.leds, [0, 80, 160], 300, 0)
+  light.clear()
+  light.playSequence(file, (cancelled) => {
+    t.strictEqual(cancelled, false)
+    t.ok(light.write())
+    t.deepEqual(light.getDriverRecords().lastFrame.slice(0, 3), [160, 160, 160])
+    fs.unlinkSync(file)
+    t.end()
+  })
+})
@@ -0,0 +1,34 @@
+'use strict'
+
+var test = require('tape')
+var light = require('@yoda/light')
+
+test('unchanged frames should be skipped', t => {
+  light.fill(10, 20, 30).write()
+  light.getStats(true)
+  light.write()
+  light.write()
+  var stats = light.getStats(true)
+  t.strictEqual(stats.drawn, 0)
+  t.strictEqual(stats.skipped, 2)
+
+  light.pixel(0, 255, 255, 255).write()
+  stats = light.getStats()
+  t.strictEqual(stats.drawn, 1)
+  t.strictEqual(stats.skipped, 0)
+  t.end()
+})
+
+test('brightness and explicit writes should redraw', t => {
+  light.fill(10, 20, 30).write()
+  light.getStats(true)
+  light.setBrightness(0.5).write()
+  light.setBrightness(1)
+  var profile = light.getProfile()
+  light.write(Buffer.alloc(profile.leds * profile.format))
+  light.write()
+  var stats = light.getStats(true)
+  t.strictEqual(stats.drawn, 2)
+  t.strictEqual(stats.skipped, 0)
+  t.end()
+})
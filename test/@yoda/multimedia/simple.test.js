@@ -219,3 +219,49 @@ test.skip('set/get volume 101', (t) => {
   })
   player.start('http://www.9ku.com/play/186947.htm')
 })
+
+test('set the minimum event interval', (t) => {
+  var player = new MediaPlayer()
+  t.doesNotThrow(() => {
+    player.setEventInterval('bufferingupdate', 500)
+    player.setEventInterval('playingstatus', 0)
+  })
+  t.throws(() => {
+    player.setEventInterval('foobar', 500)
+  }, /unknown event name foobar/)
+  t.throws(() => {
+    player.setEventInterval('positionupdate', 500)
+  }, /set by watchPosition/)
+  t.throws(() => {
+    player.setEventInterval('bufferingupdate', -1)
+  }, TypeError)
+  player.disconnect()
+  t.end()
+})
+
+test('warmup and prefetch the players', (t) => {
+  t.plan(3)
+  t.equal(MediaPlayer.warmup(AudioManager.STREAM_PLAYBACK, 2), 2)
+  MediaPlayer.prefetch('/opt/media/wakeup.ogg')
+  var player = new MediaPlayer()
+  player.on('prepared', () => {
+    t.pass('the prefetched player is prepared')
+    player.disconnect()
+    MediaPlayer.clearPool()
+    t.equal(MediaPlayer.warmup(AudioManager.STREAM_PLAYBACK, 0), 0)
+  })
+  player.prepare('/opt/media/wakeup.ogg')
+})
+
+test('watch the position updates', (t) => {
+  var player = new MediaPlayer()
+  player.once('positionupdate', (position, duration) => {
+    t.equal(typeof position, 'number')
+    t.equal(typeof duration, 'number')
+    player.unwatchPosition()
+    player.disconnect()
+    t.end()
+  })
+  player.watchPosition(100)
+  player.start('/opt/media/wakeup.ogg')
+})
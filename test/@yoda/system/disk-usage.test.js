@@ -0,0 +1,74 @@
+'use strict'
+
+var test = require('tape')
+var fs = require('fs')
+var sys = require('@yoda/system')
+
+test('module->diskusage: get the usages of the paths asynchronously', t => {
+  sys.diskUsageAsync([ '/data', '/tmp', '/aaa/dddd' ], (err, usages) => {
+    t.error(err)
+    t.equal(usages.length, 3)
+    t.equal(usages[0].path, '/data')
+    t.equal(usages[0].total, sys.diskUsage('/data').total)
+    t.ok(usages[1].available > 0)
+    t.equal(usages[2].path, '/aaa/dddd')
+    t.ok(/No such file or directory/.test(usages[2].error))
+    t.end()
+  })
+})
+
+test('module->diskusage: get the usage of a path asynchronously', t => {
+  sys.diskUsageAsync('/data', (err, usage) => {
+    t.error(err)
+    t.ok(usage.total >= usage.free && usage.free >= usage.available)
+    t.equal(usage.path, undefined)
+    sys.diskUsageAsync('', err => {
+      t.throws(() => {
+        throw err
+      }, /No such file or directory/)
+      t.end()
+    })
+  })
+})
+
+test('module->diskusage: type check of diskUsageAsync', t => {
+  t.throws(() => {
+    sys.diskUsageAsync(null, () => {})
+  }, /Expect a string or an array on first argument of diskUsageAsync/)
+  t.throws(() => {
+    sys.diskUsageAsync([ '/data', 1 ], () => {})
+  }, /Expect strings on first argument of diskUsageAsync/)
+  t.throws(() => {
+    sys.diskUsageAsync('/data')
+  }, /Expect a function on second argument of diskUsageAsync/)
+  t.end()
+})
+
+test('module->diskusage: invalidate the cached usage', t => {
+  var file = '/tmp/disk-usage.test.data'
+  var before = sys.diskUsage('/tmp')
+  fs.writeFileSync(file, Buffer.alloc(4 * 1024 * 1024))
+  sys.invalidateDiskUsage('/tmp')
+  var after = sys.diskUsage('/tmp')
+  fs.unlinkSync(file)
+  t.ok(after.free < before.free)
+  t.end()
+})
+
+test('module->diskusage: the writes in a queried directory are watched', t => {
+  var dir = '/tmp/disk-usage-watch'
+  var file = dir + '/data'
+  if (!fs.existsSync(dir)) {
+    fs.mkdirSync(dir)
+  }
+  var before = sys.diskUsage(dir)
+  fs.writeFileSync(file, Buffer.alloc(4 * 1024 * 1024))
+  // the cache is dropped by the watcher instead of the ttl
+  setTimeout(() => {
+    var after = sys.diskUsage(dir)
+    fs.unlinkSync(file)
+    fs.rmdirSync(dir)
+    t.ok(after.free < before.free)
+    t.end()
+  }, 100)
+})
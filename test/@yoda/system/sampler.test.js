@@ -0,0 +1,37 @@
+'use strict'
+
+var test = require('tape')
+var fs = require('fs')
+var sys = require('@yoda/system')
+
+test('module->sampler: sample the current process', t => {
+  t.ok(sys.startSampler({ interval: 100, capacity: 4 }))
+  setTimeout(() => {
+    sys.stopSampler()
+    var samples = sys.getSamples()
+    t.ok(samples.length > 0 && samples.length <= 4)
+    var sample = samples[samples.length - 1]
+    t.equal(sample.pid, process.pid)
+    t.ok(sample.rss > 0)
+    t.ok(sample.threads > 0)
+    t.ok(sample.memAvailable > 0)
+    t.equal(typeof sample.cpu, 'number')
+    t.equal(sys.getSamples(sample.time).length, 0)
+    t.end()
+  }, 700)
+})
+
+test('module->sampler: dump the samples', t => {
+  sys.dumpSamples('/tmp/sampler.test.csv')
+  var lines = fs.readFileSync('/tmp/sampler.test.csv', 'utf8').trim().split('\n')
+  t.equal(lines[0], 'time,pid,threads,rss,pss,private_dirty,swap,cpu,mem_free,mem_available')
+  t.equal(lines.length, sys.getSamples().length + 1)
+
+  sys.dumpSamples('/tmp/sampler.test.json', 'json')
+  var samples = JSON.parse(fs.readFileSync('/tmp/sampler.test.json', 'utf8'))
+  t.deepEqual(samples.map((it) => it.time), sys.getSamples().map((it) => it.time))
+  t.throws(() => {
+    sys.dumpSamples('/aaa/dddd/sampler.csv')
+  }, /failed to dump the samples/)
+  t.end()
+})
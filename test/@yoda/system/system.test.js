@@ -5,12 +5,13 @@ var sys = require('@yoda/system')
 var logger = require('logger')('system-test')
 
 test('module->system: verifyOtaImage', t => {
-  // TODO: function not implemented
-  t.plan(2)
-  var result = sys.verifyOtaImage()
-  t.equal(typeof result, 'boolean')
-  t.ok(result)
-  t.end()
+  t.plan(3)
+  sys.verifyOtaImage('/bin/debug.sh', (err, result) => {
+    t.error(err)
+    t.equal(typeof result.checksum, 'string')
+    t.ok(result.valid)
+    t.end()
+  })
 })
 
 /**
@@ -0,0 +1,107 @@
+'use strict'
+
+var test = require('tape')
+var fs = require('fs')
+var sys = require('@yoda/system')
+
+var imageFile = '/tmp/verify.test.img'
+var blockSize = 4096
+var wrongHash = '00000000000000000000000000000000'
+
+// 3 blocks of 0x00, 0x01 and the last 100 bytes of 0x02
+function writeImage () {
+  var image = Buffer.alloc(blockSize * 2 + 100)
+  image.fill(1, blockSize, blockSize * 2)
+  image.fill(2, blockSize * 2)
+  fs.writeFileSync(imageFile, image)
+}
+
+test('module->verifyOtaImage: checksum of the whole image', t => {
+  fs.writeFileSync(imageFile, 'foobar')
+  var progress = []
+  sys.verifyOtaImage(imageFile, {
+    checksum: '3858F62230AC3C915F300C664312C63F',
+    onProgress: (done, total) => progress.push([ done, total ])
+  }, (err, result) => {
+    t.error(err)
+    t.equal(result.checksum, '3858f62230ac3c915f300c664312c63f')
+    t.ok(result.valid)
+    t.deepEqual(progress[progress.length - 1], [ 6, 6 ])
+    t.end()
+  })
+})
+
+test('module->verifyOtaImage: mismatched checksum', t => {
+  fs.writeFileSync(imageFile, 'foobaz')
+  sys.verifyOtaImage(imageFile, { checksum: '3858f62230ac3c915f300c664312c63f' }, (err, result) => {
+    t.error(err)
+    t.equal(result.valid, false)
+    t.end()
+  })
+})
+
+test('module->verifyOtaImage: per-block hashes', t => {
+  writeImage()
+  sys.verifyOtaImage(imageFile, { checksum: 'x' }, (err, whole) => {
+    t.error(err)
+    var image = fs.readFileSync(imageFile)
+    // the expected hashes are the checksums of the blocks as single files
+    var hashes = []
+    var pending = 3
+    ;[0, 1, 2].forEach((i) => {
+      var file = `${imageFile}.${i}`
+      fs.writeFileSync(file, image.slice(i * blockSize, (i + 1) * blockSize))
+      sys.verifyOtaImage(file, (err, result) => {
+        t.error(err)
+        hashes[i] = result.checksum
+        if (--pending > 0) {
+          return
+        }
+        sys.verifyOtaImage(imageFile, {
+          blockSize: blockSize,
+          blockHashes: hashes
+        }, (err, result) => {
+          t.error(err)
+          t.ok(result.valid)
+          t.equal(result.checksum, undefined)
+          t.deepEqual(result.badBlocks, [])
+          verifyBadBlock(t, hashes, whole.checksum)
+        })
+      })
+    })
+  })
+})
+
+function verifyBadBlock (t, hashes, checksum) {
+  hashes = hashes.slice()
+  hashes[1] = wrongHash
+  sys.verifyOtaImage(imageFile, {
+    checksum: checksum,
+    blockSize: blockSize,
+    blockHashes: hashes
+  }, (err, result) => {
+    t.error(err)
+    t.equal(result.valid, false)
+    t.equal(result.checksum, checksum)
+    t.deepEqual(result.badBlocks, [ 1 ])
+    t.end()
+  })
+}
+
+test('module->verifyOtaImage: the block list of another image', t => {
+  writeImage()
+  sys.verifyOtaImage(imageFile, {
+    blockSize: blockSize,
+    blockHashes: [ wrongHash, wrongHash ]
+  }, (err) => {
+    t.ok(err instanceof Error)
+    t.end()
+  })
+})
+
+test('module->verifyOtaImage: no such image', t => {
+  sys.verifyOtaImage('/aaa/dddd.img', (err) => {
+    t.ok(/No such file or directory/.test(err.message))
+    t.end()
+  })
+})
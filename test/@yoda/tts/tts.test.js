@@ -323,3 +323,106 @@ test('module->tts->createHandle method test case: error options, options.secret
   }, 'options.secret is required')
   t.end()
 })
+
+test('module->tts->cache: replay the completed phrase', t => {
+  if (!config || !config.cloudgw) {
+    logger.log('skip this case when config not provided')
+    t.end()
+    return
+  }
+  var options = Object.assign({ cacheDir: '/tmp/tts-cache-test' }, config.cloudgw)
+  var tts = ttsModule.createTts(options)
+  var text = 'the phrase to be cached'
+  tts.speak(text, (e) => {
+    t.error(e, 'the first speak is synthesized by the cloud')
+    var req = tts.speak(text, (e) => {
+      t.error(e, 'the second speak is replayed from the cache')
+      t.ok(req.id >= 0x40000000, `tts : id=${req.id} is a cached id`)
+      tts.disconnect()
+      t.end()
+    })
+  })
+})
+
+test('module->tts->enqueue: play the utterances in order', t => {
+  if (!config || !config.cloudgw) {
+    logger.log('skip this case when config not provided')
+    t.end()
+    return
+  }
+  var tts = ttsModule.createTts(config.cloudgw)
+  var ended = []
+  var first = tts.enqueue('the first sentence', (e) => {
+    t.error(e)
+    ended.push(first.id)
+  })
+  var second = tts.enqueue('the second sentence', (e) => {
+    t.error(e)
+    ended.push(second.id)
+    t.deepEqual(ended, [ first.id, second.id ], 'ended in the queued order')
+    tts.disconnect()
+    t.end()
+  })
+})
+
+test('module->tts->cancelQueue', t => {
+  if (!config || !config.cloudgw) {
+    logger.log('skip this case when config not provided')
+    t.end()
+    return
+  }
+  var tts = ttsModule.createTts(config.cloudgw)
+  var cancelled = 0
+  tts.on('cancel', () => {
+    if (++cancelled === 3) {
+      t.pass('all queued utterances are cancelled')
+      tts.disconnect()
+      t.end()
+    }
+  })
+  tts.enqueue('the first sentence')
+  tts.enqueue('the second sentence')
+  tts.enqueue('the third sentence')
+  tts.cancelQueue()
+})
+
+test('module->tts->getStats', t => {
+  if (!config || !config.cloudgw) {
+    logger.log('skip this case when config not provided')
+    t.end()
+    return
+  }
+  var tts = ttsModule.createTts(Object.assign({ cacheSize: 0 }, config.cloudgw))
+  var req = tts.speak('hello rokid', (e) => {
+    t.error(e)
+    var stats = req.getStats()
+    t.ok(stats.frames > 0, 'voice frames are received')
+    t.equal(stats.depth, 0, 'all frames are played')
+    t.ok(stats.targetDepth >= 1, 'the jitter buffer is sized')
+    t.ok(stats.timeToFirstAudio >= 0, 'time to first audio is measured')
+    t.equal(typeof stats.underruns, 'number')
+    tts.disconnect()
+    t.end()
+  })
+})
+
+test('module->tts->trace', t => {
+  if (!config || !config.cloudgw) {
+    logger.log('skip this case when config not provided')
+    t.end()
+    return
+  }
+  var tts = ttsModule.createTts(Object.assign({ cacheSize: 0 }, config.cloudgw))
+  tts.setTrace(true)
+  var req = tts.speak('hello rokid')
+  tts.on('trace', (id, stats) => {
+    t.equal(id, req.id, 'trace the request')
+    var latency = stats.latency
+    t.ok(latency.start >= 0, 'start is received')
+    t.ok(latency.firstVoice >= latency.start, 'first voice after start')
+    t.ok(latency.firstAudio >= latency.firstVoice, 'first audio after first voice')
+    t.ok(latency.drained >= latency.firstAudio, 'drained after first audio')
+    tts.disconnect()
+    t.end()
+  })
+})
@@ -0,0 +1,32 @@
+var InputEvent = require('@yoda/input').InputEvent
+
+var path = process.argv[2]
+var speed = Number(process.argv[3] || 1)
+var threshold = Number(process.argv[4] || 0)
+
+if (!path) {
+  console.log('usage: input-replay.js <record-file> [speed] [p95-threshold-ms]')
+  process.exit(1)
+}
+
+function main () {
+  var input = new InputEvent()
+  var r = input.replay(path, { speed: speed }, (err, stats) => {
+    if (err) {
+      throw err
+    }
+    console.log(`replayed ${stats.count} events at speed ${speed}`)
+    console.log(`latency(ms): min=${stats.min} mean=${stats.mean} ` +
+      `p50=${stats.p50} p95=${stats.p95} p99=${stats.p99} max=${stats.max}`)
+    if (threshold > 0 && stats.p95 > threshold) {
+      console.error(`p95 latency ${stats.p95}ms exceeds ${threshold}ms`)
+      process.exit(1)
+    }
+  })
+  if (r !== 0) {
+    console.error(`cannot replay ${path}`)
+    process.exit(1)
+  }
+}
+
+main()
@@ -0,0 +1,131 @@
+'use strict'
+
+/**
+ * Plays a light script, or its precompiled `.lseq` sequence, against the fake
+ * LumenLight driver and reports the achieved fps, the jitter of the draws and
+ * the CPU time per frame. Build `@yoda/light` with `-DLIGHT_FAKE_DRIVER=ON`.
+ */
+
+var fs = require('fs')
+var light = require('@yoda/light')
+var Effects = require('/usr/yoda/services/lightd/effects')
+
+var file = process.argv[2]
+var duration = Number(process.argv[3] || 5000)
+var params = process.argv[4] ? JSON.parse(process.argv[4]) : {}
+
+if (!file) {
+  console.log('usage: light-bench.js <script.js|sequence.lseq> [duration-ms] [params-json]')
+  process.exit(1)
+}
+
+function percentile (sorted, p) {
+  if (sorted.length === 0) {
+    return 0
+  }
+  var idx = Math.min(sorted.length - 1, Math.ceil(sorted.length * p / 100) - 1)
+  return sorted[Math.max(idx, 0)]
+}
+
+function fixed (n) {
+  return Math.round(n * 100) / 100
+}
+
+// the clock ticks per second of the cpu times, the AT_CLKTCK of the auxiliary
+// vector which is a list of the native word pairs.
+function clockTicks () {
+  var word = /64/.test(process.arch) ? 8 : 4
+  var auxv = fs.readFileSync('/proc/self/auxv')
+  for (var i = 0; i + word * 2 <= auxv.length; i += word * 2) {
+    var type = auxv.readUInt32LE(i)
+    if (type === 17) {
+      return auxv.readUInt32LE(i + word)
+    } else if (type === 0) {
+      break
+    }
+  }
+  return 100
+}
+
+var ticks = clockTicks()
+
+function cpuTime () {
+  // utime and stime are the 14th and 15th fields, the comm could have spaces
+  var stat = fs.readFileSync('/proc/self/stat', 'utf8')
+  var fields = stat.slice(stat.lastIndexOf(')') + 2).split(' ')
+  return (Number(fields[11]) + Number(fields[12])) * 1000 / ticks
+}
+
+function play (context, done) {
+  if (/\.lseq$/.test(file)) {
+    context.playSequence(file, { repeat: -1 }, () => done())
+    return
+  }
+  var handle = require(fs.realpathSync(file))
+  handle(context, params, done)
+}
+
+function report (records, cpu, elapsed) {
+  var fps = light.getProfile().maximumFps
+  // the frames skipped by the dirty check are timed too, they're the ticks
+  // which found nothing to change.
+  var times = records.times
+  var skipped = records.skipped.filter((flag) => flag).length
+  var intervals = []
+  var jitters = []
+  for (var i = 1; i < times.length; i++) {
+    var interval = times[i] - times[i - 1]
+    intervals.push(interval)
+    jitters.push(Math.abs(interval - 1000 / fps))
+  }
+  intervals.sort((a, b) => a - b)
+  jitters.sort((a, b) => a - b)
+  var changed = records.changed.filter((flag) => flag).length
+  var stats = light.getStats(true)
+  var span = times.length > 1 ? times[times.length - 1] - times[0] : 0
+  var achieved = span > 0 ? (times.length - 1) * 1000 / span : 0
+
+  console.log(`played ${file} for ${elapsed}ms`)
+  console.log(`frames: ticks=${times.length} drawn=${times.length - skipped} ` +
+    `changed=${changed} skipped=${skipped} failed=${stats.failed}`)
+  console.log(`fps: achieved=${fixed(achieved)} profile=${fps}`)
+  console.log(`interval(ms): p50=${fixed(percentile(intervals, 50))} ` +
+    `p95=${fixed(percentile(intervals, 95))} p99=${fixed(percentile(intervals, 99))} ` +
+    `max=${fixed(percentile(intervals, 100))}`)
+  console.log(`jitter(ms): p50=${fixed(percentile(jitters, 50))} ` +
+    `p95=${fixed(percentile(jitters, 95))} p99=${fixed(percentile(jitters, 99))} ` +
+    `max=${fixed(percentile(jitters, 100))}`)
+  console.log(`cpu: total=${fixed(cpu)}ms per-frame=` +
+    `${fixed(times.length > 0 ? cpu / times.length : 0)}ms`)
+}
+
+function main () {
+  if (light.getDriverRecords() === null) {
+    console.error('the fake driver is not built, rebuild with -DLIGHT_FAKE_DRIVER=ON')
+    process.exit(1)
+  }
+  var context = new Effects().getContext()
+  // the sounds are not part of the rendering cost
+  context.sound = function () {}
+  context.playAwake = function () {}
+
+  light.getDriverRecords(true)
+  light.getStats(true)
+  var cpu = cpuTime()
+  var start = Date.now()
+  var finished = false
+  var timer = setTimeout(finish, duration)
+
+  function finish () {
+    if (finished) {
+      return
+    }
+    finished = true
+    clearTimeout(timer)
+    context.stop()
+    report(light.getDriverRecords(true), cpuTime() - cpu, Date.now() - start)
+  }
+  play(context, finish)
+}
+
+main()
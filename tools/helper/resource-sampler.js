@@ -0,0 +1,79 @@
+'use strict'
+
+/**
+ * Samples the processes matching the pattern with the native sampler of
+ * `@yoda/system` and prints the lines of `memory-viewer` data, which could be
+ * rendered by `memory-viewer -r`.
+ */
+
+var fs = require('fs')
+var system = require('@yoda/system')
+
+var action = process.argv[2]
+var pattern = process.argv[3]
+var interval = Number(process.argv[4] || 1000)
+
+if (action !== 'memory' && action !== 'cpu') {
+  console.log('usage: resource-sampler.js <memory|cpu> [pattern] [interval-ms]')
+  process.exit(1)
+}
+
+function findProcesses (regex) {
+  var names = {}
+  fs.readdirSync('/proc').forEach((pid) => {
+    if (!/^\d+$/.test(pid) || Number(pid) === process.pid) {
+      return
+    }
+    var args
+    try {
+      args = fs.readFileSync(`/proc/${pid}/cmdline`, 'utf8').replace(/\0/g, ' ').trim()
+    } catch (err) {
+      return
+    }
+    if (args && (regex == null || regex.test(args))) {
+      // the options are dropped like `memory-viewer` does
+      names[pid] = args.split(' -')[0]
+    }
+  })
+  return names
+}
+
+function formatTime (ms) {
+  var d = new Date(ms)
+  var pad = (n) => (n < 10 ? '0' : '') + n
+  return `${d.getFullYear()}-${pad(d.getMonth() + 1)}-${pad(d.getDate())}-` +
+    `${pad(d.getHours())}:${pad(d.getMinutes())}:${pad(d.getSeconds())}`
+}
+
+function print (data, args, time) {
+  console.log(`${JSON.stringify({ data: data, args: args, time: time })},`)
+}
+
+function main () {
+  var names = findProcesses(pattern ? new RegExp(pattern) : null)
+  var pids = Object.keys(names).map(Number)
+  if (pids.length === 0) {
+    console.error(`no process matches ${pattern}`)
+    process.exit(1)
+  }
+  system.startSampler({ pids: pids, interval: interval })
+
+  var since = 0
+  setInterval(() => {
+    var samples = system.getSamples(since)
+    var free = {}
+    samples.forEach((it) => {
+      var time = formatTime(it.time)
+      since = Math.max(since, it.time)
+      if (action === 'memory') {
+        print(it.rss, names[it.pid], time)
+        free[time] = it.memAvailable
+      } else {
+        print(Math.round(it.cpu * 100) / 100, names[it.pid], time)
+      }
+    })
+    Object.keys(free).forEach((time) => print(free[time], 'free', time))
+  }, interval)
+}
+
+main()